@@ -0,0 +1,149 @@
+#include "JsonMetrics.h"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    class Parser final {
+    public:
+        Parser(const std::string& textArg, std::map<std::string, double>& metricsArg)
+            : text(textArg), metrics(metricsArg) {
+        }
+
+        bool ParseDocument() {
+            if (!ParseValue("")) return false;
+            SkipWhitespace();
+            return position == text.size();
+        }
+
+    private:
+        const std::string& text;
+        std::map<std::string, double>& metrics;
+        size_t position = 0;
+
+        void SkipWhitespace() {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) ++position;
+        }
+
+        bool ParseLiteral(const char* literal) {
+            const size_t length = std::char_traits<char>::length(literal);
+            if (text.compare(position, length, literal) != 0) return false;
+            position += length;
+            return true;
+        }
+
+        bool Consume(char expected) {
+            SkipWhitespace();
+            if (position >= text.size() || text[position] != expected) return false;
+            ++position;
+            return true;
+        }
+
+        static std::string Join(const std::string& path, const std::string& key) {
+            return path.empty() ? key : path + "." + key;
+        }
+
+        bool ParseString(std::string& value) {
+            if (!Consume('"')) return false;
+            value.clear();
+            while (position < text.size() && text[position] != '"') {
+                if (text[position] == '\\' && position + 1 < text.size()) ++position; // Keeps the escaped character as is
+                value += text[position++];
+            }
+            return Consume('"');
+        }
+
+        bool ParseValue(const std::string& path) {
+            SkipWhitespace();
+            if (position >= text.size()) return false;
+
+            const char c = text[position];
+            if (c == '{') {
+                ++position;
+                if (Consume('}')) return true;
+                do {
+                    std::string key;
+                    if (!ParseString(key) || !Consume(':') || !ParseValue(Join(path, key))) return false;
+                } while (Consume(','));
+                return Consume('}');
+            }
+            if (c == '[') {
+                ++position;
+                if (Consume(']')) return true;
+                size_t index = 0;
+                do {
+                    if (!ParseValue(Join(path, std::to_string(index++)))) return false;
+                } while (Consume(','));
+                return Consume(']');
+            }
+            if (c == '"') {
+                std::string ignored;
+                return ParseString(ignored);
+            }
+            if (ParseLiteral("true")) {
+                metrics[path] = 1.0;
+                return true;
+            }
+            if (ParseLiteral("false")) {
+                metrics[path] = 0.0;
+                return true;
+            }
+            if (ParseLiteral("null")) return true;
+
+            const char* const begin = text.c_str() + position;
+            char* end = nullptr;
+            const double value = std::strtod(begin, &end);
+            if (end == begin) return false;
+            position += static_cast<size_t>(end - begin);
+            metrics[path] = value;
+            return true;
+        }
+    };
+}
+
+namespace JsonMetrics {
+    bool Load(const std::string& path, std::map<std::string, double>& metrics) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Warning: could not read " << path << std::endl;
+            return false;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        if (!Parse(buffer.str(), metrics)) {
+            std::cerr << "Warning: " << path << " is not valid JSON" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool Parse(const std::string& text, std::map<std::string, double>& metrics) {
+        Parser parser(text, metrics);
+        return parser.ParseDocument();
+    }
+
+    void WriteEscaped(std::ostream& out, std::string_view text) {
+        static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        for (const char c : text) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\b': out << "\\b"; break;
+            case '\f': out << "\\f"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << HEX_DIGITS[(c >> 4) & 0xF] << HEX_DIGITS[c & 0xF];
+                }
+                else {
+                    out << c;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Reads the numbers out of a JSON document as a flat map keyed by their path, objects joined
+// with '.', array elements by index: {"frameMs":{"p50":4.2}} gives "frameMs.p50" = 4.2.
+// Booleans read as 1 and 0; strings and nulls are skipped. Enough for the reports this repo writes itself.
+// Also the string escaping every report writer shares.
+namespace JsonMetrics {
+    // Returns false (with a warning) if the file can't be read or isn't valid JSON
+    bool Load(const std::string& path, std::map<std::string, double>& metrics);
+    bool Parse(const std::string& text, std::map<std::string, double>& metrics);
+
+    // Writes text as the contents of a JSON string (without the quotes): quotes, backslashes and
+    // control characters escaped. Streams straight into out, so it doesn't allocate.
+    void WriteEscaped(std::ostream& out, std::string_view text);
+}
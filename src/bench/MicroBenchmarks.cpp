@@ -0,0 +1,363 @@
+// CPU micro-benchmarks for the hot kernels that run without a GPU: OBJ parsing, procedural mesh
+// generation, terrain sampling, particle simulation and scene orbit updates. Nothing here creates
+// a Vulkan device; meshes are built with the device-free GeometryGenerator/OBJLoader entry points.
+//
+// Run from the repository root (models are loaded by relative path):
+//   --filter TEXT   only run cases whose name contains TEXT
+//   --min-time S    measure each case for at least S seconds (default 0.5)
+//   --output FILE   write the results as JSON (default microbench.json)
+//
+// Regression gate: repeats the cases (and optionally the app's headless --benchmark) and compares
+// the per-metric medians against a stored baseline, see PerfGate. Exits non-zero on a regression.
+// Baselines are machine specific. perf/baseline.json is the checked-in one (micro cases only, so app
+// metrics show up as new); re-record it with --update-baseline when the machine or the cases change.
+//   --gate FILE             compare against FILE
+//   --update-baseline FILE  record the runs as a new baseline instead of comparing
+//   --runs N                repetitions per case and per app run (default 5)
+//   --app PATH              also run PATH --benchmark, e.g. x64\Release\TheOrb.exe: each run launches it
+//                           once on an empty pipeline cache and once on the cache that launch left behind
+//   --app-frames N          frames per app run (default 600)
+#include "../core/JobSystem.h"
+#include "../geometry/GeometryGenerator.h"
+#include "../geometry/OBJLoader.h"
+#include "../rendering/ParticleLibrary.h"
+#include "../rendering/ParticleSystem.h"
+#include "../rendering/Scene.h"
+#include "PerfGate.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct CaseResult {
+        std::string name;
+        uint64_t iterations = 0;
+        uint64_t itemsPerIteration = 0; // Vertices, samples or particles touched by one iteration
+        double minNs = 0.0;
+        double medianNs = 0.0;
+        double meanNs = 0.0;
+    };
+
+    struct Settings {
+        std::string filter;
+        double minSeconds = 0.5;
+        std::string outputPath = "microbench.json";
+
+        std::string gatePath;
+        std::string updateBaselinePath;
+        uint32_t runs = 5;
+        std::string appPath;
+        uint32_t appFrames = 600;
+    };
+
+    constexpr uint64_t MAX_ITERATIONS = 100000;
+    constexpr uint64_t MIN_ITERATIONS = 5;
+
+    // Keeps results observable so the optimizer can't drop the work
+    volatile double sink = 0.0;
+
+    class Runner final {
+    public:
+        explicit Runner(const Settings& settingsArg) : settings(settingsArg) {}
+
+        // Times body() after one untimed warm-up call. body returns a value folded into sink.
+        void Run(const std::string& name, uint64_t itemsPerIteration, const std::function<double()>& body) {
+            if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos) return;
+
+            sink = sink + body();
+
+            std::vector<double> samples;
+            const auto start = std::chrono::steady_clock::now();
+            while (samples.size() < MAX_ITERATIONS) {
+                const auto begin = std::chrono::steady_clock::now();
+                const double value = body();
+                const auto end = std::chrono::steady_clock::now();
+                sink = sink + value;
+                samples.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+
+                const double elapsed = std::chrono::duration<double>(end - start).count();
+                if (samples.size() >= MIN_ITERATIONS && elapsed >= settings.minSeconds) break;
+            }
+
+            CaseResult result;
+            result.name = name;
+            result.iterations = samples.size();
+            result.itemsPerIteration = itemsPerIteration;
+            double total = 0.0;
+            for (const double sample : samples) total += sample;
+            result.meanNs = total / static_cast<double>(samples.size());
+            std::sort(samples.begin(), samples.end());
+            result.minNs = samples.front();
+            result.medianNs = samples[samples.size() / 2];
+
+            std::cout << std::left << std::setw(44) << name << std::right << std::fixed << std::setprecision(3)
+                << std::setw(12) << result.medianNs / 1e6 << " ms median" << std::setw(12) << result.minNs / 1e6 << " ms min"
+                << std::setw(9) << result.iterations << " iters" << std::endl;
+            results.push_back(std::move(result));
+        }
+
+        const std::vector<CaseResult>& GetResults() const { return results; }
+
+        bool WriteJson() const {
+            std::ofstream file(settings.outputPath);
+            if (!file.is_open()) {
+                std::cerr << "Warning: could not write results to " << settings.outputPath << std::endl;
+                return false;
+            }
+
+            file << "{\"cases\":[";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const CaseResult& result = results[i];
+                const double nsPerItem = result.itemsPerIteration ? result.medianNs / static_cast<double>(result.itemsPerIteration) : 0.0;
+                file << (i ? "," : "") << "\n{\"name\":\"" << result.name << "\",\"iterations\":" << result.iterations
+                    << ",\"items\":" << result.itemsPerIteration << ",\"minNs\":" << result.minNs << ",\"medianNs\":" << result.medianNs
+                    << ",\"meanNs\":" << result.meanNs << ",\"nsPerItem\":" << nsPerItem << "}";
+            }
+            file << "\n]}\n";
+            return true;
+        }
+
+    private:
+        Settings settings;
+        std::vector<CaseResult> results;
+    };
+
+    // Matches the scene setup in Application::SetupScene
+    constexpr float ORB_RADIUS = 150.0f;
+    constexpr float TERRAIN_HEIGHT_SCALE = 3.5f;
+    constexpr float TERRAIN_NOISE_FREQ = 0.02f;
+    constexpr float SIMULATION_STEP = 1.0f / 60.0f;
+
+    // The cold launch of each app run only contributes its startup time
+    constexpr uint32_t COLD_START_FRAMES = 10;
+
+    void MeshCases(Runner& runner) {
+        const char* const MODELS[] = { "models/cactus.obj", "models/DeadTree.obj", "models/Joshua_Tree.obj", "models/PUSHILIN_Tumbleweed.obj" };
+        for (const char* model : MODELS) {
+            try {
+                const uint64_t vertices = OBJLoader::Parse(model)->VertexCount();
+                runner.Run(std::string("OBJLoader::Parse/") + (std::strrchr(model, '/') + 1), vertices, [model] {
+                    return static_cast<double>(OBJLoader::Parse(model)->VertexCount());
+                    });
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Warning: skipping " << model << ": " << e.what() << std::endl;
+            }
+        }
+
+        for (const int rings : { 128, 512 }) {
+            runner.Run("GeometryGenerator::BuildTerrain/" + std::to_string(rings), static_cast<uint64_t>(rings + 1) * (rings + 1), [rings] {
+                return static_cast<double>(GeometryGenerator::BuildTerrain(ORB_RADIUS, rings, rings, TERRAIN_HEIGHT_SCALE, TERRAIN_NOISE_FREQ)->VertexCount());
+                });
+        }
+
+        runner.Run("GeometryGenerator::BuildPedestal/512", 513ull * 513, [] {
+            return static_cast<double>(GeometryGenerator::BuildPedestal(ORB_RADIUS, ORB_RADIUS * 2.3f, 100.0f, 512, 512)->VertexCount());
+            });
+
+        for (const int stacks : { 16, 32, 128 }) {
+            runner.Run("GeometryGenerator::BuildSphere/" + std::to_string(stacks), static_cast<uint64_t>(stacks + 1) * (stacks * 2 + 1), [stacks] {
+                return static_cast<double>(GeometryGenerator::BuildSphere(stacks, stacks * 2, ORB_RADIUS)->VertexCount());
+                });
+        }
+
+        // In place on one mesh: the result doesn't depend on the normals it starts from
+        auto terrain = GeometryGenerator::BuildTerrain(ORB_RADIUS, 512, 512, TERRAIN_HEIGHT_SCALE, TERRAIN_NOISE_FREQ);
+        Geometry* const terrainMesh = terrain.get();
+        runner.Run("GeometryGenerator::ComputeSmoothNormals/512", terrainMesh->VertexCount(), [terrainMesh] {
+            GeometryGenerator::ComputeSmoothNormals(terrainMesh);
+            return static_cast<double>(terrainMesh->GetVertex(0).normal.y);
+            });
+
+        constexpr int SAMPLE_GRID = 256;
+        runner.Run("GeometryGenerator::GetTerrainHeight/65536", SAMPLE_GRID * SAMPLE_GRID, [] {
+            double sum = 0.0;
+            const float step = 2.0f * ORB_RADIUS / SAMPLE_GRID;
+            for (int z = 0; z < SAMPLE_GRID; ++z) {
+                for (int x = 0; x < SAMPLE_GRID; ++x) {
+                    sum += GeometryGenerator::GetTerrainHeight(-ORB_RADIUS + x * step, -ORB_RADIUS + z * step, ORB_RADIUS, TERRAIN_HEIGHT_SCALE, TERRAIN_NOISE_FREQ);
+                }
+            }
+            return sum;
+            });
+    }
+
+    void ParticleCases(Runner& runner) {
+        for (const uint32_t poolSize : { 1024u, 16384u, 65536u }) {
+            ParticleProps props = ParticleLibrary::GetFireProps();
+            props.flipbookFrames.clear(); // No atlas to resolve them against
+
+            // Update: steady state, the emitter replaces what dies each step
+            std::vector<ParticleSystem::Particle> pool(poolSize);
+            ParticleSystem steady(props.texturePath);
+            steady.SetRandomSeed(1);
+            steady.AssignPool(pool.data(), poolSize, 0);
+            steady.AddEmitter(props, static_cast<float>(poolSize) / props.lifeTime);
+            for (int i = 0; i < 120; ++i) steady.Update(SIMULATION_STEP);
+
+            runner.Run("ParticleSystem::Update/" + std::to_string(poolSize), poolSize, [&steady] {
+                steady.Update(SIMULATION_STEP);
+                return static_cast<double>(steady.GetAliveCount());
+                });
+
+            // Emit: refill an emptied pool in one step (emission catch-up is capped at 0.1 s)
+            std::vector<ParticleSystem::Particle> burstPool(poolSize);
+            ParticleSystem burst(props.texturePath);
+            burst.SetRandomSeed(1);
+            burst.AddEmitter(props, static_cast<float>(poolSize) * 10.0f);
+            ParticleSystem* const burstSystem = &burst;
+            ParticleSystem::Particle* const burstData = burstPool.data();
+
+            runner.Run("ParticleSystem::Emit/" + std::to_string(poolSize), poolSize, [burstSystem, burstData, poolSize] {
+                burstSystem->AssignPool(burstData, poolSize, 0);
+                burstSystem->Update(0.1f);
+                return static_cast<double>(burstSystem->GetAliveCount());
+                });
+        }
+    }
+
+    // Launches the app headless with its default benchmark seed and adds the report to the gate
+    bool LaunchApp(const Settings& settings, uint32_t frames, const std::string& cachePath, bool startupOnly, PerfGate& gate) {
+        const std::string reportPath = (std::filesystem::temp_directory_path() / "theorb_gate_report.json").string();
+        std::string command = "\"" + settings.appPath + "\" --benchmark " + std::to_string(frames)
+            + " --benchmark-output \"" + reportPath + "\" --pipeline-cache \"" + cachePath + "\"";
+#ifdef _WIN32
+        command = "\"" + command + "\""; // cmd /c strips the outer pair of quotes
+#endif
+
+        std::cout << command << std::endl;
+        if (std::system(command.c_str()) != 0) {
+            std::cerr << "Warning: " << settings.appPath << " did not exit cleanly" << std::endl;
+            return false;
+        }
+
+        const bool loaded = gate.AddBenchmarkReport(reportPath, startupOnly);
+        std::error_code ignored;
+        std::filesystem::remove(reportPath, ignored);
+        return loaded;
+    }
+
+    // A cold start on an emptied pipeline cache of its own (the user's pipeline_cache.bin is left alone),
+    // then the measured run, warm from the cache the first launch saved
+    bool RunAppBenchmark(const Settings& settings, uint32_t run, PerfGate& gate) {
+        const std::string cachePath = (std::filesystem::temp_directory_path() / "theorb_gate_pipeline_cache.bin").string();
+        std::error_code ignored;
+        std::filesystem::remove(cachePath, ignored);
+
+        std::cout << "App run " << run + 1 << "/" << settings.runs << std::endl;
+        const bool completed = LaunchApp(settings, COLD_START_FRAMES, cachePath, true, gate)
+            && LaunchApp(settings, settings.appFrames, cachePath, false, gate);
+        std::filesystem::remove(cachePath, ignored);
+        return completed;
+    }
+
+    void SceneCases(Runner& runner, JobSystem& jobSystem) {
+        for (const size_t objectCount : { 64u, 1024u, 16384u }) {
+            Scene scene(VK_NULL_HANDLE, VK_NULL_HANDLE);
+            for (size_t i = 0; i < objectCount; ++i) {
+                const std::string name = "Orbiter" + std::to_string(i);
+                scene.AddGeometry(name, GeometryGenerator::BuildCube());
+                scene.SetObjectOrbit(name, glm::vec3(0.0f), 20.0f + static_cast<float>(i % 100), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f),
+                    static_cast<float>(i) * 0.01f);
+            }
+
+            Scene* const target = &scene;
+            runner.Run("Scene::Update/" + std::to_string(objectCount), objectCount, [target] {
+                target->Update(SIMULATION_STEP);
+                return 0.0;
+                });
+
+            scene.SetJobSystem(&jobSystem);
+            runner.Run("Scene::Update/" + std::to_string(objectCount) + "/jobs", objectCount, [target] {
+                target->Update(SIMULATION_STEP);
+                return 0.0;
+                });
+            scene.Cleanup();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            settings.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            settings.minSeconds = std::max(0.0, std::strtod(argv[++i], nullptr));
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            settings.outputPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--gate") == 0 && i + 1 < argc) {
+            settings.gatePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--update-baseline") == 0 && i + 1 < argc) {
+            settings.updateBaselinePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            settings.runs = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--app") == 0 && i + 1 < argc) {
+            settings.appPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--app-frames") == 0 && i + 1 < argc) {
+            settings.appFrames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+    }
+    const bool gating = !settings.gatePath.empty() || !settings.updateBaselinePath.empty();
+
+    try {
+        JobSystem jobSystem;
+        jobSystem.Initialize();
+
+        if (!gating) {
+            Runner runner(settings);
+            MeshCases(runner);
+            ParticleCases(runner);
+            SceneCases(runner, jobSystem);
+
+            jobSystem.Cleanup();
+            if (!runner.WriteJson()) return EXIT_FAILURE;
+            std::cout << "Wrote " << settings.outputPath << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        // Each run is a fresh Runner so every case contributes one median per run
+        PerfGate gate;
+        for (uint32_t run = 0; run < settings.runs; ++run) {
+            std::cout << "Micro-benchmark run " << run + 1 << "/" << settings.runs << std::endl;
+            Runner runner(settings);
+            MeshCases(runner);
+            ParticleCases(runner);
+            SceneCases(runner, jobSystem);
+            for (const CaseResult& result : runner.GetResults()) {
+                gate.AddSample("micro." + result.name + ".medianNs", PerfGate::MetricKind::Timing, result.medianNs);
+            }
+        }
+        jobSystem.Cleanup();
+
+        for (uint32_t run = 0; !settings.appPath.empty() && run < settings.runs; ++run) {
+            if (!RunAppBenchmark(settings, run, gate)) return EXIT_FAILURE;
+        }
+
+        if (!settings.updateBaselinePath.empty()) {
+            return gate.WriteBaseline(settings.updateBaselinePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (gate.Compare(settings.gatePath) > 0) return EXIT_FAILURE;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#include "PerfGate.h"
+#include "JsonMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    struct ReportField {
+        const char* key;
+        PerfGate::MetricKind kind;
+    };
+
+    // Benchmark report fields under the gate, see Benchmark::WriteReport
+    const ReportField REPORT_FIELDS[] = {
+        { "frameMs.p50",              PerfGate::MetricKind::Timing },
+        { "frameMs.p95",              PerfGate::MetricKind::Timing },
+        { "gpuMs.frame",              PerfGate::MetricKind::Timing },
+        { "allocationsPerFrame.mean", PerfGate::MetricKind::Count },
+        { "drawCallsPerFrame",        PerfGate::MetricKind::Count },
+    };
+
+    constexpr const char* BASELINE_PREFIX = "metrics.";
+    constexpr const char* MEDIAN_SUFFIX = ".median";
+    constexpr const char* MAD_SUFFIX = ".mad";
+}
+
+void PerfGate::AddSample(const std::string& metric, MetricKind kind, double value) {
+    Metric& entry = metrics[metric];
+    entry.kind = kind;
+    entry.samples.push_back(value);
+}
+
+bool PerfGate::AddBenchmarkReport(const std::string& path, bool startupOnly) {
+    std::map<std::string, double> report;
+    if (!JsonMetrics::Load(path, report)) return false;
+
+    // Compiling every pipeline from scratch dwarfs the rest of startup, so cold and warm launches are separate metrics
+    const auto startup = report.find("startupMs");
+    const auto warm = report.find("pipelineCacheWarm");
+    if (startup == report.end() || warm == report.end()) {
+        std::cerr << "Warning: " << path << " has no startupMs or pipelineCacheWarm" << std::endl;
+    }
+    else {
+        AddSample(warm->second != 0.0 ? "app.startupMs.warm" : "app.startupMs.cold", MetricKind::Timing, startup->second);
+    }
+    if (startupOnly) return true;
+
+    for (const ReportField& field : REPORT_FIELDS) {
+        const auto it = report.find(field.key);
+        if (it == report.end()) {
+            std::cerr << "Warning: " << path << " has no " << field.key << std::endl;
+            continue;
+        }
+        AddSample(std::string("app.") + field.key, field.kind, it->second);
+    }
+    return true;
+}
+
+int PerfGate::Compare(const std::string& baselinePath) const {
+    std::map<std::string, double> flat;
+    if (!JsonMetrics::Load(baselinePath, flat)) {
+        throw std::runtime_error("failed to load performance baseline " + baselinePath + "!");
+    }
+
+    // "metrics.<name>.median" -> name; names may contain dots (model file names)
+    std::map<std::string, std::pair<double, double>> baseline;
+    const std::string prefix = BASELINE_PREFIX;
+    const std::string medianSuffix = MEDIAN_SUFFIX;
+    for (const auto& [key, value] : flat) {
+        if (key.compare(0, prefix.size(), prefix) != 0 || key.size() <= prefix.size() + medianSuffix.size()) continue;
+        if (key.compare(key.size() - medianSuffix.size(), medianSuffix.size(), medianSuffix) != 0) continue;
+
+        const std::string name = key.substr(prefix.size(), key.size() - prefix.size() - medianSuffix.size());
+        const auto mad = flat.find(prefix + name + MAD_SUFFIX);
+        baseline[name] = { value, mad == flat.end() ? 0.0 : mad->second };
+    }
+
+    int regressions = 0;
+    std::cout << std::left << std::setw(60) << "metric" << std::right << std::setw(14) << "baseline" << std::setw(14) << "current"
+        << std::setw(10) << "delta" << std::setw(16) << "allowed" << "  status" << std::endl;
+
+    for (const auto& [name, metric] : metrics) {
+        const double current = Median(metric.samples);
+        const double currentMad = MedianAbsoluteDeviation(metric.samples, current);
+
+        std::cout << std::left << std::setw(60) << name << std::right << std::fixed << std::setprecision(3);
+        const auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::cout << std::setw(14) << "-" << std::setw(14) << current << std::setw(10) << "-" << std::setw(16) << "-" << "  new" << std::endl;
+            continue;
+        }
+
+        const double reference = it->second.first;
+        const double noise = NOISE_SIGMAS * MAD_TO_SIGMA * std::max(it->second.second, currentMad);
+        const double tolerance = metric.kind == MetricKind::Timing ? TIMING_TOLERANCE * reference : COUNT_TOLERANCE;
+        const double allowed = std::max(noise, tolerance);
+        const double delta = current - reference;
+        const bool regressed = delta > allowed;
+        if (regressed) ++regressions;
+
+        std::cout << std::setw(14) << reference << std::setw(14) << current << std::setw(9)
+            << (reference != 0.0 ? 100.0 * delta / reference : 0.0) << "%" << std::setw(16) << allowed
+            << (regressed ? "  REGRESSED" : (delta < -allowed ? "  improved" : "  ok")) << std::endl;
+    }
+
+    for (const auto& [name, values] : baseline) {
+        if (metrics.find(name) == metrics.end()) {
+            std::cout << std::left << std::setw(60) << name << std::right << std::setw(14) << values.first << std::setw(14) << "-"
+                << std::setw(10) << "-" << std::setw(16) << "-" << "  not run" << std::endl;
+        }
+    }
+
+    std::cout << (regressions ? std::to_string(regressions) + " regression(s)" : std::string("No regressions"))
+        << " against " << baselinePath << std::endl;
+    return regressions;
+}
+
+bool PerfGate::WriteBaseline(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Warning: could not write baseline to " << path << std::endl;
+        return false;
+    }
+
+    file << "{\"metrics\":{";
+    bool first = true;
+    for (const auto& [name, metric] : metrics) {
+        const double median = Median(metric.samples);
+        file << (first ? "" : ",") << "\n\"";
+        JsonMetrics::WriteEscaped(file, name);
+        file << "\":{\"median\":" << median
+            << ",\"mad\":" << MedianAbsoluteDeviation(metric.samples, median) << ",\"runs\":" << metric.samples.size() << "}";
+        first = false;
+    }
+    file << "\n}}\n";
+
+    std::cout << "Wrote baseline " << path << " (" << metrics.size() << " metrics)" << std::endl;
+    return true;
+}
+
+double PerfGate::Median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+}
+
+double PerfGate::MedianAbsoluteDeviation(const std::vector<double>& values, double median) {
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (const double value : values) deviations.push_back(std::abs(value - median));
+    return Median(std::move(deviations));
+}
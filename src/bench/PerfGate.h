@@ -0,0 +1,55 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Compares repeated benchmark runs against a stored baseline. Each metric keeps the median and
+// the median absolute deviation (MAD) of its runs, so one noisy run can't fail the gate and a
+// genuinely slower build still does. Timings get a relative allowance on top of the noise band;
+// counts (allocations, draw calls) are deterministic for a seeded run and only get a small
+// absolute one, so a single extra allocation per frame is caught.
+class PerfGate final {
+public:
+    enum class MetricKind {
+        Timing,
+        Count
+    };
+
+    PerfGate() = default;
+    ~PerfGate() = default;
+
+    // Non-copyable
+    PerfGate(const PerfGate&) = delete;
+    PerfGate& operator=(const PerfGate&) = delete;
+
+    // One value per run. Higher is worse for every metric the gate tracks.
+    void AddSample(const std::string& metric, MetricKind kind, double value);
+
+    // Adds the gated fields of one Benchmark report (the app's --benchmark-output JSON). Startup time
+    // goes to app.startupMs.cold or .warm by the report's pipelineCacheWarm; startupOnly skips the rest.
+    bool AddBenchmarkReport(const std::string& path, bool startupOnly = false);
+
+    // Prints a table and returns the number of regressed metrics. Metrics missing from the
+    // baseline are reported as new and never fail; metrics missing from the runs are listed.
+    int Compare(const std::string& baselinePath) const;
+
+    bool WriteBaseline(const std::string& path) const;
+
+    // Band width in scaled MADs (1.4826 * MAD estimates the standard deviation)
+    static constexpr double NOISE_SIGMAS = 3.0;
+    static constexpr double MAD_TO_SIGMA = 1.4826;
+    static constexpr double TIMING_TOLERANCE = 0.05;      // Fraction of the baseline median
+    static constexpr double COUNT_TOLERANCE = 0.5;        // Absolute, per-frame mean
+
+private:
+    struct Metric {
+        MetricKind kind = MetricKind::Timing;
+        std::vector<double> samples;
+    };
+
+    std::map<std::string, Metric> metrics;
+
+    static double Median(std::vector<double> values);
+    static double MedianAbsoluteDeviation(const std::vector<double>& values, double median);
+};
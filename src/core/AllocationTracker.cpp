@@ -0,0 +1,260 @@
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace {
+    // Every block is prefixed with its header length and requested size, so frees know
+    // how much to release. 16 bytes keeps the default new alignment.
+    constexpr size_t HEADER_SIZE = 16;
+
+    struct ScopeSlot {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+    };
+
+    // Everything here is constant-initialized, so it is usable by allocations made during static init
+    std::atomic<bool> trackingEnabled{ false };
+
+    ScopeSlot scopeSlots[AllocationTracker::MAX_SCOPES]; // Slot 0 = unscoped
+    std::atomic<size_t> scopeSlotCount{ 1 };
+    std::mutex scopeRegisterMutex;
+
+    std::atomic<uint64_t> frameAllocations{ 0 };
+    std::atomic<uint64_t> frameFrees{ 0 };
+    std::atomic<uint64_t> frameBytes{ 0 };
+    std::atomic<int64_t> frameNetBytes{ 0 };
+    std::atomic<int64_t> framePeakBytes{ 0 };
+
+    thread_local size_t currentScope = 0;
+
+    size_t FindOrRegisterScope(const char* name) {
+        const size_t count = scopeSlotCount.load(std::memory_order_acquire);
+        for (size_t i = 1; i < count; ++i) {
+            const char* slotName = scopeSlots[i].name.load(std::memory_order_relaxed);
+            if (slotName == name || std::strcmp(slotName, name) == 0) return i;
+        }
+
+        std::lock_guard<std::mutex> lock(scopeRegisterMutex);
+        const size_t lockedCount = scopeSlotCount.load(std::memory_order_relaxed);
+        for (size_t i = count; i < lockedCount; ++i) {
+            if (std::strcmp(scopeSlots[i].name.load(std::memory_order_relaxed), name) == 0) return i;
+        }
+        // Table full: count it as unscoped rather than allocate
+        if (lockedCount == AllocationTracker::MAX_SCOPES) return 0;
+
+        scopeSlots[lockedCount].name.store(name, std::memory_order_relaxed);
+        scopeSlotCount.store(lockedCount + 1, std::memory_order_release);
+        return lockedCount;
+    }
+
+    void RecordAllocation(size_t bytes) {
+        if (!trackingEnabled.load(std::memory_order_relaxed)) return;
+
+        frameAllocations.fetch_add(1, std::memory_order_relaxed);
+        frameBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+        ScopeSlot& slot = scopeSlots[currentScope];
+        slot.allocations.fetch_add(1, std::memory_order_relaxed);
+        slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+        const int64_t net = frameNetBytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+        int64_t peak = framePeakBytes.load(std::memory_order_relaxed);
+        while (net > peak && !framePeakBytes.compare_exchange_weak(peak, net, std::memory_order_relaxed)) {
+        }
+    }
+
+    void RecordFree(size_t bytes) {
+        if (!trackingEnabled.load(std::memory_order_relaxed)) return;
+
+        frameFrees.fetch_add(1, std::memory_order_relaxed);
+        frameNetBytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    void* AllocateBlock(size_t bytes, size_t alignment) {
+        const size_t header = std::max(alignment, HEADER_SIZE);
+        if (bytes > SIZE_MAX - 2 * header) return nullptr;
+
+        void* raw = nullptr;
+        if (alignment > HEADER_SIZE) {
+#ifdef _MSC_VER
+            raw = _aligned_malloc(bytes + header, alignment);
+#else
+            raw = std::aligned_alloc(alignment, (bytes + header + alignment - 1) / alignment * alignment);
+#endif
+        }
+        else {
+            raw = std::malloc(bytes + header);
+        }
+        if (!raw) return nullptr;
+
+        unsigned char* user = static_cast<unsigned char*>(raw) + header;
+        size_t* info = reinterpret_cast<size_t*>(user) - 2;
+        info[0] = header;
+        info[1] = bytes;
+
+        RecordAllocation(bytes);
+        return user;
+    }
+
+    size_t BlockSize(void* pointer) {
+        return (static_cast<size_t*>(pointer) - 2)[1];
+    }
+
+    void FreeBlock(void* pointer) {
+        if (!pointer) return;
+
+        const size_t* info = static_cast<size_t*>(pointer) - 2;
+        const size_t header = info[0];
+        RecordFree(info[1]);
+
+        void* raw = static_cast<unsigned char*>(pointer) - header;
+#ifdef _MSC_VER
+        if (header > HEADER_SIZE) {
+            _aligned_free(raw);
+            return;
+        }
+#endif
+        std::free(raw);
+    }
+
+    void* AllocateOrThrow(size_t bytes, size_t alignment) {
+        for (;;) {
+            if (void* pointer = AllocateBlock(bytes, alignment)) return pointer;
+
+            const std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+}
+
+namespace AllocationTracker {
+    void SetEnabled(bool enabled) {
+        trackingEnabled.store(enabled);
+    }
+
+    bool IsEnabled() {
+        return trackingEnabled.load(std::memory_order_relaxed);
+    }
+
+    void BeginFrame() {
+        frameAllocations.store(0, std::memory_order_relaxed);
+        frameFrees.store(0, std::memory_order_relaxed);
+        frameBytes.store(0, std::memory_order_relaxed);
+        frameNetBytes.store(0, std::memory_order_relaxed);
+        framePeakBytes.store(0, std::memory_order_relaxed);
+    }
+
+    FrameStats EndFrame() {
+        FrameStats stats;
+        stats.allocations = frameAllocations.load(std::memory_order_relaxed);
+        stats.frees = frameFrees.load(std::memory_order_relaxed);
+        stats.bytes = frameBytes.load(std::memory_order_relaxed);
+        stats.peakBytes = static_cast<uint64_t>(std::max<int64_t>(framePeakBytes.load(std::memory_order_relaxed), 0));
+        return stats;
+    }
+
+    size_t GetScopeStats(ScopeStats* scopes, size_t maxScopes) {
+        const size_t count = scopeSlotCount.load(std::memory_order_acquire);
+        size_t written = 0;
+        for (size_t i = 0; i < count && written < maxScopes; ++i) {
+            const uint64_t allocations = scopeSlots[i].allocations.load(std::memory_order_relaxed);
+            if (allocations == 0) continue;
+
+            ScopeStats& out = scopes[written++];
+            out.name = (i == 0) ? "(unscoped)" : scopeSlots[i].name.load(std::memory_order_relaxed);
+            out.allocations = allocations;
+            out.bytes = scopeSlots[i].bytes.load(std::memory_order_relaxed);
+        }
+        return written;
+    }
+
+    void ResetScopes() {
+        const size_t count = scopeSlotCount.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            scopeSlots[i].allocations.store(0, std::memory_order_relaxed);
+            scopeSlots[i].bytes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void* Allocate(size_t bytes) {
+        return AllocateBlock(bytes, HEADER_SIZE);
+    }
+
+    void* Reallocate(void* pointer, size_t bytes) {
+        if (!pointer) return Allocate(bytes);
+
+        void* resized = Allocate(bytes);
+        if (!resized) return nullptr;
+        std::memcpy(resized, pointer, std::min(bytes, BlockSize(pointer)));
+        FreeBlock(pointer);
+        return resized;
+    }
+
+    void Free(void* pointer) {
+        FreeBlock(pointer);
+    }
+}
+
+AllocationScope::AllocationScope(const char* name)
+    : previousScope(currentScope) {
+    if (trackingEnabled.load(std::memory_order_relaxed)) {
+        currentScope = FindOrRegisterScope(name);
+    }
+}
+
+AllocationScope::~AllocationScope() {
+    currentScope = previousScope;
+}
+
+// --- Global allocation hooks ---
+
+void* operator new(std::size_t size) {
+    return AllocateOrThrow(size, HEADER_SIZE);
+}
+
+void* operator new[](std::size_t size) {
+    return AllocateOrThrow(size, HEADER_SIZE);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocateBlock(size, HEADER_SIZE);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocateBlock(size, HEADER_SIZE);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateBlock(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateBlock(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept { FreeBlock(pointer); }
+void operator delete[](void* pointer) noexcept { FreeBlock(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { FreeBlock(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { FreeBlock(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { FreeBlock(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { FreeBlock(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeBlock(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { FreeBlock(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { FreeBlock(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { FreeBlock(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeBlock(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeBlock(pointer); }
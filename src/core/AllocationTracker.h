@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Opt-in heap allocation instrumentation. Global operator new/delete and stb_image's allocator
+// are routed through here. While enabled, every allocation is counted against the current frame
+// and the innermost AllocationScope of the allocating thread; disabled, only the bookkeeping
+// header is paid.
+namespace AllocationTracker {
+    struct FrameStats {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t bytes = 0;        // Total bytes requested this frame
+        uint64_t peakBytes = 0;    // Largest net growth (allocated - freed) reached during the frame
+    };
+
+    struct ScopeStats {
+        const char* name = nullptr;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+
+    constexpr size_t MAX_SCOPES = 64;
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled();
+
+    // Frame boundaries, called from the main loop. EndFrame returns everything since BeginFrame.
+    void BeginFrame();
+    FrameStats EndFrame();
+
+    // Scopes that allocated since the last ResetScopes, "(unscoped)" first. Returns the number written.
+    size_t GetScopeStats(ScopeStats* scopes, size_t maxScopes);
+    void ResetScopes();
+
+    // malloc-style entry points for C libraries (stb_image). Memory must be released with Free.
+    void* Allocate(size_t bytes);
+    void* Reallocate(void* pointer, size_t bytes);
+    void Free(void* pointer);
+}
+
+// Attributes this thread's allocations to name until destroyed. Scopes nest; name must outlive
+// the program (a string literal).
+class AllocationScope final {
+public:
+    explicit AllocationScope(const char* name);
+    ~AllocationScope();
+
+    // Non-copyable
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+    size_t previousScope;
+};
@@ -1,61 +1,162 @@
 #include "Application.h"
 #include "../rendering/ParticleLibrary.h"
+#include "CpuProfiler.h"
+#include "HitchDetector.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <random>
 
 
-Application::Application()
-    : window(std::make_unique<Window>(800, 600, "TheOrb"))
+Application::Application(const ApplicationOptions& optionsArg)
+    : jobSystem(std::make_unique<JobSystem>(optionsArg.workerThreads)),
+    options(optionsArg)
 {
-    glfwSetWindowUserPointer(window->GetGLFWWindow(), this);
-    glfwSetKeyCallback(window->GetGLFWWindow(), KeyCallback);
-    glfwSetFramebufferSizeCallback(window->GetGLFWWindow(), FramebufferResizeCallback);
+    // Before the benchmark settings: a replay reuses the recorded seed, a recording pins one down
+    if (!options.replayTracePath.empty() || !options.recordTracePath.empty()) {
+        inputTrace = std::make_unique<InputTrace>();
+    }
+    if (!options.replayTracePath.empty()) {
+        inputTrace->LoadReplay(options.replayTracePath);
+        if (!options.randomSeed) options.randomSeed = inputTrace->GetSeed();
+    }
+    if (!options.recordTracePath.empty()) {
+        if (!options.randomSeed) options.randomSeed = std::random_device{}();
+        inputTrace->StartRecording(options.recordTracePath, *options.randomSeed);
+    }
+
+    if (options.benchmarkFrames > 0) {
+        // Repeatable runs: one simulation step per frame on the main thread, from a fixed seed
+        options.threadedSimulation = false;
+        options.trackAllocations = true;
+        if (!options.randomSeed) options.randomSeed = DEFAULT_BENCHMARK_SEED;
+
+        Benchmark::Settings settings;
+        settings.frames = options.benchmarkFrames;
+        settings.width = options.benchmarkWidth;
+        settings.height = options.benchmarkHeight;
+        settings.seed = *options.randomSeed;
+        settings.outputPath = options.benchmarkOutput;
+        settings.stressScene = options.stressScene;
+        benchmark = std::make_unique<Benchmark>(settings);
+    }
+    else {
+        window = std::make_unique<Window>(800, 600, "TheOrb");
+        glfwSetWindowUserPointer(window->GetGLFWWindow(), this);
+        glfwSetKeyCallback(window->GetGLFWWindow(), KeyCallback);
+        glfwSetFramebufferSizeCallback(window->GetGLFWWindow(), FramebufferResizeCallback);
+    }
+
+    // Jobs land on the track of whichever thread ran them
+    jobSystem->SetTimingCallback([](const char* name, uint32_t, std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end) {
+            CpuProfiler::RecordEvent(name, CpuProfiler::ToProfilerTime(start), CpuProfiler::ToProfilerTime(end));
+        });
+}
+
+Application::~Application() {
+    try {
+        // A running std::thread must not be destroyed (e.g. when Run throws)
+        StopSimulationThread();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
 }
 
 void Application::Run() {
+    // Before loading so texture decoding shows up in the first report
+    AllocationTracker::SetEnabled(options.trackAllocations);
+    CpuProfiler::SetEnabled(options.cpuProfiling);
+    HitchDetector::Configure(options.hitchBudgetMs, options.hitchReports);
+    CpuProfiler::SetThreadName("Main");
+    if (options.assertNoAllocations && (options.gpuProfiling || options.renderStats)) {
+        std::cout << "Overlay: hidden while asserting allocation-free frames" << std::endl;
+    }
+
     InitVulkan();
     SetupScene();
 
     lastFrameTime = std::chrono::high_resolution_clock::now();
+    if (benchmark) {
+        benchmark->MarkStartupComplete();
+    }
+
+    if (options.threadedSimulation) {
+        PublishViewer();
+        StartSimulationThread();
+    }
 
     MainLoop();
     Cleanup();
 }
 
 void Application::InitVulkan() {
-    // Create Vulkan infrastructure
-    vulkanContext = std::make_unique<VulkanContext>();
-    vulkanContext->CreateInstance();
-    vulkanContext->SetupDebugMessenger();
-    vulkanContext->CreateSurface(window->GetGLFWWindow());
+    jobSystem->Initialize();
+    std::cout << "Job system: " << jobSystem->GetThreadCount() << " threads" << std::endl;
 
-    vulkanDevice = std::make_unique<VulkanDevice>(
-        vulkanContext->GetInstance(),
-        vulkanContext->GetSurface()
-    );
-    vulkanDevice->PickPhysicalDevice();
-    vulkanDevice->CreateLogicalDevice();
+    // Create Vulkan infrastructure
+    if (benchmark) {
+        InitHeadless();
+    }
+    else {
+        vulkanContext = std::make_unique<VulkanContext>();
+        vulkanContext->CreateInstance();
+        vulkanContext->SetupDebugMessenger();
+        vulkanContext->CreateSurface(window->GetGLFWWindow());
+
+        vulkanDevice = std::make_unique<VulkanDevice>(
+            vulkanContext->GetInstance(),
+            vulkanContext->GetSurface()
+        );
+        vulkanDevice->PickPhysicalDevice();
+        vulkanDevice->CreateLogicalDevice();
+
+        vulkanSwapChain = std::make_unique<VulkanSwapChain>(
+            vulkanDevice->GetDevice(),
+            vulkanDevice->GetPhysicalDevice(),
+            vulkanContext->GetSurface(),
+            window->GetGLFWWindow()
+        );
+        vulkanSwapChain->Create(vulkanDevice->GetQueueFamilies());
+        vulkanSwapChain->CreateImageViews();
+    }
 
-    vulkanSwapChain = std::make_unique<VulkanSwapChain>(
+    pipelineCache = std::make_unique<VulkanPipelineCache>(
         vulkanDevice->GetDevice(),
         vulkanDevice->GetPhysicalDevice(),
-        vulkanContext->GetSurface(),
-        window->GetGLFWWindow()
+        options.pipelineCachePath
     );
-    vulkanSwapChain->Create(vulkanDevice->GetQueueFamilies());
-    vulkanSwapChain->CreateImageViews();
+    pipelineCache->Create();
+    if (benchmark) {
+        benchmark->SetPipelineCacheWarm(pipelineCache->WasLoaded());
+    }
 
     // Create renderer
     renderer = std::make_unique<Renderer>(
         vulkanDevice.get(),
         vulkanSwapChain.get()
     );
+    renderer->SetJobSystem(jobSystem.get());
+    renderer->SetPipelineCache(pipelineCache->GetCache());
+    renderer->SetRefractionResolution(options.refractionScale);
+    renderer->SetRefractionInterval(options.refractionInterval);
+    renderer->SetPortalStencil(options.portalStencil);
     renderer->Initialize();
+    pipelineCache->Save(); // Now rather than at exit, so a crash still leaves the next launch warm
+    // Benchmarks report GPU pass times and draw counts, so both are always on
+    renderer->GetGpuProfiler().SetEnabled(options.gpuProfiling || benchmark);
+    renderer->GetRenderStats().SetEnabled(options.renderStats || benchmark);
 
     // Create scene
     scene = std::make_unique<Scene>(
         vulkanDevice->GetDevice(),
         vulkanDevice->GetPhysicalDevice()
     );
+    scene->SetJobSystem(jobSystem.get());
+    if (options.randomSeed) {
+        scene->SetRandomSeed(*options.randomSeed);
+    }
 
     renderer->SetupSceneParticles(*scene);
 
@@ -63,6 +164,27 @@ void Application::InitVulkan() {
     cameraController = std::make_unique<CameraController>();
 }
 
+void Application::InitHeadless() {
+    // No window or surface: the renderer draws into plain images that are never presented
+    vulkanContext = std::make_unique<VulkanContext>();
+    vulkanContext->CreateInstance(true);
+    vulkanContext->SetupDebugMessenger();
+
+    vulkanDevice = std::make_unique<VulkanDevice>(vulkanContext->GetInstance(), VK_NULL_HANDLE);
+    vulkanDevice->PickPhysicalDevice();
+    vulkanDevice->CreateLogicalDevice();
+
+    vulkanSwapChain = std::make_unique<VulkanSwapChain>(
+        vulkanDevice->GetDevice(),
+        vulkanDevice->GetPhysicalDevice(),
+        VK_NULL_HANDLE,
+        nullptr
+    );
+    const Benchmark::Settings& settings = benchmark->GetSettings();
+    vulkanSwapChain->CreateHeadless({ settings.width, settings.height });
+    vulkanSwapChain->CreateImageViews();
+}
+
 static const char* SUN_NAME = "Sun";
 static const char* MOON_NAME = "Moon";
 
@@ -78,18 +200,18 @@ void Application::SetupScene() {
 
     const float adjustedRadius = scene->RadiusAdjustment(orbRadius, deltaY);
 
-    scene->AddTerrain("GroundGrid", adjustedRadius, 512, 512, 3.5f, 0.02f, glm::vec3(0.0f, 0.0f + deltaY, 0.0f), "textures/desert2.jpg");
+    // The default config is the regular desert; a stress scene only changes the parts that scale
+    const StressScene::Config content = options.stressScene.value_or(StressScene::Config{});
+    const int terrainResolution = static_cast<int>(content.terrainResolution);
+
+    scene->AddTerrain("GroundGrid", adjustedRadius, terrainResolution, terrainResolution, 3.5f, 0.02f, glm::vec3(0.0f, 0.0f + deltaY, 0.0f), "textures/desert2.jpg");
     scene->AddPedestal("BasePedestal", adjustedRadius, orbRadius * 2.3, 100.0f, glm::vec3(0.0f, 0.0f + deltaY, 0.0f), "textures/mahogany.jpg");
     scene->SetObjectCastsShadow("BasePedestal", false);
     scene->SetObjectLayerMask("BasePedestal", SceneLayers::OUTSIDE);
 
-    // High frequency cacti (small)
-    scene->RegisterProceduralObject("models/cactus.obj", "textures/cactus.jpg", 7.0f, glm::vec3(0.01f), glm::vec3(0.02f), glm::vec3(-90.0f, 0.0f, 0.0f));
-    // Medium frequency dead trees
-    scene->RegisterProceduralObject("models/DeadTree.obj", "textures/bark.jpg", 5.0f, glm::vec3(0.1f), glm::vec3(0.2f));
-    // Low frequency large trees
-    scene->RegisterProceduralObject("models/DeadTree.obj", "textures/bark.jpg", 4.0f, glm::vec3(0.25f), glm::vec3(0.35f));
-    scene->GenerateProceduralObjects(50, orbRadius - 20, deltaY, terrainHeightScale, terrainNoiseFreq);
+    // Cacti and dead trees of two sizes
+    StressScene::RegisterObjects(*scene, content);
+    scene->GenerateProceduralObjects(static_cast<int>(content.objects), orbRadius - 20, deltaY, terrainHeightScale, terrainNoiseFreq);
 
     // sun must be called first
     scene->AddSphere(SUN_NAME, 16, 32, 5.0f, glm::vec3(0.0f), "textures/sun.png");
@@ -122,8 +244,17 @@ void Application::SetupScene() {
     scene->SetObjectCastsShadow("FogShell", false);
     scene->SetObjectLayerMask("FogShell", 0x1 | 0x2);
 
-    scene->AddFire(glm::vec3(0.0f, 0.5f + deltaY, 0.0f), 1.0f, true);   // Fire + Smoke
-    scene->AddFire(glm::vec3(-25.0f, 0.5f + deltaY, 0.0f), 1.0f, true);
+    if (options.stressScene) {
+        const uint32_t seed = options.randomSeed.value_or(DEFAULT_BENCHMARK_SEED);
+        StressScene::AddLights(*scene, content, seed, orbRadius - 20, deltaY);
+        StressScene::AddEmitters(*scene, content, seed, orbRadius - 20, deltaY, terrainHeightScale, terrainNoiseFreq);
+        std::cout << "Stress scene: " << StressScene::ToString(content) << " (" << scene->GetObjects().size() << " objects, "
+            << scene->GetLights().size() << " lights)" << std::endl;
+    }
+    else {
+        scene->AddFire(glm::vec3(0.0f, 0.5f + deltaY, 0.0f), 1.0f, true);   // Fire + Smoke
+        scene->AddFire(glm::vec3(-25.0f, 0.5f + deltaY, 0.0f), 1.0f, true);
+    }
 
     // Add Snow
     scene->AddSnow();
@@ -140,71 +271,364 @@ void Application::RecreateSwapChain() {
         glfwWaitEvents();
     }
 
-    vkDeviceWaitIdle(vulkanDevice->GetDevice());
+    HitchScope hitchScope(HitchDetector::Category::SwapChainRecreate, "Application::RecreateSwapChain");
 
-    // Cleanup old swapchain-dependent resources
-    renderer->Cleanup();
-    vulkanSwapChain->Cleanup();
+    // Only the renderer's own frames can be using the swap chain and the targets sized to it
+    renderer->WaitForFramesInFlight();
 
-    // Recreate swapchain
-    vulkanSwapChain->Create(vulkanDevice->GetQueueFamilies());
-    vulkanSwapChain->CreateImageViews();
+    const VkFormat previousFormat = vulkanSwapChain->GetImageFormat();
+    vulkanSwapChain->Recreate(vulkanDevice->GetQueueFamilies());
 
-    // Recreate renderer resources
-    renderer->Initialize();
+    if (vulkanSwapChain->GetImageFormat() == previousFormat) {
+        // Pipelines, textures, the skybox, the shadow pass and the particle atlas are size independent
+        renderer->Resize();
+    }
+    else {
+        // Render passes and pipelines were built for the old format: rebuild everything, which
+        // re-points particle systems at a new atlas
+        const bool restartSimulation = simulationRunning.load();
+        StopSimulationThread();
 
-    renderer->SetupSceneParticles(*scene);
+        vkDeviceWaitIdle(vulkanDevice->GetDevice());
+        renderer->Cleanup();
+        renderer->Initialize();
+        renderer->SetupSceneParticles(*scene);
+
+        if (restartSimulation) {
+            StartSimulationThread();
+        }
+    }
 
     framebufferResized = false;
+    allocationFrames = 0; // Rebuilt resources need to warm up again
 }
 
 void Application::MainLoop() {
-    while (!window->ShouldClose()) {
+    while (benchmark ? !benchmark->IsFinished() && !IsReplayFinished() : !window->ShouldClose()) {
+        ProfileScope frameScope("Frame");
+        HitchDetector::BeginFrame();
+
+        if (options.trackAllocations) {
+            AllocationTracker::BeginFrame();
+        }
+
         // Calculate delta time
         const auto currentTime = std::chrono::high_resolution_clock::now();
         deltaTime = std::chrono::duration<float>(currentTime - lastFrameTime).count();
         lastFrameTime = currentTime;
 
-        window->PollEvents();
-        ProcessInput();
+        if (benchmark) {
+            // The scripted path (or a replayed trace) replaces input, and a fixed step replaces wall-clock time
+            deltaTime = Benchmark::SIMULATION_STEP;
+            if (inputTrace && inputTrace->IsReplaying()) {
+                ReplayTraceFrame();
+            }
+            else {
+                benchmark->ApplyCameraPath(*cameraController->GetActiveCamera());
+            }
+            PublishViewer();
+        }
+        else {
+            window->PollEvents();
+            ProcessInput();
+
+            if (framebufferResized) {
+                RecreateSwapChain();
+            }
+
+            if (inputTrace && inputTrace->IsReplaying() && !inputTrace->IsReplayFinished()) {
+                ReplayTraceFrame();
+            }
+            else {
+                cameraController->Update(deltaTime);
+            }
+            PublishViewer();
+            UpdateOverlay(deltaTime);
+        }
 
-        if (framebufferResized) {
-            RecreateSwapChain();
+        if (inputTrace && inputTrace->IsRecording()) {
+            const Camera* const camera = cameraController->GetActiveCamera();
+            InputTrace::Frame traceFrame;
+            traceFrame.deltaTime = deltaTime;
+            traceFrame.keys = cameraController->GetInputState();
+            traceFrame.cameraType = static_cast<uint8_t>(cameraController->GetActiveCameraType());
+            traceFrame.position = camera->GetPosition();
+            traceFrame.front = camera->GetFront();
+            traceFrame.dayNightSpeed = dayNightSpeed;
+            inputTrace->RecordFrame(traceFrame);
         }
 
-        cameraController->Update(deltaTime);
-        scene->Update(deltaTime);
+        const auto simulateStart = std::chrono::high_resolution_clock::now();
+        if (options.threadedSimulation) {
+            if (simulationFailed.load()) {
+                std::rethrow_exception(simulationError);
+            }
+        }
+        else {
+            SimulateFrame(deltaTime);
+        }
 
-        // Get camera matrices
-        Camera* const activeCamera = cameraController->GetActiveCamera();
-        const glm::mat4 viewMatrix = activeCamera->GetViewMatrix();
-        // Rule ID: CODSTA-CPP.11 - C++ style cast
-        const glm::mat4 projMatrix = activeCamera->GetProjectionMatrix(
-            vulkanSwapChain->GetExtent().width / static_cast<float>(vulkanSwapChain->GetExtent().height)
-        );
+        // Draw the newest simulated frame; in threaded mode the next one is already being simulated
+        hasSnapshot = snapshots.AcquireLatest() || hasSnapshot;
+        if (!hasSnapshot) continue;
 
-        int currentViewMask = SceneLayers::ALL; // Default
+        const auto renderStart = std::chrono::high_resolution_clock::now();
+        renderer->DrawFrame(snapshots.GetReadBuffer(), currentFrame);
+        const auto renderEnd = std::chrono::high_resolution_clock::now();
+        HitchDetector::EndFrame(std::chrono::duration<double, std::milli>(renderEnd - currentTime).count());
 
-        // Check distance to center (0,0,0)
-        const float dist = glm::length(activeCamera->GetPosition());
-        const float ballRadius = 150.0f; // Matches your setup
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
-        if (dist < ballRadius) {
-            // We are INSIDE: Draw Terrain + Sun/Moon
-            currentViewMask = SceneLayers::INSIDE;
+        AllocationTracker::FrameStats allocations;
+        if (options.trackAllocations) {
+            allocations = CheckFrameAllocations();
         }
-        else {
-            // We are OUTSIDE: Draw Room/Pedestal + Crystal Ball + Sun/Moon
-            currentViewMask = SceneLayers::ALL;
+
+        if (benchmark) {
+            Benchmark::FrameSample sample;
+            sample.frameMs = std::chrono::duration<double, std::milli>(renderEnd - currentTime).count();
+            sample.simulateMs = std::chrono::duration<double, std::milli>(renderStart - simulateStart).count();
+            sample.renderMs = std::chrono::duration<double, std::milli>(renderEnd - renderStart).count();
+            sample.allocations = allocations.allocations;
+            benchmark->RecordFrame(sample, renderer->GetGpuProfiler(), renderer->GetRenderStats());
         }
+    }
 
-        // Pass 'currentViewMask' to DrawFrame
-        renderer->DrawFrame(*scene, currentFrame, viewMatrix, projMatrix, currentViewMask);
+    renderer->WaitIdle();
+}
 
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+void Application::PublishViewer() {
+    Camera* const activeCamera = cameraController->GetActiveCamera();
+
+    ViewerState& viewer = viewerStates.GetWriteBuffer();
+    viewer.position = activeCamera->GetPosition();
+    viewer.view = activeCamera->GetViewMatrix();
+    // Rule ID: CODSTA-CPP.11 - C++ style cast
+    viewer.proj = activeCamera->GetProjectionMatrix(
+        vulkanSwapChain->GetExtent().width / static_cast<float>(vulkanSwapChain->GetExtent().height)
+    );
+    viewerStates.Publish();
+}
+
+void Application::SimulateFrame(float dt) {
+    ProfileScope profileScope("SimulateFrame");
+
+    std::vector<std::function<void(Scene&)>> commands;
+    {
+        std::lock_guard<std::mutex> lock(sceneCommandMutex);
+        commands.swap(sceneCommands);
+    }
+    for (const auto& command : commands) {
+        command(*scene);
     }
 
-    renderer->WaitIdle();
+    viewerStates.AcquireLatest();
+    const ViewerState& viewer = viewerStates.GetReadBuffer();
+
+    // Particle LOD needs this frame's view before the scene simulates
+    scene->SetViewer(viewer.position, viewer.view, viewer.proj);
+
+    float interpolation = 1.0f;
+    if (options.simulationRate > 0.0f) {
+        // Zero or more fixed steps, so the simulation cost no longer scales with the refresh rate
+        const float step = 1.0f / options.simulationRate;
+        simulationAccumulator += std::min(dt, MAX_SIMULATION_FRAME_TIME);
+
+        int steps = 0;
+        while (simulationAccumulator >= step && steps < MAX_SIMULATION_STEPS) {
+            scene->Update(step);
+            simulationAccumulator -= step;
+            ++steps;
+        }
+        // Still behind: catching up would only make the next frame slower
+        if (simulationAccumulator >= step) {
+            simulationAccumulator = std::fmod(simulationAccumulator, step);
+        }
+
+        interpolation = simulationAccumulator / step;
+    }
+    else {
+        scene->Update(dt);
+    }
+
+    RenderSnapshot& snapshot = snapshots.GetWriteBuffer();
+    scene->BuildSnapshot(snapshot, interpolation);
+    snapshot.layerMask = ComputeViewMask(viewer.position);
+    snapshots.Publish();
+}
+
+void Application::StartSimulationThread() {
+    if (simulationRunning.exchange(true)) return;
+    simulationThread = std::thread(&Application::SimulationLoop, this);
+}
+
+void Application::StopSimulationThread() {
+    simulationRunning.store(false);
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+}
+
+void Application::SimulationLoop() {
+    CpuProfiler::SetThreadName("Simulation");
+
+    try {
+        auto lastTime = std::chrono::high_resolution_clock::now();
+
+        while (simulationRunning.load()) {
+            // Stay at most one frame ahead: wait until the renderer has taken the last snapshot
+            if (snapshots.HasUnreadPublish()) {
+                std::this_thread::sleep_for(SIMULATION_IDLE_WAIT);
+                continue;
+            }
+
+            const auto now = std::chrono::high_resolution_clock::now();
+            const float dt = std::chrono::duration<float>(now - lastTime).count();
+            lastTime = now;
+
+            SimulateFrame(dt);
+        }
+    }
+    catch (...) {
+        // Rethrown on the main thread
+        simulationError = std::current_exception();
+        simulationFailed.store(true);
+        simulationRunning.store(false);
+    }
+}
+
+AllocationTracker::FrameStats Application::CheckFrameAllocations() {
+    const AllocationTracker::FrameStats stats = AllocationTracker::EndFrame();
+    ++allocationFrames;
+
+    AllocationTracker::ScopeStats scopes[AllocationTracker::MAX_SCOPES];
+
+    if (options.assertNoAllocations && allocationFrames > ALLOCATION_WARMUP_FRAMES) {
+        if (stats.allocations > 0) {
+            std::string message = "steady-state frame " + std::to_string(allocationFrames) + " made "
+                + std::to_string(stats.allocations) + " heap allocations (" + std::to_string(stats.bytes) + " bytes):";
+            const size_t scopeCount = AllocationTracker::GetScopeStats(scopes, AllocationTracker::MAX_SCOPES);
+            for (size_t i = 0; i < scopeCount; ++i) {
+                message += " " + std::string(scopes[i].name) + " x" + std::to_string(scopes[i].allocations);
+            }
+            throw std::runtime_error(message);
+        }
+        // Keep the scope table to this frame so a failure names the culprit
+        AllocationTracker::ResetScopes();
+    }
+
+    reportAllocations += stats.allocations;
+    reportBytes += stats.bytes;
+    reportPeakBytes = std::max(reportPeakBytes, stats.peakBytes);
+
+    if (allocationFrames % ALLOCATION_REPORT_INTERVAL != 0) return stats;
+
+    std::cout << "Allocations over " << ALLOCATION_REPORT_INTERVAL << " frames: "
+        << static_cast<double>(reportAllocations) / ALLOCATION_REPORT_INTERVAL << " per frame, "
+        << reportBytes / ALLOCATION_REPORT_INTERVAL << " bytes per frame, peak " << reportPeakBytes << " bytes" << std::endl;
+
+    const size_t scopeCount = AllocationTracker::GetScopeStats(scopes, AllocationTracker::MAX_SCOPES);
+    for (size_t i = 0; i < scopeCount; ++i) {
+        std::cout << "  " << scopes[i].name << ": " << scopes[i].allocations << " allocations, " << scopes[i].bytes << " bytes" << std::endl;
+    }
+
+    reportAllocations = 0;
+    reportBytes = 0;
+    reportPeakBytes = 0;
+    AllocationTracker::ResetScopes();
+    return stats;
+}
+
+void Application::UpdateOverlay(float dt) {
+    // Formatting the overlay allocates, so a run asserting allocation-free frames goes without it
+    if (options.assertNoAllocations) return;
+
+    overlayTimer += dt;
+    if (overlayTimer < OVERLAY_INTERVAL) return;
+    overlayTimer = 0.0f;
+
+    const GpuProfiler& profiler = renderer->GetGpuProfiler();
+    const RenderStats& stats = renderer->GetRenderStats();
+    if (!profiler.IsEnabled() && !stats.IsEnabled()) {
+        if (overlayVisible) {
+            window->SetOverlayText("");
+            overlayVisible = false;
+        }
+        return;
+    }
+
+    std::string text;
+    if (profiler.IsEnabled()) {
+        text = profiler.GetSummary();
+        if (profiler.IsDrawAttributionEnabled()) {
+            std::vector<GpuProfiler::DrawTiming> topDraws;
+            profiler.GetTopDraws(OVERLAY_TOP_DRAWS, topDraws);
+            for (const auto& draw : topDraws) {
+                text += " | " + *draw.objectName + " " + std::to_string(draw.milliseconds).substr(0, 5);
+            }
+        }
+    }
+    if (stats.IsEnabled()) {
+        text += (text.empty() ? "" : "  ||  ") + stats.GetSummary();
+    }
+
+    window->SetOverlayText(text);
+    overlayVisible = true;
+}
+
+void Application::DumpGpuProfile() const {
+    GpuProfiler& profiler = renderer->GetGpuProfiler();
+    if (profiler.GetHistorySize() == 0) {
+        std::cout << "GPU profile: nothing recorded yet" << std::endl;
+        return;
+    }
+
+    if (profiler.WriteCsv("gpu_profile.csv") && profiler.WriteJson("gpu_profile.json")) {
+        std::cout << "GPU profile: wrote " << profiler.GetHistorySize() << " frames to gpu_profile.csv/.json" << std::endl;
+    }
+    std::cout << profiler.GetSummary(profiler.GetHistorySize()) << std::endl;
+
+    std::vector<GpuProfiler::DrawTiming> topDraws;
+    profiler.GetTopDraws(DUMP_TOP_DRAWS, topDraws);
+    for (const auto& draw : topDraws) {
+        std::cout << "  " << *draw.objectName << ": " << draw.milliseconds << " ms" << std::endl;
+    }
+}
+
+void Application::WriteCpuTrace() const {
+    // GPU scopes go on their own track, shifted onto the CPU clock
+    std::vector<CpuProfiler::TraceEvent> gpuEvents;
+    if (renderer) {
+        renderer->GetGpuProfiler().AppendTraceEvents(gpuEvents);
+    }
+
+    if (CpuProfiler::WriteChromeTrace("cpu_trace.json", gpuEvents)) {
+        std::cout << "CPU profile: wrote cpu_trace.json (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+    }
+}
+
+void Application::DumpHitches() const {
+    HitchDetector::PrintReports(OVERLAY_HITCH_REPORTS);
+    HitchDetector::WriteReports("hitches.json");
+}
+
+void Application::QueueSceneCommand(std::function<void(Scene&)> command) {
+    std::lock_guard<std::mutex> lock(sceneCommandMutex);
+    sceneCommands.push_back(std::move(command));
+}
+
+int Application::ComputeViewMask(const glm::vec3& cameraPosition) {
+    // Check distance to center (0,0,0)
+    const float dist = glm::length(cameraPosition);
+    const float ballRadius = 150.0f; // Matches your setup
+
+    if (dist < ballRadius) {
+        // We are INSIDE: Draw Terrain + Sun/Moon
+        return SceneLayers::INSIDE;
+    }
+
+    // We are OUTSIDE: Draw Room/Pedestal + Crystal Ball + Sun/Moon
+    return SceneLayers::ALL;
 }
 
 void Application::ProcessInput() {
@@ -226,14 +650,55 @@ void Application::ProcessInput() {
     }
 
     if (speedChanged) {
-        // Apply new speed to both Sun and Moon (Mesh + Light)
-        scene->SetOrbitSpeed(SUN_NAME, dayNightSpeed);
-        scene->SetOrbitSpeed(MOON_NAME, dayNightSpeed);
-
+        ApplyDayNightSpeed();
         //std::cout << "Orbit Speed: " << dayNightSpeed << std::endl; // Optional debug
     }
 }
 
+void Application::ApplyDayNightSpeed() {
+    // Apply new speed to both Sun and Moon (Mesh + Light)
+    const float speed = dayNightSpeed;
+    QueueSceneCommand([speed](Scene& target) {
+        target.SetOrbitSpeed(SUN_NAME, speed);
+        target.SetOrbitSpeed(MOON_NAME, speed);
+        });
+}
+
+void Application::ReplayTraceFrame() {
+    const InputTrace::Frame* const frame = inputTrace->NextReplayFrame();
+
+    if (options.replayOriginalTiming) {
+        // Recorded frame times, hitches included, instead of the fixed step
+        deltaTime = frame->deltaTime;
+    }
+    else if (!benchmark) {
+        deltaTime = Benchmark::SIMULATION_STEP;
+    }
+
+    const CameraType cameraType = static_cast<CameraType>(frame->cameraType);
+    if (cameraType != cameraController->GetActiveCameraType()) {
+        cameraController->SwitchCamera(cameraType);
+    }
+    if (frame->dayNightSpeed != dayNightSpeed) {
+        dayNightSpeed = frame->dayNightSpeed;
+        ApplyDayNightSpeed();
+    }
+
+    cameraController->SetInputState(frame->keys);
+    cameraController->Update(deltaTime);
+    inputTrace->ReportDrift(cameraController->GetActiveCamera()->GetPosition());
+
+    if (inputTrace->IsReplayFinished()) {
+        // Live input takes over from here in a windowed run
+        cameraController->SetInputState(0);
+        std::cout << "Input trace: replay finished, max camera drift " << inputTrace->GetMaxDrift() << std::endl;
+    }
+}
+
+bool Application::IsReplayFinished() const {
+    return inputTrace && inputTrace->IsReplaying() && inputTrace->IsReplayFinished();
+}
+
 // Rule ID: CODSTA.45 - Renamed parameter 'window' to 'glfwWindow'
 void Application::KeyCallback(GLFWwindow* glfwWindow, int key, int scancode, int action, int mods) {
     auto* const app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(glfwWindow));
@@ -252,6 +717,56 @@ void Application::KeyCallback(GLFWwindow* glfwWindow, int key, int scancode, int
             app->cameraController->SwitchCamera(CameraType::ORBIT);
             std::cout << "Switched to Orbit Camera (F3)" << std::endl;
         }
+        else if (key == GLFW_KEY_F5) {
+            GpuProfiler& profiler = app->renderer->GetGpuProfiler();
+            profiler.SetEnabled(!profiler.IsEnabled());
+            std::cout << "GPU profiler: " << (profiler.IsEnabled() ? "on" : "off") << " (F5)" << std::endl;
+        }
+        else if (key == GLFW_KEY_F6) {
+            GpuProfiler& profiler = app->renderer->GetGpuProfiler();
+            profiler.SetDrawAttribution(!profiler.IsDrawAttributionEnabled());
+            if (profiler.IsDrawAttributionEnabled()) profiler.SetEnabled(true);
+            std::cout << "GPU per-draw timing: " << (profiler.IsDrawAttributionEnabled() ? "on" : "off") << " (F6)" << std::endl;
+        }
+        else if (key == GLFW_KEY_F7) {
+            app->DumpGpuProfile();
+        }
+        else if (key == GLFW_KEY_F8) {
+            CpuProfiler::SetEnabled(!CpuProfiler::IsEnabled());
+            std::cout << "CPU profiler: " << (CpuProfiler::IsEnabled() ? "on" : "off") << " (F8)" << std::endl;
+        }
+        else if (key == GLFW_KEY_F9) {
+            app->WriteCpuTrace();
+        }
+        else if (key == GLFW_KEY_F10) {
+            RenderStats& stats = app->renderer->GetRenderStats();
+            stats.SetEnabled(!stats.IsEnabled());
+            std::cout << "Render stats: " << (stats.IsEnabled() ? "on" : "off") << " (F10)" << std::endl;
+        }
+        else if (key == GLFW_KEY_F11) {
+            const RenderStats& stats = app->renderer->GetRenderStats();
+            if (stats.IsEnabled()) {
+                std::cout << stats.GetReport();
+            }
+            else {
+                std::cout << "Render stats: off, press F10 first" << std::endl;
+            }
+        }
+        else if (key == GLFW_KEY_F12) {
+            if (HitchDetector::IsEnabled()) {
+                app->DumpHitches();
+            }
+            else {
+                std::cout << "Hitch detector: off, start with --hitch-budget MS" << std::endl;
+            }
+        }
+        else if (key == GLFW_KEY_F4) {
+            // Cycle particle resolution: full -> half -> quarter
+            const uint32_t current = app->renderer->GetParticleResolution();
+            const uint32_t next = (current >= 4) ? 1 : current * 2;
+            app->renderer->SetParticleResolution(next);
+            std::cout << "Particle resolution: 1/" << next << " (F4)" << std::endl;
+        }
 
         // Forward key press to camera controller
         app->cameraController->OnKeyPress(key, true);
@@ -268,6 +783,28 @@ void Application::FramebufferResizeCallback(GLFWwindow* glfwWindow, int width, i
 }
 
 void Application::Cleanup() {
+    StopSimulationThread();
+
+    if (inputTrace) {
+        inputTrace->StopRecording();
+    }
+
+    // Draw timings reference scene object names, so dump before the scene goes
+    if (renderer && options.gpuProfiling) {
+        DumpGpuProfile();
+    }
+    if (options.cpuProfiling) {
+        WriteCpuTrace();
+    }
+    if (HitchDetector::IsEnabled() && HitchDetector::GetHitchCount() > 0) {
+        DumpHitches();
+    }
+    if (benchmark && renderer) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(vulkanDevice->GetPhysicalDevice(), &properties);
+        benchmark->WriteReport(properties.deviceName);
+    }
+
     if (scene) {
         scene->Cleanup();
         scene.reset();
@@ -278,6 +815,11 @@ void Application::Cleanup() {
         renderer.reset();
     }
 
+    if (pipelineCache) {
+        pipelineCache->Cleanup();
+        pipelineCache.reset();
+    }
+
     if (vulkanSwapChain) {
         vulkanSwapChain->Cleanup();
         vulkanSwapChain.reset();
@@ -293,4 +835,8 @@ void Application::Cleanup() {
         vulkanContext.reset();
     }
 
+    if (jobSystem) {
+        jobSystem->Cleanup();
+    }
+
 }
\ No newline at end of file
@@ -1,42 +1,153 @@
 #pragma once
 
 #include "../core/Window.h"
+#include "../core/JobSystem.h"
+#include "../core/TripleBuffer.h"
+#include "../core/Benchmark.h"
+#include "../core/StressScene.h"
+#include "../core/InputTrace.h"
+#include "../core/HitchDetector.h"
+#include "../core/AllocationTracker.h"
 #include "../vulkan/VulkanContext.h"
 #include "../vulkan/VulkanDevice.h"
 #include "../vulkan/VulkanSwapChain.h"
+#include "../vulkan/VulkanPipelineCache.h"
 #include "../rendering/Renderer.h"
 #include "../rendering/Scene.h"
 #include "../rendering/CameraController.h"
+#include "../rendering/RenderSnapshot.h"
 
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ApplicationOptions {
+    uint32_t workerThreads = 0;       // Job system threads besides the main thread, 0 = one per spare hardware thread
+    bool threadedSimulation = false;  // Simulate on its own thread, one frame ahead of rendering
+    bool trackAllocations = false;    // Print per-frame heap allocation reports
+    bool assertNoAllocations = false; // Fail if a steady-state frame allocates (implies trackAllocations)
+    bool gpuProfiling = false;        // Time every pass with GPU timestamps (F5 toggles, F6 per-draw, F7 dumps)
+    bool renderStats = false;         // Per-pass draw/bind/culling counters in the overlay (F10 toggles, F11 prints per pass)
+    bool cpuProfiling = false;        // Record CPU markers from startup and write a trace on exit (F8 toggles, F9 writes)
+    double hitchBudgetMs = 0.0;       // Report frames slower than this with the stalls that ran in them (F12 dumps), 0 = off
+    uint32_t hitchReports = HitchDetector::DEFAULT_REPORT_COUNT; // Newest hitch reports kept
+    float simulationRate = 60.0f;     // Fixed simulation steps per second, rendering interpolates between them. 0 = one variable step per frame
+    std::optional<uint32_t> randomSeed; // Seeds procedural placement and particles; unset = random (benchmarks default to 1)
+
+    // Headless benchmark: no window, a scripted camera and a fixed step, then a JSON report and exit. 0 = interactive.
+    uint32_t benchmarkFrames = 0;
+    uint32_t benchmarkWidth = 1280;
+    uint32_t benchmarkHeight = 720;
+    std::string benchmarkOutput = "benchmark.json";
+
+    // Generated scaling scene instead of the default desert (objects, lights, emitters, terrain, textures)
+    std::optional<StressScene::Config> stressScene;
+
+    // Input traces: record held keys, camera and frame times every frame, or drive the camera from a
+    // recording (in place of live input or the benchmark's scripted path). Replays step at the fixed
+    // benchmark rate unless replayOriginalTiming asks for the recorded frame times.
+    std::string recordTracePath;
+    std::string replayTracePath;
+    bool replayOriginalTiming = false;
+
+    // Pipeline cache file, read at startup and written when it changed. Empty = in memory only (a cold start every launch).
+    std::string pipelineCachePath = "pipeline_cache.bin";
+
+    // Refraction target resolution as a fraction of the screen's (0.25 to 1), and how many frames each
+    // render of it is reused for (1 = every frame)
+    float refractionScale = 1.0f;
+    uint32_t refractionInterval = 1;
+
+    // From outside the orb, draw its interior only where the crystal ball is stenciled
+    bool portalStencil = true;
+};
 
 class Application final {
 public:
-    Application();
-    ~Application() = default;
+    explicit Application(const ApplicationOptions& optionsArg = ApplicationOptions{});
+    ~Application();
 
     void Run();
 
 private:
     void InitVulkan();
+    void InitHeadless();
     void SetupScene();
     void MainLoop();
     void Cleanup();
     void RecreateSwapChain();
 
+    // Simulation. The main thread publishes the camera, SimulateFrame turns it into a render
+    // snapshot, and the renderer draws the newest snapshot. In threaded mode SimulateFrame runs
+    // on simulationThread and both handoffs are lock-free triple buffers.
+    // The scene advances in fixed steps; leftover time becomes the snapshot's interpolation factor.
+    struct ViewerState {
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::mat4 view = glm::mat4(1.0f);
+        glm::mat4 proj = glm::mat4(1.0f);
+    };
+
+    void PublishViewer();
+    void SimulateFrame(float dt);
+    void StartSimulationThread();
+    void StopSimulationThread();
+    void SimulationLoop();
+
+    // Scene changes from input are deferred to the simulation so they never race with Update
+    void QueueSceneCommand(std::function<void(Scene&)> command);
+    static int ComputeViewMask(const glm::vec3& cameraPosition);
+
+    // Allocation tracking: closes the frame's counters, reports periodically, enforces assertNoAllocations
+    AllocationTracker::FrameStats CheckFrameAllocations();
+
+    // Profiling output: GPU timings and render stats in the window title, CSV/JSON dumps of the GPU timings, and a
+    // Chrome trace of the CPU markers with the GPU scopes alongside
+    void UpdateOverlay(float dt);
+    void DumpGpuProfile() const;
+    void WriteCpuTrace() const;
+    void DumpHitches() const;   // Prints the newest reports and writes hitches.json
+
     // Input handling
     void ProcessInput();
+    void ApplyDayNightSpeed();
+    void ReplayTraceFrame();   // Only while frames remain
+    bool IsReplayFinished() const;
     static void KeyCallback(GLFWwindow* glfwWindow, int key, int scancode, int action, int mods);
     static void FramebufferResizeCallback(GLFWwindow* glfwWindow, int width, int height);
 
     std::unique_ptr<Window> window;
+    std::unique_ptr<JobSystem> jobSystem;
     std::unique_ptr<VulkanContext> vulkanContext;
     std::unique_ptr<VulkanDevice> vulkanDevice;
     std::unique_ptr<VulkanSwapChain> vulkanSwapChain;
+    std::unique_ptr<VulkanPipelineCache> pipelineCache; // Outlives renderer rebuilds
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Scene> scene;
     std::unique_ptr<CameraController> cameraController;
+    std::unique_ptr<Benchmark> benchmark; // Only in benchmark runs, which have no window
+    std::unique_ptr<InputTrace> inputTrace; // Only when recording or replaying
+
+    ApplicationOptions options;
+
+    TripleBuffer<ViewerState> viewerStates;     // Main thread -> simulation
+    TripleBuffer<RenderSnapshot> snapshots;     // Simulation -> renderer
+    bool hasSnapshot = false;
+
+    std::thread simulationThread;
+    std::atomic<bool> simulationRunning{ false };
+    std::atomic<bool> simulationFailed{ false };
+    std::exception_ptr simulationError;
+    float simulationAccumulator = 0.0f; // Unsimulated time, owned by whichever thread runs SimulateFrame
+
+    std::mutex sceneCommandMutex;
+    std::vector<std::function<void(Scene&)>> sceneCommands;
 
     std::chrono::time_point<std::chrono::high_resolution_clock> lastFrameTime;
 
@@ -46,5 +157,23 @@ private:
 
     bool framebufferResized = false;
 
+    float overlayTimer = 0.0f;
+    bool overlayVisible = false;
+
+    uint32_t allocationFrames = 0;       // Frames since tracking (re)started
+    uint64_t reportAllocations = 0;      // Totals since the last report
+    uint64_t reportBytes = 0;
+    uint64_t reportPeakBytes = 0;
+
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr std::chrono::microseconds SIMULATION_IDLE_WAIT{ 200 };
+    static constexpr float MAX_SIMULATION_FRAME_TIME = 0.25f; // Longer frames (breakpoints, window drags) are clamped
+    static constexpr int MAX_SIMULATION_STEPS = 8;             // Per frame; any remaining backlog is dropped
+    static constexpr uint32_t ALLOCATION_WARMUP_FRAMES = 120;  // Caches and arenas settle before frames count as steady
+    static constexpr uint32_t ALLOCATION_REPORT_INTERVAL = 300;
+    static constexpr float OVERLAY_INTERVAL = 0.5f;            // Seconds between overlay refreshes
+    static constexpr size_t OVERLAY_TOP_DRAWS = 3;
+    static constexpr size_t DUMP_TOP_DRAWS = 10;
+    static constexpr uint32_t OVERLAY_HITCH_REPORTS = 8;       // Printed by DumpHitches; the file gets all of them
+    static constexpr uint32_t DEFAULT_BENCHMARK_SEED = 1;
 };
\ No newline at end of file
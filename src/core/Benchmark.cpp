@@ -0,0 +1,186 @@
+#include "Benchmark.h"
+#include "../rendering/GpuProfiler.h"
+#include "../rendering/RenderStats.h"
+#include "HitchDetector.h"
+#include "../bench/JsonMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+    struct Keyframe {
+        float time;
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+
+    // One lap: around the orb from outside, down through the glass, a loop over the terrain at
+    // about half the orb's radius, and back out. The first key is repeated at PATH_DURATION.
+    const Keyframe CAMERA_PATH[] = {
+        { 0.0f,  glm::vec3(0.0f, 60.0f, 300.0f),   glm::vec3(0.0f, 40.0f, 0.0f) },
+        { 5.0f,  glm::vec3(300.0f, 30.0f, 0.0f),   glm::vec3(0.0f, 0.0f, 0.0f) },
+        { 10.0f, glm::vec3(0.0f, 80.0f, -300.0f),  glm::vec3(0.0f, 0.0f, 0.0f) },
+        { 13.0f, glm::vec3(0.0f, -30.0f, -80.0f),  glm::vec3(0.0f, -50.0f, 0.0f) },
+        { 16.0f, glm::vec3(80.0f, -40.0f, 0.0f),   glm::vec3(0.0f, -60.0f, 0.0f) },
+        { 19.0f, glm::vec3(0.0f, -30.0f, 80.0f),   glm::vec3(0.0f, -50.0f, 0.0f) },
+        { 24.0f, glm::vec3(0.0f, 60.0f, 300.0f),   glm::vec3(0.0f, 40.0f, 0.0f) },
+    };
+    constexpr size_t CAMERA_KEYS = sizeof(CAMERA_PATH) / sizeof(CAMERA_PATH[0]);
+
+    // Nearest-rank percentile of an already sorted list
+    double Percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) return 0.0;
+        const size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    template <typename T>
+    double Mean(const std::vector<T>& values) {
+        if (values.empty()) return 0.0;
+        double sum = 0.0;
+        for (const auto& value : values) sum += static_cast<double>(value);
+        return sum / static_cast<double>(values.size());
+    }
+
+    void WriteDistribution(std::ofstream& file, std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        file << "{\"mean\":" << Mean(values) << ",\"p50\":" << Percentile(values, 0.50) << ",\"p95\":" << Percentile(values, 0.95)
+            << ",\"p99\":" << Percentile(values, 0.99) << ",\"max\":" << (values.empty() ? 0.0 : values.back()) << "}";
+    }
+}
+
+Benchmark::Benchmark(const Settings& settingsArg)
+    : settings(settingsArg), startTime(std::chrono::steady_clock::now()) {
+    samples.reserve(settings.frames);
+    drawCalls.reserve(settings.frames);
+    triangles.reserve(settings.frames);
+}
+
+void Benchmark::MarkStartupComplete() {
+    startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Benchmark::ApplyCameraPath(Camera& camera) const {
+    const float time = std::fmod(static_cast<float>(frameIndex) * SIMULATION_STEP, PATH_DURATION);
+
+    size_t key = 0;
+    while (key + 2 < CAMERA_KEYS && CAMERA_PATH[key + 1].time <= time) {
+        ++key;
+    }
+    const Keyframe& from = CAMERA_PATH[key];
+    const Keyframe& to = CAMERA_PATH[key + 1];
+
+    // Smoothstep between keys so the camera eases through them instead of turning sharply
+    const float t = glm::clamp((time - from.time) / (to.time - from.time), 0.0f, 1.0f);
+    const float eased = t * t * (3.0f - 2.0f * t);
+    camera.SetPosition(glm::mix(from.position, to.position, eased));
+    camera.SetTarget(glm::mix(from.target, to.target, eased));
+}
+
+void Benchmark::RecordFrame(const FrameSample& sample, const GpuProfiler& profiler, const RenderStats& stats) {
+    const bool measured = frameIndex >= settings.warmupFrames;
+    ++frameIndex;
+    if (!measured) return;
+
+    samples.push_back(sample);
+    const RenderStats::Counters commands = stats.GetFrameStats().TotalCommands();
+    drawCalls.push_back(commands.drawCalls);
+    triangles.push_back(commands.triangles);
+
+    if (profiler.GetHistorySize() == 0) return;
+    const GpuProfiler::FrameTimings& timings = profiler.GetHistoryFrame(0);
+    if (timings.frameIndex == lastGpuFrame) return;
+    lastGpuFrame = timings.frameIndex;
+
+    ++gpuFrames;
+    gpuFrameMs += timings.frameMilliseconds;
+    for (const auto& scope : timings.scopes) {
+        if (scope.depth != 1) continue;
+
+        auto it = std::find_if(gpuPasses.begin(), gpuPasses.end(),
+            [&scope](const PassTotal& pass) { return std::strcmp(pass.name, scope.name) == 0; });
+        if (it == gpuPasses.end()) {
+            gpuPasses.push_back({ scope.name, 0.0 });
+            it = gpuPasses.end() - 1;
+        }
+        it->milliseconds += scope.milliseconds;
+    }
+}
+
+bool Benchmark::WriteReport(const std::string& deviceName) const {
+    std::ofstream file(settings.outputPath);
+    if (!file.is_open()) {
+        std::cerr << "Warning: could not write benchmark report to " << settings.outputPath << std::endl;
+        return false;
+    }
+
+    std::vector<double> frameMs, simulateMs, renderMs;
+    std::vector<uint64_t> allocations;
+    for (const auto& sample : samples) {
+        frameMs.push_back(sample.frameMs);
+        simulateMs.push_back(sample.simulateMs);
+        renderMs.push_back(sample.renderMs);
+        allocations.push_back(sample.allocations);
+    }
+
+    const double gpuFrameCount = std::max(1.0, static_cast<double>(gpuFrames));
+
+    file << "{\n\"frames\":" << samples.size() << ",\n\"warmupFrames\":" << settings.warmupFrames
+        << ",\n\"width\":" << settings.width << ",\n\"height\":" << settings.height << ",\n\"seed\":" << settings.seed
+        << ",\n\"device\":\"";
+    JsonMetrics::WriteEscaped(file, deviceName);
+    file << "\"";
+    if (settings.stressScene) {
+        const StressScene::Config& scene = *settings.stressScene;
+        file << ",\n\"scene\":{\"objects\":" << scene.objects << ",\"lights\":" << scene.lights << ",\"emitters\":" << scene.emitters
+            << ",\"terrain\":" << scene.terrainResolution << ",\"textures\":" << scene.textures << "}";
+    }
+    file << ",\n\"startupMs\":" << startupMs << ",\n\"pipelineCacheWarm\":" << (pipelineCacheWarm ? "true" : "false")
+        << ",\n\"frameMs\":";
+    WriteDistribution(file, frameMs);
+    file << ",\n\"cpuMs\":{\"simulate\":";
+    WriteDistribution(file, simulateMs);
+    file << ",\"render\":";
+    WriteDistribution(file, renderMs);
+    file << "},\n\"gpuMs\":{\"frames\":" << gpuFrames << ",\"frame\":" << gpuFrameMs / gpuFrameCount << ",\"passes\":{";
+    for (size_t i = 0; i < gpuPasses.size(); ++i) {
+        file << (i ? "," : "") << "\"";
+        JsonMetrics::WriteEscaped(file, gpuPasses[i].name);
+        file << "\":" << gpuPasses[i].milliseconds / gpuFrameCount;
+    }
+    file << "}},\n\"peakResidentMb\":" << PeakResidentMegabytes()
+        << ",\n\"allocationsPerFrame\":{\"mean\":" << Mean(allocations)
+        << ",\"max\":" << (allocations.empty() ? 0 : *std::max_element(allocations.begin(), allocations.end())) << "}"
+        << ",\n\"drawCallsPerFrame\":" << Mean(drawCalls)
+        << ",\n\"trianglesPerFrame\":" << Mean(triangles);
+    if (HitchDetector::IsEnabled()) {
+        file << ",\n\"hitches\":{\"budgetMs\":" << HitchDetector::GetBudgetMs() << ",\"count\":" << HitchDetector::GetHitchCount() << "}";
+    }
+    file << "\n}\n";
+
+    std::cout << "Benchmark: " << samples.size() << " frames, " << Mean(frameMs) << " ms mean, startup " << startupMs
+        << " ms, wrote " << settings.outputPath << std::endl;
+    return true;
+}
+
+double Benchmark::PeakResidentMegabytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+    return static_cast<double>(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return static_cast<double>(usage.ru_maxrss) / 1024.0; // Kilobytes on Linux
+#endif
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../rendering/Camera.h"
+#include "StressScene.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+class GpuProfiler;
+class RenderStats;
+
+// Scripted headless runs with comparable numbers. The camera follows a fixed path evaluated from
+// the frame index, the scene advances by a fixed step and is seeded, so two runs on the same
+// machine differ only by the code under test. Warm-up frames are rendered but not measured.
+class Benchmark final {
+public:
+    struct Settings {
+        uint32_t frames = 600;
+        uint32_t warmupFrames = 60;
+        uint32_t width = 1280;
+        uint32_t height = 720;
+        uint32_t seed = 0;
+        std::string outputPath = "benchmark.json";
+        std::optional<StressScene::Config> stressScene; // Written to the report so runs can be charted per axis
+    };
+
+    // Main-thread costs of one rendered frame
+    struct FrameSample {
+        double frameMs = 0.0;
+        double simulateMs = 0.0;
+        double renderMs = 0.0;         // Renderer::DrawFrame, including its fence wait
+        uint64_t allocations = 0;
+    };
+
+    explicit Benchmark(const Settings& settingsArg);
+    ~Benchmark() = default;
+
+    // Non-copyable
+    Benchmark(const Benchmark&) = delete;
+    Benchmark& operator=(const Benchmark&) = delete;
+
+    const Settings& GetSettings() const { return settings; }
+
+    // Startup is measured from construction to this call (before the first frame)
+    void MarkStartupComplete();
+    // Whether startup compiled its pipelines from a cache file; reported next to startupMs
+    void SetPipelineCacheWarm(bool warm) { pipelineCacheWarm = warm; }
+
+    // Poses the camera for the frame about to be simulated
+    void ApplyCameraPath(Camera& camera) const;
+    bool IsFinished() const { return frameIndex >= settings.warmupFrames + settings.frames; }
+
+    // After every rendered frame. GPU timings arrive a few frames late; each resolved frame is counted once.
+    void RecordFrame(const FrameSample& sample, const GpuProfiler& profiler, const RenderStats& stats);
+
+    bool WriteReport(const std::string& deviceName) const;
+
+    // Simulation step used instead of wall-clock time
+    static constexpr float SIMULATION_STEP = 1.0f / 60.0f;
+
+private:
+    struct PassTotal {
+        const char* name = nullptr;
+        double milliseconds = 0.0;
+    };
+
+    Settings settings;
+    uint32_t frameIndex = 0;
+
+    std::chrono::steady_clock::time_point startTime;
+    double startupMs = 0.0;
+    bool pipelineCacheWarm = false;
+
+    std::vector<FrameSample> samples;   // Measured frames only, reserved up front
+    std::vector<uint64_t> drawCalls;
+    std::vector<uint64_t> triangles;
+
+    uint64_t lastGpuFrame = UINT64_MAX;
+    uint32_t gpuFrames = 0;
+    double gpuFrameMs = 0.0;
+    std::vector<PassTotal> gpuPasses;   // Depth-1 scopes, summed
+
+    // Seconds for one lap of the camera path, which then repeats
+    static constexpr float PATH_DURATION = 24.0f;
+
+    static double PeakResidentMegabytes();
+};
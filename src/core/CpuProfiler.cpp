@@ -0,0 +1,172 @@
+#include "CpuProfiler.h"
+#include "../bench/JsonMetrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // Fields are atomics so the exporter can read a ring while its owner keeps writing
+    struct EventSlot {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<int64_t> start{ 0 };
+        std::atomic<int64_t> end{ 0 };
+    };
+
+    struct ThreadBuffer {
+        std::unique_ptr<EventSlot[]> events{ new EventSlot[CpuProfiler::EVENTS_PER_THREAD] };
+        std::atomic<uint64_t> head{ 0 };   // Total events written; the ring keeps the newest
+        char name[32] = "Thread";
+        bool active = true;                // Owned by a live thread
+    };
+
+    std::atomic<bool> profilingEnabled{ false };
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    std::mutex buffersMutex; // Guards buffers, and the names and active flags inside them
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    // Hands the buffer back when its thread exits; the next new thread reuses it
+    struct BufferOwner {
+        ThreadBuffer* buffer = nullptr;
+
+        ~BufferOwner() {
+            if (!buffer) return;
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffer->active = false;
+        }
+    };
+    thread_local BufferOwner bufferOwner;
+
+    ThreadBuffer& GetThreadBuffer() {
+        if (bufferOwner.buffer) return *bufferOwner.buffer;
+
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers) {
+            if (!buffer->active) {
+                buffer->active = true;
+                bufferOwner.buffer = buffer.get();
+                return *buffer;
+            }
+        }
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        bufferOwner.buffer = buffers.back().get();
+        return *bufferOwner.buffer;
+    }
+
+    void WriteEvent(std::ofstream& file, bool& first, const char* name, int pid, size_t tid, int64_t startNs, int64_t durationNs) {
+        file << (first ? "\n" : ",\n") << "{\"name\":\"";
+        JsonMetrics::WriteEscaped(file, name);
+        file << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+            << ",\"ts\":" << static_cast<double>(startNs) / 1000.0
+            << ",\"dur\":" << static_cast<double>(durationNs) / 1000.0 << "}";
+        first = false;
+    }
+
+    void WriteMetadata(std::ofstream& file, bool& first, const char* kind, int pid, size_t tid, const char* name) {
+        file << (first ? "\n" : ",\n") << "{\"name\":\"" << kind << "\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":\"";
+        JsonMetrics::WriteEscaped(file, name);
+        file << "\"}}";
+        first = false;
+    }
+}
+
+namespace CpuProfiler {
+    void SetEnabled(bool enabled) {
+        profilingEnabled.store(enabled);
+    }
+
+    bool IsEnabled() {
+        return profilingEnabled.load(std::memory_order_relaxed);
+    }
+
+    int64_t Now() {
+        return ToProfilerTime(std::chrono::steady_clock::now());
+    }
+
+    int64_t ToProfilerTime(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count();
+    }
+
+    void SetThreadName(const char* name) {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        std::strncpy(buffer.name, name, sizeof(buffer.name) - 1);
+        buffer.name[sizeof(buffer.name) - 1] = '\0';
+    }
+
+    void RecordEvent(const char* name, int64_t startNs, int64_t endNs) {
+        if (!profilingEnabled.load(std::memory_order_relaxed)) return;
+
+        ThreadBuffer& buffer = GetThreadBuffer();
+        const uint64_t index = buffer.head.load(std::memory_order_relaxed);
+        EventSlot& slot = buffer.events[index % EVENTS_PER_THREAD];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start.store(startNs, std::memory_order_relaxed);
+        slot.end.store(endNs, std::memory_order_relaxed);
+        buffer.head.store(index + 1, std::memory_order_release);
+    }
+
+    bool WriteChromeTrace(const std::string& path, const std::vector<TraceEvent>& extraEvents, const char* extraTrackName) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Warning: could not write CPU trace to " << path << std::endl;
+            return false;
+        }
+
+        constexpr int CPU_PID = 1;
+        constexpr int EXTRA_PID = 2;
+
+        std::vector<TraceEvent> events;
+        bool first = true;
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        WriteMetadata(file, first, "process_name", CPU_PID, 0, "CPU");
+
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (size_t tid = 0; tid < buffers.size(); ++tid) {
+            const ThreadBuffer& buffer = *buffers[tid];
+            WriteMetadata(file, first, "thread_name", CPU_PID, tid, buffer.name);
+
+            // Copy the newest events, then drop any the owner overwrote while we read
+            const uint64_t head = buffer.head.load(std::memory_order_acquire);
+            const uint64_t begin = (head > EVENTS_PER_THREAD) ? head - EVENTS_PER_THREAD : 0;
+            events.clear();
+            for (uint64_t i = begin; i < head; ++i) {
+                const EventSlot& slot = buffer.events[i % EVENTS_PER_THREAD];
+                const int64_t start = slot.start.load(std::memory_order_relaxed);
+                events.push_back({ slot.name.load(std::memory_order_relaxed), start, slot.end.load(std::memory_order_relaxed) - start });
+            }
+
+            const uint64_t headAfter = buffer.head.load(std::memory_order_acquire);
+            const uint64_t overwritten = (headAfter > EVENTS_PER_THREAD + begin) ? headAfter - EVENTS_PER_THREAD - begin : 0;
+            for (size_t i = static_cast<size_t>(std::min<uint64_t>(overwritten, events.size())); i < events.size(); ++i) {
+                if (events[i].name) {
+                    WriteEvent(file, first, events[i].name, CPU_PID, tid, events[i].startNs, events[i].durationNs);
+                }
+            }
+        }
+
+        if (!extraEvents.empty()) {
+            WriteMetadata(file, first, "process_name", EXTRA_PID, 0, extraTrackName);
+            for (const auto& event : extraEvents) {
+                WriteEvent(file, first, event.name, EXTRA_PID, 0, event.startNs, event.durationNs);
+            }
+        }
+
+        file << "\n]}\n";
+        return true;
+    }
+}
+
+ProfileScope::ProfileScope(const char* nameArg)
+    : name(nameArg), start(profilingEnabled.load(std::memory_order_relaxed) ? CpuProfiler::Now() : -1) {
+}
+
+ProfileScope::~ProfileScope() {
+    if (start >= 0) {
+        CpuProfiler::RecordEvent(name, start, CpuProfiler::Now());
+    }
+}
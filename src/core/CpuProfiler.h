@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped CPU timing markers. Each thread appends completed events to its own lock-free ring
+// buffer, so recording never contends; the newest events of every thread can be exported as
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev). Cheap enough to stay compiled
+// in: while disabled a marker costs one relaxed atomic load.
+namespace CpuProfiler {
+    struct TraceEvent {
+        const char* name = nullptr;
+        int64_t startNs = 0;       // Profiler clock, see Now
+        int64_t durationNs = 0;
+    };
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled();
+
+    // Nanoseconds on the profiler clock (steady_clock)
+    int64_t Now();
+    int64_t ToProfilerTime(std::chrono::steady_clock::time_point time);
+
+    // Labels the calling thread's track in exported traces (copied)
+    void SetThreadName(const char* name);
+
+    // Records a finished event on the calling thread. name must outlive the program (a string literal).
+    void RecordEvent(const char* name, int64_t startNs, int64_t endNs);
+
+    // Writes every buffered event, plus extraEvents on a separate track named extraTrackName
+    // (e.g. GPU timings already converted to the profiler clock)
+    bool WriteChromeTrace(const std::string& path, const std::vector<TraceEvent>& extraEvents = {}, const char* extraTrackName = "GPU");
+
+    constexpr size_t EVENTS_PER_THREAD = 1 << 15;
+}
+
+// Times the enclosing block on the calling thread
+class ProfileScope final {
+public:
+    explicit ProfileScope(const char* nameArg);
+    ~ProfileScope();
+
+    // Non-copyable
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    int64_t start; // -1 when the profiler was off at construction
+};
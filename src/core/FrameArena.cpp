@@ -0,0 +1,77 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t capacityArg)
+    : upstream(std::pmr::new_delete_resource()), capacity(capacityArg) {
+    if (capacity > 0) {
+        buffer = static_cast<std::byte*>(upstream->allocate(capacity, BUFFER_ALIGNMENT));
+    }
+}
+
+FrameArena::~FrameArena() {
+    try {
+        Reset();
+        if (buffer) {
+            upstream->deallocate(buffer, capacity, BUFFER_ALIGNMENT);
+            buffer = nullptr;
+        }
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void FrameArena::Reset() {
+    const size_t frameBytes = offset.load(std::memory_order_relaxed) + overflowBytes;
+    peakBytes = std::max(peakBytes, frameBytes);
+
+    for (const auto& block : overflow) {
+        upstream->deallocate(block.pointer, block.bytes, block.alignment);
+    }
+    overflow.clear();
+    overflowBytes = 0;
+    offset.store(0, std::memory_order_relaxed);
+
+    // Grow past the peak (with alignment slack) so the next frame fits entirely
+    if (peakBytes > capacity) {
+        size_t newCapacity = std::max<size_t>(capacity, 1);
+        while (newCapacity < peakBytes + peakBytes / 4) newCapacity *= 2;
+
+        if (buffer) upstream->deallocate(buffer, capacity, BUFFER_ALIGNMENT);
+        buffer = nullptr;
+        capacity = 0;
+        buffer = static_cast<std::byte*>(upstream->allocate(newCapacity, BUFFER_ALIGNMENT));
+        capacity = newCapacity;
+    }
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    const uintptr_t base = reinterpret_cast<uintptr_t>(buffer);
+
+    size_t current = offset.load(std::memory_order_relaxed);
+    while (buffer) {
+        const uintptr_t aligned = (base + current + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        const size_t next = static_cast<size_t>(aligned - base) + bytes;
+        if (next > capacity) break;
+
+        if (offset.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    // Out of space this frame: serve it from the heap and remember to grow on Reset
+    void* pointer = upstream->allocate(bytes, alignment);
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    overflow.push_back({ pointer, bytes, alignment });
+    overflowBytes += bytes + alignment;
+    return pointer;
+}
+
+void FrameArena::do_deallocate(void* /*pointer*/, size_t /*bytes*/, size_t /*alignment*/) {
+    // Everything is released at once by Reset
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+// Linear (bump) allocator for data that only lives for one frame. Allocating is an atomic add,
+// deallocating does nothing and Reset releases everything at once. Use it through std::pmr
+// containers. Requests that don't fit fall back to the heap; the next Reset grows the buffer
+// to the frame's peak, so a steady-state frame never touches the global allocator.
+class FrameArena final : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t capacityArg = DEFAULT_CAPACITY);
+    ~FrameArena() override;
+
+    // Non-copyable
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Releases every allocation. Nothing allocated since the last Reset may still be in use.
+    void Reset();
+
+    size_t GetUsedBytes() const { return offset.load(std::memory_order_relaxed); }
+    size_t GetCapacity() const { return capacity; }
+    size_t GetPeakBytes() const { return peakBytes; } // Largest frame so far, overflow included
+
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;
+
+private:
+    struct OverflowBlock {
+        void* pointer;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::byte* buffer = nullptr;
+    size_t capacity;
+    std::atomic<size_t> offset{ 0 };
+
+    std::mutex overflowMutex; // Guards overflow and overflowBytes
+    std::vector<OverflowBlock> overflow;
+    size_t overflowBytes = 0;
+    size_t peakBytes = 0;
+
+    static constexpr size_t BUFFER_ALIGNMENT = alignof(std::max_align_t);
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
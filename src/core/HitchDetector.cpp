@@ -0,0 +1,229 @@
+#include "HitchDetector.h"
+#include "CpuProfiler.h"
+#include "../bench/JsonMetrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+    constexpr size_t CATEGORY_COUNT = static_cast<size_t>(HitchDetector::Category::Count);
+
+    const char* const CATEGORY_NAMES[CATEGORY_COUNT] = {
+        "TextureLoad", "QueueWaitIdle", "FenceWait", "PipelineCompile", "DescriptorAllocation", "SwapChainRecreate"
+    };
+
+    struct Operation {
+        HitchDetector::Category category = HitchDetector::Category::Count;
+        const char* name = nullptr;
+        char detail[HitchDetector::DETAIL_LENGTH] = {};
+        int64_t startNs = 0;
+        int64_t durationNs = 0;
+    };
+
+    struct Report {
+        uint64_t frameIndex = 0;
+        double frameMs = 0.0;
+        int64_t frameStartNs = 0;
+        uint32_t operationCount = 0;
+        uint32_t droppedOperations = 0;
+        Operation operations[HitchDetector::MAX_OPERATIONS_PER_FRAME];
+    };
+
+    std::atomic<bool> detectionEnabled{ false };
+
+    // Operations are rare (a handful per frame), so one uncontended lock is cheaper than
+    // making every field atomic the way the profiler rings are
+    std::mutex detectorMutex;
+    double budget = 0.0;
+    Report currentFrame;                    // Being collected
+    uint64_t frameCounter = 0;
+    std::unique_ptr<Report[]> reports;
+    uint32_t reportCapacity = 0;
+    uint64_t hitchCount = 0;                // Total; the ring keeps the newest reportCapacity
+
+    double ToMilliseconds(int64_t ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    // Per-category totals of one report
+    void Summarize(const Report& report, uint32_t (&counts)[CATEGORY_COUNT], double (&milliseconds)[CATEGORY_COUNT]) {
+        std::fill(std::begin(counts), std::end(counts), 0u);
+        std::fill(std::begin(milliseconds), std::end(milliseconds), 0.0);
+        for (uint32_t i = 0; i < report.operationCount; ++i) {
+            const size_t category = static_cast<size_t>(report.operations[i].category);
+            ++counts[category];
+            milliseconds[category] += ToMilliseconds(report.operations[i].durationNs);
+        }
+    }
+
+    // Newest first; caller holds detectorMutex
+    template <typename Visitor>
+    void ForEachReport(uint32_t maxReports, Visitor&& visit) {
+        const uint64_t stored = std::min<uint64_t>(hitchCount, reportCapacity);
+        for (uint64_t i = 0; i < std::min<uint64_t>(stored, maxReports); ++i) {
+            visit(reports[(hitchCount - 1 - i) % reportCapacity]);
+        }
+    }
+}
+
+namespace HitchDetector {
+    const char* GetCategoryName(Category category) {
+        const size_t index = static_cast<size_t>(category);
+        return index < CATEGORY_COUNT ? CATEGORY_NAMES[index] : "Unknown";
+    }
+
+    void Configure(double budgetMs, uint32_t reportCount) {
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        budget = budgetMs;
+        reportCapacity = std::max(1u, reportCount);
+        reports = std::make_unique<Report[]>(reportCapacity);
+        hitchCount = 0;
+        currentFrame.operationCount = 0;
+        currentFrame.droppedOperations = 0;
+        detectionEnabled.store(budgetMs > 0.0, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled() {
+        return detectionEnabled.load(std::memory_order_relaxed);
+    }
+
+    double GetBudgetMs() {
+        return budget;
+    }
+
+    void BeginFrame() {
+        if (!IsEnabled()) return;
+
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        currentFrame.frameIndex = frameCounter++;
+        currentFrame.frameStartNs = CpuProfiler::Now();
+        currentFrame.operationCount = 0;
+        currentFrame.droppedOperations = 0;
+    }
+
+    bool EndFrame(double frameMs) {
+        if (!IsEnabled() || frameMs <= budget) return false;
+
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        currentFrame.frameMs = frameMs;
+        reports[hitchCount % reportCapacity] = currentFrame;
+        ++hitchCount;
+        return true;
+    }
+
+    void RecordOperation(Category category, const char* name, const char* detail, int64_t startNs, int64_t endNs) {
+        if (!IsEnabled()) return;
+
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        if (currentFrame.operationCount >= MAX_OPERATIONS_PER_FRAME) {
+            ++currentFrame.droppedOperations;
+            return;
+        }
+
+        Operation& operation = currentFrame.operations[currentFrame.operationCount++];
+        operation.category = category;
+        operation.name = name;
+        operation.detail[0] = '\0';
+        if (detail) {
+            std::strncpy(operation.detail, detail, DETAIL_LENGTH - 1);
+            operation.detail[DETAIL_LENGTH - 1] = '\0';
+        }
+        operation.startNs = startNs;
+        operation.durationNs = endNs - startNs;
+    }
+
+    uint64_t GetHitchCount() {
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        return hitchCount;
+    }
+
+    void PrintReports(uint32_t maxReports) {
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        if (hitchCount == 0) {
+            std::cout << "Hitches: none over " << budget << " ms" << std::endl;
+            return;
+        }
+
+        std::cout << "Hitches: " << hitchCount << " frames over " << budget << " ms, newest first" << std::endl;
+        ForEachReport(maxReports, [](const Report& report) {
+            uint32_t counts[CATEGORY_COUNT];
+            double milliseconds[CATEGORY_COUNT];
+            Summarize(report, counts, milliseconds);
+
+            std::cout << "  frame " << report.frameIndex << ": " << std::fixed << std::setprecision(2) << report.frameMs << " ms";
+            for (size_t c = 0; c < CATEGORY_COUNT; ++c) {
+                if (counts[c]) std::cout << ", " << CATEGORY_NAMES[c] << " x" << counts[c] << " " << milliseconds[c] << " ms";
+            }
+            if (report.operationCount == 0) std::cout << ", no instrumented operations";
+            std::cout << std::endl;
+
+            // The single slowest operation usually names the culprit
+            const Operation* slowest = nullptr;
+            for (uint32_t i = 0; i < report.operationCount; ++i) {
+                if (!slowest || report.operations[i].durationNs > slowest->durationNs) slowest = &report.operations[i];
+            }
+            if (slowest) {
+                std::cout << "    slowest: " << slowest->name << (slowest->detail[0] ? " " : "") << slowest->detail << " "
+                    << ToMilliseconds(slowest->durationNs) << " ms" << std::endl;
+            }
+            std::cout << std::defaultfloat;
+            });
+    }
+
+    bool WriteReports(const std::string& path) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Warning: could not write hitch reports to " << path << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        file << "{\"budgetMs\":" << budget << ",\"hitchCount\":" << hitchCount << ",\"hitches\":[";
+        bool first = true;
+        ForEachReport(reportCapacity, [&file, &first](const Report& report) {
+            uint32_t counts[CATEGORY_COUNT];
+            double milliseconds[CATEGORY_COUNT];
+            Summarize(report, counts, milliseconds);
+
+            file << (first ? "\n" : ",\n") << "{\"frame\":" << report.frameIndex << ",\"frameMs\":" << report.frameMs
+                << ",\"droppedOperations\":" << report.droppedOperations << ",\"categories\":{";
+            bool firstCategory = true;
+            for (size_t c = 0; c < CATEGORY_COUNT; ++c) {
+                if (!counts[c]) continue;
+                file << (firstCategory ? "" : ",") << "\"" << CATEGORY_NAMES[c] << "\":{\"count\":" << counts[c] << ",\"ms\":" << milliseconds[c] << "}";
+                firstCategory = false;
+            }
+            file << "},\"operations\":[";
+            for (uint32_t i = 0; i < report.operationCount; ++i) {
+                const Operation& operation = report.operations[i];
+                file << (i ? "," : "") << "{\"category\":\"" << GetCategoryName(operation.category) << "\",\"name\":\"";
+                JsonMetrics::WriteEscaped(file, operation.name);
+                file << "\",\"detail\":\"";
+                JsonMetrics::WriteEscaped(file, operation.detail);
+                file << "\",\"startMs\":" << ToMilliseconds(operation.startNs - report.frameStartNs)
+                    << ",\"ms\":" << ToMilliseconds(operation.durationNs) << "}";
+            }
+            file << "]}";
+            first = false;
+            });
+        file << "\n]}\n";
+
+        std::cout << "Wrote " << std::min<uint64_t>(hitchCount, reportCapacity) << " hitch reports to " << path << std::endl;
+        return true;
+    }
+}
+
+HitchScope::HitchScope(HitchDetector::Category categoryArg, const char* nameArg, const char* detailArg)
+    : category(categoryArg), name(nameArg), detail(detailArg), start(HitchDetector::IsEnabled() ? CpuProfiler::Now() : -1) {
+}
+
+HitchScope::~HitchScope() {
+    if (start >= 0) {
+        HitchDetector::RecordOperation(category, name, detail, start, CpuProfiler::Now());
+    }
+}
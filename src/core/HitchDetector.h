@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Flags frames over a time budget and says what slow operations ran in them. Known stall points
+// (synchronous texture loads, single-time command waits, fence waits, pipeline compiles,
+// descriptor allocations, swap chain rebuilds) are wrapped in HitchScope; each frame collects
+// those into a fixed array without allocating, and a frame over budget is copied
+// into a ring of the last N reports, which can be printed or written as JSON on demand.
+// While disabled a scope costs one relaxed atomic load, like ProfileScope.
+namespace HitchDetector {
+    enum class Category : uint8_t {
+        TextureLoad,
+        QueueWaitIdle,
+        FenceWait,
+        PipelineCompile,
+        DescriptorAllocation,
+        SwapChainRecreate,
+        Count
+    };
+
+    const char* GetCategoryName(Category category);
+
+    // budgetMs <= 0 disables detection. reportCount sizes the ring (allocated here, not per frame).
+    void Configure(double budgetMs, uint32_t reportCount);
+    bool IsEnabled();
+    double GetBudgetMs();
+
+    // Main thread, around each frame. EndFrame returns true when the frame was a hitch.
+    void BeginFrame();
+    bool EndFrame(double frameMs);
+
+    // From any thread. name must outlive the program (a string literal); detail is copied, truncated.
+    void RecordOperation(Category category, const char* name, const char* detail, int64_t startNs, int64_t endNs);
+
+    uint64_t GetHitchCount();
+
+    // Newest first
+    void PrintReports(uint32_t maxReports);
+    bool WriteReports(const std::string& path);
+
+    constexpr uint32_t MAX_OPERATIONS_PER_FRAME = 64;
+    constexpr size_t DETAIL_LENGTH = 48;
+    constexpr uint32_t DEFAULT_REPORT_COUNT = 32;
+}
+
+// Times the enclosing block as an operation of the given category
+class HitchScope final {
+public:
+    HitchScope(HitchDetector::Category categoryArg, const char* nameArg, const char* detailArg = nullptr);
+    ~HitchScope();
+
+    // Non-copyable
+    HitchScope(const HitchScope&) = delete;
+    HitchScope& operator=(const HitchScope&) = delete;
+
+private:
+    HitchDetector::Category category;
+    const char* name;
+    const char* detail;
+    int64_t start; // -1 when detection was off at construction
+};
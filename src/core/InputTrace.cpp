@@ -0,0 +1,114 @@
+#include "InputTrace.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    template <typename T>
+    void WriteValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    // Field by field rather than the struct, so padding never reaches the file
+    void WriteVec3(std::ofstream& file, const glm::vec3& value) {
+        WriteValue(file, value.x);
+        WriteValue(file, value.y);
+        WriteValue(file, value.z);
+    }
+
+    bool ReadVec3(std::ifstream& file, glm::vec3& value) {
+        return ReadValue(file, value.x) && ReadValue(file, value.y) && ReadValue(file, value.z);
+    }
+}
+
+InputTrace::~InputTrace() {
+    try {
+        StopRecording();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void InputTrace::StartRecording(const std::string& path, uint32_t seedArg) {
+    recordFile.open(path, std::ios::binary | std::ios::trunc);
+    if (!recordFile.is_open()) {
+        throw std::runtime_error("failed to open input trace " + path + " for writing!");
+    }
+
+    seed = seedArg;
+    recordedFrames = 0;
+    WriteValue(recordFile, MAGIC);
+    WriteValue(recordFile, VERSION);
+    WriteValue(recordFile, seed);
+    WriteValue(recordFile, recordedFrames);
+}
+
+void InputTrace::RecordFrame(const Frame& frame) {
+    if (!recordFile.is_open()) return;
+
+    WriteValue(recordFile, frame.deltaTime);
+    WriteValue(recordFile, frame.keys);
+    WriteValue(recordFile, frame.cameraType);
+    WriteVec3(recordFile, frame.position);
+    WriteVec3(recordFile, frame.front);
+    WriteValue(recordFile, frame.dayNightSpeed);
+    ++recordedFrames;
+}
+
+void InputTrace::StopRecording() {
+    if (!recordFile.is_open()) return;
+
+    recordFile.seekp(FRAME_COUNT_OFFSET);
+    WriteValue(recordFile, recordedFrames);
+    recordFile.close();
+    std::cout << "Input trace: recorded " << recordedFrames << " frames" << std::endl;
+}
+
+void InputTrace::LoadReplay(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open input trace " + path + "!");
+    }
+
+    uint32_t magic = 0, version = 0, frameCount = 0;
+    if (!ReadValue(file, magic) || !ReadValue(file, version) || !ReadValue(file, seed) || !ReadValue(file, frameCount)
+        || magic != MAGIC || version != VERSION) {
+        throw std::runtime_error("failed to read input trace " + path + ": not a version " + std::to_string(VERSION) + " trace!");
+    }
+
+    replayFrames.clear();
+    replayFrames.reserve(std::min<uint32_t>(frameCount, MAX_RESERVED_FRAMES)); // The count is untrusted until read
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        Frame frame;
+        if (!ReadValue(file, frame.deltaTime) || !ReadValue(file, frame.keys) || !ReadValue(file, frame.cameraType)
+            || !ReadVec3(file, frame.position) || !ReadVec3(file, frame.front) || !ReadValue(file, frame.dayNightSpeed)) {
+            std::cerr << "Warning: input trace " << path << " ends after " << i << " of " << frameCount << " frames" << std::endl;
+            break;
+        }
+        replayFrames.push_back(frame);
+    }
+
+    if (replayFrames.empty()) {
+        throw std::runtime_error("failed to read input trace " + path + ": no frames!");
+    }
+
+    replayIndex = 0;
+    maxDrift = 0.0f;
+    std::cout << "Input trace: replaying " << replayFrames.size() << " frames from " << path << std::endl;
+}
+
+const InputTrace::Frame* InputTrace::NextReplayFrame() {
+    if (replayIndex >= replayFrames.size()) return nullptr;
+    return &replayFrames[replayIndex++];
+}
+
+void InputTrace::ReportDrift(const glm::vec3& position) {
+    if (replayIndex == 0 || replayIndex > replayFrames.size()) return;
+    maxDrift = glm::max(maxDrift, glm::length(position - replayFrames[replayIndex - 1].position));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Per-frame input, camera and timing captured to a compact binary file, so the same camera motion
+// can be replayed in later runs (and in the headless benchmark). Replay feeds the recorded key
+// state back through CameraController::Update; the recorded camera transform is only used to
+// measure how far the replay drifted from the original.
+//
+// Layout (little-endian): header { "ORBT", version, seed, frame count }, then one fixed-size
+// record per frame. The frame count is patched in when recording stops.
+class InputTrace final {
+public:
+    struct Frame {
+        float deltaTime = 0.0f;
+        uint16_t keys = 0;              // CameraController::InputBits
+        uint8_t cameraType = 0;         // CameraType
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
+        float dayNightSpeed = 0.0f;
+    };
+
+    InputTrace() = default;
+    ~InputTrace();
+
+    // Non-copyable
+    InputTrace(const InputTrace&) = delete;
+    InputTrace& operator=(const InputTrace&) = delete;
+
+    // Recording streams frames straight to disk, so a long capture doesn't grow a buffer mid-frame
+    void StartRecording(const std::string& path, uint32_t seedArg);
+    void RecordFrame(const Frame& frame);
+    void StopRecording();
+    bool IsRecording() const { return recordFile.is_open(); }
+
+    void LoadReplay(const std::string& path);
+    // Next recorded frame, or nullptr once the trace is exhausted
+    const Frame* NextReplayFrame();
+    bool IsReplaying() const { return !replayFrames.empty(); }
+    bool IsReplayFinished() const { return replayIndex >= replayFrames.size(); }
+    size_t GetReplayFrameCount() const { return replayFrames.size(); }
+
+    // Seed the trace was recorded with; replaying with it reproduces placement and particles
+    uint32_t GetSeed() const { return seed; }
+
+    // Distance between the replayed camera and the recorded one, tracked as the worst seen
+    void ReportDrift(const glm::vec3& position);
+    float GetMaxDrift() const { return maxDrift; }
+
+    static constexpr uint32_t MAGIC = 0x5442524f; // "ORBT"
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    std::ofstream recordFile;
+    uint32_t recordedFrames = 0;
+
+    std::vector<Frame> replayFrames;
+    size_t replayIndex = 0;
+    float maxDrift = 0.0f;
+
+    uint32_t seed = 0;
+
+    static constexpr std::streamoff FRAME_COUNT_OFFSET = 12;
+    static constexpr uint32_t MAX_RESERVED_FRAMES = 1u << 20;
+};
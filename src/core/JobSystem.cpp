@@ -0,0 +1,334 @@
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    // Identifies which of a job system's threads the caller is
+    thread_local const JobSystem* tlsOwner = nullptr;
+    thread_local uint32_t tlsThreadIndex = 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCountArg)
+    : workerCount(workerCountArg) {
+    if (workerCount == 0) {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 0;
+    }
+}
+
+JobSystem::~JobSystem() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void JobSystem::Initialize() {
+    if (running.load()) return;
+
+    mainThreadId = std::this_thread::get_id();
+    tlsOwner = this;
+    tlsThreadIndex = 0;
+
+    queues.clear();
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    running.store(true);
+    workers.reserve(workerCount);
+    for (uint32_t i = 1; i <= workerCount; ++i) {
+        workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+void JobSystem::Cleanup() {
+    if (!running.exchange(false)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+    queues.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mainThreadQueue.mutex);
+        mainThreadQueue.jobs.Clear();
+    }
+    queuedJobs.store(0);
+
+    if (tlsOwner == this) tlsOwner = nullptr;
+}
+
+void JobSystem::Schedule(JobFunction function, JobCounter* counter, const char* name) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    Enqueue(Job{ std::move(function), counter, name });
+}
+
+void JobSystem::ScheduleAfter(JobCounter& dependency, JobFunction function, JobCounter* counter, const char* name) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    Job job{ std::move(function), counter, name };
+
+    {
+        // Finish decrements under the same lock, so the job is either parked here
+        // before the drain or sees the drained count and runs now
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) > 0) {
+            dependency.continuations.push_back(std::move(job));
+            return;
+        }
+    }
+
+    Enqueue(std::move(job));
+}
+
+void JobSystem::ScheduleOnMainThread(JobFunction function, JobCounter* counter, const char* name) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mainThreadQueue.mutex);
+    mainThreadQueue.jobs.PushBack(Job{ std::move(function), counter, name });
+}
+
+void JobSystem::RunMainThreadJobs() {
+    if (!IsMainThread()) return;
+
+    // Only what is queued now: jobs scheduled by these run on the next call
+    size_t remaining = 0;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadQueue.mutex);
+        remaining = mainThreadQueue.jobs.Size();
+    }
+
+    for (; remaining > 0; --remaining) {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(mainThreadQueue.mutex);
+            if (mainThreadQueue.jobs.Empty()) break;
+            job = mainThreadQueue.jobs.PopFront();
+        }
+        Execute(job, 0);
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    const uint32_t threadIndex = GetCurrentThreadIndex();
+
+    while (!counter.IsDone()) {
+        if (threadIndex == 0) {
+            RunMainThreadJobs();
+        }
+        // Outside threads only wait: jobs may rely on running on a job thread (per-thread pools)
+        if (threadIndex == NOT_A_JOB_THREAD || !TryExecuteOne(threadIndex)) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(counter.mutex);
+        error = counter.error;
+        counter.error = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function, const char* name) {
+    if (count == 0) return;
+
+    const size_t grain = std::max<size_t>(grainSize, 1);
+    const size_t chunkCount = (count + grain - 1) / grain;
+
+    // Not worth a round trip through the queues
+    if (chunkCount == 1 || workerCount == 0 || !running.load()) {
+        const auto start = std::chrono::steady_clock::now();
+        function(0, count);
+        if (timingCallback) {
+            timingCallback(name, GetCurrentThreadIndex(), start, std::chrono::steady_clock::now());
+        }
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const size_t begin = chunk * grain;
+        const size_t end = std::min(begin + grain, count);
+        Schedule([&function, begin, end]() { function(begin, end); }, &counter, name);
+    }
+    Wait(counter);
+}
+
+void JobSystem::WorkerLoop(uint32_t threadIndex) {
+    tlsOwner = this;
+    tlsThreadIndex = threadIndex;
+
+    char threadName[32];
+    std::snprintf(threadName, sizeof(threadName), "Worker %u", threadIndex);
+    CpuProfiler::SetThreadName(threadName);
+
+    while (running.load(std::memory_order_acquire)) {
+        if (TryExecuteOne(threadIndex)) continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() {
+            return !running.load(std::memory_order_acquire) || queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+void JobSystem::Enqueue(Job job) {
+    if (!running.load(std::memory_order_acquire)) {
+        // No workers: run inline so the caller's counters still drain
+        Execute(job, GetCurrentThreadIndex());
+        return;
+    }
+
+    // Job threads push to their own deque, anyone else spreads over all of them
+    uint32_t target = GetCurrentThreadIndex();
+    if (target == NOT_A_JOB_THREAD) {
+        target = nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(queues.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->jobs.PushBack(std::move(job));
+    }
+    queuedJobs.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this notify after a worker's predicate check
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+bool JobSystem::TryExecuteOne(uint32_t threadIndex) {
+    Job job;
+    if (!TryPop(threadIndex, job) && !TrySteal(threadIndex, job)) {
+        return false;
+    }
+
+    queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    Execute(job, threadIndex);
+    return true;
+}
+
+bool JobSystem::TryPop(uint32_t threadIndex, Job& job) {
+    if (threadIndex >= queues.size()) return false;
+
+    WorkQueue& queue = *queues[threadIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.Empty()) return false;
+
+    job = queue.jobs.PopBack();
+    return true;
+}
+
+bool JobSystem::TrySteal(uint32_t threadIndex, Job& job) {
+    const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+    const uint32_t first = (threadIndex == NOT_A_JOB_THREAD) ? 0 : threadIndex + 1;
+
+    for (uint32_t i = 0; i < queueCount; ++i) {
+        const uint32_t victim = (first + i) % queueCount;
+        if (victim == threadIndex) continue;
+
+        WorkQueue& queue = *queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.Empty()) continue;
+
+        // Oldest job first: usually the biggest remaining piece of work
+        job = queue.jobs.PopFront();
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::Execute(Job& job, uint32_t threadIndex) {
+    const auto start = std::chrono::steady_clock::now();
+    AllocationScope allocationScope(job.name); // Jobs run outside their caller's scope
+
+    try {
+        job.function();
+    }
+    catch (...) {
+        if (job.counter) {
+            std::lock_guard<std::mutex> lock(job.counter->mutex);
+            if (!job.counter->error) job.counter->error = std::current_exception();
+        }
+        else {
+            std::cerr << "Warning: job '" << job.name << "' threw an exception with nobody waiting on it" << std::endl;
+        }
+    }
+
+    if (timingCallback) {
+        timingCallback(job.name, threadIndex, start, std::chrono::steady_clock::now());
+    }
+
+    if (job.counter) {
+        Finish(*job.counter);
+    }
+}
+
+void JobSystem::Finish(JobCounter& counter) {
+    std::vector<Job> ready;
+    {
+        // Held across the decrement so ScheduleAfter cannot park a job after the drain
+        std::lock_guard<std::mutex> lock(counter.mutex);
+        if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        ready.swap(counter.continuations);
+    }
+
+    for (auto& job : ready) {
+        Enqueue(std::move(job));
+    }
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const {
+    return (tlsOwner == this) ? tlsThreadIndex : NOT_A_JOB_THREAD;
+}
+
+void JobSystem::JobRing::PushBack(Job job) {
+    if (count == slots.size()) {
+        // Full: unroll into a larger buffer with the oldest job at index 0
+        std::vector<Job> grown(std::max<size_t>(slots.size() * 2, 16));
+        for (size_t i = 0; i < count; ++i) {
+            grown[i] = std::move(slots[(head + i) % slots.size()]);
+        }
+        slots.swap(grown);
+        head = 0;
+    }
+
+    slots[(head + count) % slots.size()] = std::move(job);
+    ++count;
+}
+
+Job JobSystem::JobRing::PopBack() {
+    --count;
+    return std::move(slots[(head + count) % slots.size()]);
+}
+
+Job JobSystem::JobRing::PopFront() {
+    Job job = std::move(slots[head]);
+    head = (head + 1) % slots.size();
+    --count;
+    return job;
+}
+
+void JobSystem::JobRing::Clear() {
+    for (auto& slot : slots) {
+        slot = Job{};
+    }
+    head = 0;
+    count = 0;
+}
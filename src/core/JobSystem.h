@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+using JobFunction = std::function<void()>;
+
+struct Job {
+    JobFunction function;
+    JobCounter* counter = nullptr; // Decremented when the job finishes (may be null)
+    const char* name = "Job";
+};
+
+// Tracks a group of jobs. Schedule increments it, job completion decrements it, and
+// JobSystem::Wait blocks until it reaches zero. Jobs scheduled with ScheduleAfter on a
+// counter start once it drains. A counter must outlive every job that references it.
+class JobCounter final {
+public:
+    JobCounter() = default;
+    ~JobCounter() = default;
+
+    // Non-copyable
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> pending{ 0 };
+    std::mutex mutex;                 // Guards continuations and error
+    std::vector<Job> continuations;   // Jobs waiting for this counter to drain
+    std::exception_ptr error;         // First exception thrown by a job, rethrown by Wait
+};
+
+// Work-stealing job system. Every thread owns a deque: the owner pushes and pops at the
+// back (LIFO, cache friendly) and idle threads steal from the front of the others.
+// The main thread is thread 0 and helps execute jobs while it waits on a counter.
+// Jobs scheduled with ScheduleOnMainThread never leave the main thread.
+class JobSystem final {
+public:
+    using TimingCallback = std::function<void(const char* name, uint32_t threadIndex,
+        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)>;
+
+    // workerCountArg: background threads besides the main thread. 0 = hardware threads - 1.
+    explicit JobSystem(uint32_t workerCountArg = 0);
+    ~JobSystem();
+
+    // Non-copyable
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Must be called from the thread that becomes the main thread
+    void Initialize();
+    // Joins the workers. Jobs still queued are discarded.
+    void Cleanup();
+
+    void Schedule(JobFunction function, JobCounter* counter = nullptr, const char* name = "Job");
+    // Starts the job once dependency has drained
+    void ScheduleAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr, const char* name = "Job");
+    // Main-thread affinity (e.g. GLFW calls). Run during Wait or RunMainThreadJobs on the main thread.
+    void ScheduleOnMainThread(JobFunction function, JobCounter* counter = nullptr, const char* name = "Job");
+    void RunMainThreadJobs();
+
+    // Executes other jobs until counter reaches zero, then rethrows the first job exception if any.
+    // Threads the system doesn't own just wait.
+    void Wait(JobCounter& counter);
+
+    // Calls function(begin, end) over [0, count) in chunks of at most grainSize and waits for all of them
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function, const char* name = "ParallelFor");
+
+    // Receives the wall time of every job, from whichever thread ran it. Set while no jobs are in flight.
+    void SetTimingCallback(TimingCallback callback) { timingCallback = std::move(callback); }
+
+    uint32_t GetWorkerCount() const { return workerCount; }
+    uint32_t GetThreadCount() const { return workerCount + 1; }
+    bool IsMainThread() const { return std::this_thread::get_id() == mainThreadId; }
+
+    // 0 = main thread, 1..N = workers, NOT_A_JOB_THREAD for threads this system doesn't own
+    uint32_t GetCurrentThreadIndex() const;
+
+    static constexpr uint32_t NOT_A_JOB_THREAD = UINT32_MAX;
+
+private:
+    // Growable ring buffer of jobs. Unlike std::deque it stops allocating once it has
+    // reached its high-water mark, so steady-state scheduling stays off the heap.
+    class JobRing {
+    public:
+        bool Empty() const { return count == 0; }
+        size_t Size() const { return count; }
+        void PushBack(Job job);
+        Job PopBack();
+        Job PopFront();
+        void Clear();
+
+    private:
+        std::vector<Job> slots;
+        size_t head = 0;
+        size_t count = 0;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        JobRing jobs;
+    };
+
+    uint32_t workerCount;
+    std::atomic<bool> running{ false };
+    std::thread::id mainThreadId;
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // Index 0 = main thread, 1..N = workers
+    WorkQueue mainThreadQueue;
+
+    // Idle workers sleep here until something is queued
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<uint32_t> queuedJobs{ 0 };
+    std::atomic<uint32_t> nextQueue{ 0 };
+
+    TimingCallback timingCallback;
+
+    void WorkerLoop(uint32_t threadIndex);
+    void Enqueue(Job job);
+    bool TryExecuteOne(uint32_t threadIndex);
+    bool TryPop(uint32_t threadIndex, Job& job);
+    bool TrySteal(uint32_t threadIndex, Job& job);
+    void Execute(Job& job, uint32_t threadIndex);
+    void Finish(JobCounter& counter);
+};
+
+// ParallelFor that runs inline when no job system is available
+inline void ParallelFor(JobSystem* jobSystem, size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function, const char* name = "ParallelFor") {
+    if (jobSystem) {
+        jobSystem->ParallelFor(count, grainSize, function, name);
+    }
+    else if (count > 0) {
+        function(0, count);
+    }
+}
@@ -0,0 +1,135 @@
+#include "StressScene.h"
+#include "../geometry/GeometryGenerator.h"
+#include "../rendering/Scene.h"
+#include "../rendering/Texture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+    struct ObjectTemplate {
+        const char* modelPath;
+        const char* texturePath;
+        float frequency;
+        glm::vec3 minScale;
+        glm::vec3 maxScale;
+        glm::vec3 baseRotation;
+    };
+
+    // The default scene's mix: frequent small cacti, dead trees in two sizes
+    const ObjectTemplate OBJECT_TEMPLATES[] = {
+        { "models/cactus.obj",   "textures/cactus.jpg", 7.0f, glm::vec3(0.01f), glm::vec3(0.02f), glm::vec3(-90.0f, 0.0f, 0.0f) },
+        { "models/DeadTree.obj", "textures/bark.jpg",   5.0f, glm::vec3(0.1f),  glm::vec3(0.2f),  glm::vec3(0.0f) },
+        { "models/DeadTree.obj", "textures/bark.jpg",   4.0f, glm::vec3(0.25f), glm::vec3(0.35f), glm::vec3(0.0f) },
+    };
+    constexpr size_t OBJECT_TEMPLATE_COUNT = sizeof(OBJECT_TEMPLATES) / sizeof(OBJECT_TEMPLATES[0]);
+
+    // Keeps generated lights and emitters apart from the ones the default scene places
+    constexpr uint32_t LIGHT_SEED_SALT = 0x4c494748u;
+    constexpr uint32_t EMITTER_SEED_SALT = 0x454d4954u;
+
+    // Far past anything a frame can hold; larger values are typos, and strtoul would wrap or truncate them
+    constexpr unsigned long MAX_COUNT = 1000000;
+    // Rings * segments vertices must still index with 32 bits
+    constexpr uint32_t MAX_TERRAIN_RESOLUTION = 8192;
+}
+
+bool StressScene::Parse(const std::string& text, Config& config) {
+    Config parsed = config;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const size_t equals = item.find('=');
+        if (equals == std::string::npos) return false;
+
+        const std::string key = item.substr(0, equals);
+        const char* const value = item.c_str() + equals + 1;
+        // strtoul skips whitespace and takes a sign, negating "-1" into a huge count: digits only
+        if (*value < '0' || *value > '9') return false;
+        char* end = nullptr;
+        const unsigned long number = std::strtoul(value, &end, 10);
+        if (*end != '\0' || number > MAX_COUNT) return false;
+
+        const uint32_t count = static_cast<uint32_t>(number);
+        if (key == "objects") parsed.objects = count;
+        else if (key == "lights") parsed.lights = count;
+        else if (key == "emitters") parsed.emitters = count;
+        else if (key == "terrain") parsed.terrainResolution = count;
+        else if (key == "textures") parsed.textures = count;
+        else return false;
+    }
+
+    if (parsed.terrainResolution < 2 || parsed.terrainResolution > MAX_TERRAIN_RESOLUTION) return false;
+    config = parsed;
+    return true;
+}
+
+std::string StressScene::ToString(const Config& config) {
+    return "objects=" + std::to_string(config.objects) + ",lights=" + std::to_string(config.lights)
+        + ",emitters=" + std::to_string(config.emitters) + ",terrain=" + std::to_string(config.terrainResolution)
+        + ",textures=" + std::to_string(config.textures);
+}
+
+void StressScene::RegisterObjects(Scene& scene, const Config& config) {
+    if (config.textures == 0) {
+        for (const ObjectTemplate& entry : OBJECT_TEMPLATES) {
+            scene.RegisterProceduralObject(entry.modelPath, entry.texturePath, entry.frequency, entry.minScale, entry.maxScale, entry.baseRotation);
+        }
+        return;
+    }
+
+    // One registry entry per texture, cycling the templates, so placement picks textures evenly
+    for (uint32_t i = 0; i < config.textures; ++i) {
+        const ObjectTemplate& entry = OBJECT_TEMPLATES[i % OBJECT_TEMPLATE_COUNT];
+        scene.RegisterProceduralObject(entry.modelPath, Texture::GENERATED_PREFIX + std::to_string(i), 1.0f,
+            entry.minScale, entry.maxScale, entry.baseRotation);
+    }
+}
+
+void StressScene::AddLights(Scene& scene, const Config& config, uint32_t seed, float terrainRadius, float deltaY) {
+    const uint32_t existing = static_cast<uint32_t>(scene.GetLights().size());
+    if (config.lights <= existing) return;
+
+    const uint32_t requested = config.lights - existing;
+    const uint32_t room = existing < MAX_LIGHTS ? MAX_LIGHTS - existing : 0;
+    const uint32_t added = std::min(requested, room);
+    if (added < requested) {
+        std::cerr << "Warning: stress scene asks for " << config.lights << " lights, only " << MAX_LIGHTS
+            << " fit in the uniform buffer; " << requested - added << " not added" << std::endl;
+    }
+
+    std::mt19937 rng(seed ^ LIGHT_SEED_SALT);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const glm::vec3 center(0.0f, deltaY, 0.0f);
+
+    for (uint32_t i = 0; i < added; ++i) {
+        const std::string name = "StressLight_" + std::to_string(i);
+        const float radius = glm::mix(20.0f, terrainRadius * 0.9f, unit(rng));
+        const float height = glm::mix(10.0f, 40.0f, unit(rng));
+        const glm::vec3 color = glm::mix(glm::vec3(0.2f), glm::vec3(1.0f), glm::vec3(unit(rng), unit(rng), unit(rng)));
+
+        scene.AddLight(name, center, color, 2.0f, 0);
+        scene.SetLightOrbit(name, center + glm::vec3(0.0f, height, 0.0f), radius, glm::mix(0.05f, 0.3f, unit(rng)),
+            glm::vec3(0.0f, 1.0f, 0.0f), unit(rng) * glm::two_pi<float>());
+    }
+}
+
+void StressScene::AddEmitters(Scene& scene, const Config& config, uint32_t seed, float terrainRadius, float deltaY, float heightScale, float noiseFreq) {
+    std::mt19937 rng(seed ^ EMITTER_SEED_SALT);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for (uint32_t i = 0; i < config.emitters; ++i) {
+        // Uniform over the disc, like procedural placement
+        const float r = std::sqrt(unit(rng)) * terrainRadius * 0.9f;
+        const float theta = unit(rng) * glm::two_pi<float>();
+        const float x = r * std::cos(theta);
+        const float z = r * std::sin(theta);
+        const float y = deltaY + GeometryGenerator::GetTerrainHeight(x, z, terrainRadius, heightScale, noiseFreq) + 0.5f;
+
+        scene.AddFire(glm::vec3(x, y, z), 1.0f, i % 2 == 0);
+    }
+}
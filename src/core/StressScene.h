@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Scene;
+
+// Generated content for scaling tests. Application::SetupScene keeps the orb, pedestal, sun and
+// moon and takes everything that scales from a Config instead: procedural object count, extra
+// lights, fire emitters, terrain resolution and the number of distinct object textures. Running
+// the headless benchmark once per value of one axis gives frame time and memory against that axis.
+class StressScene final {
+public:
+    struct Config {
+        uint32_t objects = 50;
+        uint32_t lights = 3;               // Total, including the sun, moon and pedestal light; capped at MAX_LIGHTS
+        uint32_t emitters = 2;             // Fire emitters scattered over the terrain, every other one smoking
+        uint32_t terrainResolution = 512;  // Terrain rings and segments
+        uint32_t textures = 0;             // Distinct generated object textures, 0 = the models' own textures
+    };
+
+    // "objects=2000,lights=64,emitters=16,terrain=1024,textures=32". Keys left out keep their
+    // defaults; returns false on an unknown key, a malformed value (anything but decimal digits)
+    // or a count too large to be meant.
+    static bool Parse(const std::string& text, Config& config);
+    static std::string ToString(const Config& config);
+
+    // Fills the procedural registry; the caller then runs Scene::GenerateProceduralObjects(config.objects, ...)
+    static void RegisterObjects(Scene& scene, const Config& config);
+
+    // Orbiting point lights inside the orb until the scene holds config.lights. Lights past
+    // MAX_LIGHTS are counted and reported once rather than passed to Scene::AddLight.
+    static void AddLights(Scene& scene, const Config& config, uint32_t seed, float terrainRadius, float deltaY);
+
+    static void AddEmitters(Scene& scene, const Config& config, uint32_t seed, float terrainRadius, float deltaY, float heightScale, float noiseFreq);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer. The producer fills the write
+// slot and publishes it; the consumer swaps in the newest published slot whenever it wants.
+// Neither side ever waits: the producer always has a free slot and the consumer keeps reading
+// its current slot until it asks for a newer one. Slots are reused, so T's allocations are too.
+template <typename T>
+class TripleBuffer final {
+public:
+    TripleBuffer() = default;
+    ~TripleBuffer() = default;
+
+    // Non-copyable
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // --- Producer ---
+    T& GetWriteBuffer() { return slots[writeIndex]; }
+
+    // Hands the write slot to the consumer and takes the spare one in exchange
+    void Publish() {
+        writeIndex = shared.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // True while the last published slot hasn't been picked up
+    bool HasUnreadPublish() const { return (shared.load(std::memory_order_acquire) & FRESH_BIT) != 0; }
+
+    // --- Consumer ---
+    // Swaps in the newest published slot. Returns false (and keeps the current slot) if nothing new.
+    bool AcquireLatest() {
+        if (!HasUnreadPublish()) return false;
+        readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& GetReadBuffer() const { return slots[readIndex]; }
+
+private:
+    static constexpr uint32_t INDEX_MASK = 0x3;
+    static constexpr uint32_t FRESH_BIT = 0x4;
+
+    std::array<T, 3> slots{};
+    uint32_t writeIndex = 0;                // Owned by the producer
+    uint32_t readIndex = 1;                 // Owned by the consumer
+    std::atomic<uint32_t> shared{ 2 };      // Spare slot index, plus FRESH_BIT once published
+};
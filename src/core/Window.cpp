@@ -65,4 +65,10 @@ void Window::Cleanup() {
         window = nullptr;
     }
     glfwTerminate();
-}
\ No newline at end of file
+}
+
+void Window::SetOverlayText(const std::string& text) const {
+    if (!window) return;
+    const std::string fullTitle = text.empty() ? title : title + "  |  " + text;
+    glfwSetWindowTitle(window, fullTitle.c_str());
+}
@@ -22,6 +22,9 @@ public:
     void PollEvents() const { glfwPollEvents(); }
     GLFWwindow* GetGLFWWindow() const { return window; }
 
+    // Shows text after the title (empty restores the plain title). Used as a lightweight stats overlay.
+    void SetOverlayText(const std::string& text) const;
+
     // Setting the framebuffer callback does not modify observable state in this class
     void SetFramebufferResizeCallback(GLFWframebuffersizefun callback) const { glfwSetFramebufferSizeCallback(window, callback); }
 
@@ -1,15 +1,14 @@
 #include "Geometry.h"
 #include <stdexcept>
 
-Geometry::Geometry(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg)
-    : device(deviceArg), physicalDevice(physicalDeviceArg) {
-}
-
-void Geometry::CreateBuffers() {
+void Geometry::CreateBuffers(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg) {
     if (vertices.empty()) {
         throw std::runtime_error("No vertices to create buffer from!");
     }
 
+    device = deviceArg;
+    physicalDevice = physicalDeviceArg;
+
     // Create vertex buffer
     vertexBuffer = std::make_unique<VulkanBuffer>(device, physicalDevice);
     const VkDeviceSize vertexBufferSize = sizeof(vertices[0]) * vertices.size();
@@ -7,9 +7,11 @@
 #include <cstddef>
 #include <utility>
 
+// Vertex and index data, plus the GPU buffers once CreateBuffers uploads it. Building a mesh
+// needs no device, so generators and loaders can run (and be benchmarked) without Vulkan.
 class Geometry final {
 public:
-    Geometry(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg);
+    Geometry() = default;
     ~Geometry() = default;
 
     // Non-copyable: class owns Vulkan resources
@@ -20,7 +22,7 @@ public:
     Geometry(Geometry&&) noexcept = default;
     Geometry& operator=(Geometry&&) noexcept = default;
 
-    void CreateBuffers();
+    void CreateBuffers(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg);
     void Bind(VkCommandBuffer commandBuffer) const;
     void Draw(VkCommandBuffer commandBuffer) const;
     void Cleanup();
@@ -55,8 +57,8 @@ private:
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
 
-    VkDevice device;
-    VkPhysicalDevice physicalDevice;
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 
     // Vulkan buffer members (vertex first for locality)
     std::unique_ptr<VulkanBuffer> vertexBuffer;
@@ -8,50 +8,50 @@ constexpr double PI = 3.14159265358979323846;
 namespace {
     // Helper to set normal (unused in this specific refactor but kept if needed)
     void SetNormal(Vertex& v, const glm::vec3& n) { v.normal = n; }
+}
 
-    // [NEW] Helper to compute smooth normals by averaging face normals
-    // This replaces the duplicated logic in CreatePedestal and CreateTerrain
-    void ComputeSmoothNormals(Geometry* geometry) {
-        // 1. Reset normals
-        for (size_t i = 0; i < geometry->VertexCount(); ++i) {
-            geometry->GetVertex(i).normal = glm::vec3(0.0f);
-        }
+float SmoothStep(float edge0, float edge1, float x) {
+    const float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
 
-        // 2. Accumulate face normals
-        for (size_t i = 0; i < geometry->IndexCount(); i += 3) {
-            const uint32_t i0 = geometry->GetIndex(i);
-            const uint32_t i1 = geometry->GetIndex(i + 1);
-            const uint32_t i2 = geometry->GetIndex(i + 2);
+// [NEW] Helper to compute smooth normals by averaging face normals
+// This replaces the duplicated logic in CreatePedestal and CreateTerrain
+void GeometryGenerator::ComputeSmoothNormals(Geometry* geometry) {
+    // 1. Reset normals
+    for (size_t i = 0; i < geometry->VertexCount(); ++i) {
+        geometry->GetVertex(i).normal = glm::vec3(0.0f);
+    }
 
-            const glm::vec3 v0 = geometry->GetVertex(i0).pos;
-            const glm::vec3 v1 = geometry->GetVertex(i1).pos;
-            const glm::vec3 v2 = geometry->GetVertex(i2).pos;
+    // 2. Accumulate face normals
+    for (size_t i = 0; i < geometry->IndexCount(); i += 3) {
+        const uint32_t i0 = geometry->GetIndex(i);
+        const uint32_t i1 = geometry->GetIndex(i + 1);
+        const uint32_t i2 = geometry->GetIndex(i + 2);
 
-            const glm::vec3 edge1 = v1 - v0;
-            const glm::vec3 edge2 = v2 - v0;
-            const glm::vec3 normal = glm::cross(edge1, edge2);
+        const glm::vec3 v0 = geometry->GetVertex(i0).pos;
+        const glm::vec3 v1 = geometry->GetVertex(i1).pos;
+        const glm::vec3 v2 = geometry->GetVertex(i2).pos;
 
-            geometry->GetVertex(i0).normal += normal;
-            geometry->GetVertex(i1).normal += normal;
-            geometry->GetVertex(i2).normal += normal;
-        }
+        const glm::vec3 edge1 = v1 - v0;
+        const glm::vec3 edge2 = v2 - v0;
+        const glm::vec3 normal = glm::cross(edge1, edge2);
 
-        // 3. Normalize
-        for (size_t i = 0; i < geometry->VertexCount(); ++i) {
-            auto& n = geometry->GetVertex(i).normal;
-            if (glm::length(n) > 0.00001f) {
-                n = glm::normalize(n);
-            }
-            else {
-                n = glm::vec3(0.0f, 1.0f, 0.0f);
-            }
-        }
+        geometry->GetVertex(i0).normal += normal;
+        geometry->GetVertex(i1).normal += normal;
+        geometry->GetVertex(i2).normal += normal;
     }
-}
 
-float SmoothStep(float edge0, float edge1, float x) {
-    const float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
-    return t * t * (3.0f - 2.0f * t);
+    // 3. Normalize
+    for (size_t i = 0; i < geometry->VertexCount(); ++i) {
+        auto& n = geometry->GetVertex(i).normal;
+        if (glm::length(n) > 0.00001f) {
+            n = glm::normalize(n);
+        }
+        else {
+            n = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
 }
 
 void GeometryGenerator::GenerateGridIndices(Geometry* geometry, int slices, int stacks) {
@@ -97,8 +97,8 @@ float GeometryGenerator::GetTerrainHeight(float x, float z, float radius, float
     return y;
 }
 
-std::unique_ptr<Geometry> GeometryGenerator::CreateBowl(VkDevice device, VkPhysicalDevice physicalDevice, float radius, int slices, int stacks) {
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+std::unique_ptr<Geometry> GeometryGenerator::BuildBowl(float radius, int slices, int stacks) {
+    auto geometry = std::make_unique<Geometry>();
 
     geometry->ReserveVertices((slices + 1) * (stacks + 1));
     geometry->ReserveIndices(slices * stacks * 6);
@@ -127,14 +127,12 @@ std::unique_ptr<Geometry> GeometryGenerator::CreateBowl(VkDevice device, VkPhysi
     }
 
     GenerateGridIndices(geometry.get(), slices, stacks);
-    geometry->CreateBuffers();
     return geometry;
 }
 
-std::unique_ptr<Geometry> GeometryGenerator::CreatePedestal(VkDevice device, VkPhysicalDevice physicalDevice,
-    float topRadius, float baseWidth, float height, int slices, int stacks) {
+std::unique_ptr<Geometry> GeometryGenerator::BuildPedestal(float topRadius, float baseWidth, float height, int slices, int stacks) {
 
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+    auto geometry = std::make_unique<Geometry>();
     geometry->ReserveVertices((slices + 1) * (stacks + 1));
     geometry->ReserveIndices(slices * stacks * 6);
 
@@ -185,14 +183,12 @@ std::unique_ptr<Geometry> GeometryGenerator::CreatePedestal(VkDevice device, VkP
     // Replaced duplicated normal calculation with helper
     ComputeSmoothNormals(geometry.get());
 
-    geometry->CreateBuffers();
     return geometry;
 }
 
-std::unique_ptr<Geometry> GeometryGenerator::CreateTerrain(VkDevice device, VkPhysicalDevice physicalDevice,
-    float radius, int rings, int segments, float heightScale, float noiseFreq) {
+std::unique_ptr<Geometry> GeometryGenerator::BuildTerrain(float radius, int rings, int segments, float heightScale, float noiseFreq) {
 
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+    auto geometry = std::make_unique<Geometry>();
     geometry->ReserveVertices((rings + 1) * (segments + 1));
     geometry->ReserveIndices(rings * segments * 6);
 
@@ -253,12 +249,11 @@ std::unique_ptr<Geometry> GeometryGenerator::CreateTerrain(VkDevice device, VkPh
     // Replaced duplicated normal calculation with helper
     ComputeSmoothNormals(geometry.get());
 
-    geometry->CreateBuffers();
     return geometry;
 }
 
-std::unique_ptr<Geometry> GeometryGenerator::CreateCube(VkDevice device, VkPhysicalDevice physicalDevice) {
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+std::unique_ptr<Geometry> GeometryGenerator::BuildCube() {
+    auto geometry = std::make_unique<Geometry>();
     geometry->ReserveVertices(24);
     geometry->ReserveIndices(36);
 
@@ -302,12 +297,11 @@ std::unique_ptr<Geometry> GeometryGenerator::CreateCube(VkDevice device, VkPhysi
         20, 21, 22, 22, 23, 20  // Left
         });
 
-    geometry->CreateBuffers();
     return geometry;
 }
 
-std::unique_ptr<Geometry> GeometryGenerator::CreateGrid(VkDevice device, VkPhysicalDevice physicalDevice, int rows, int cols, float cellSize) {
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+std::unique_ptr<Geometry> GeometryGenerator::BuildGrid(int rows, int cols, float cellSize) {
+    auto geometry = std::make_unique<Geometry>();
     const float width = cols * cellSize;
     const float height = rows * cellSize;
     const float startX = -width / 2.0f;
@@ -339,14 +333,13 @@ std::unique_ptr<Geometry> GeometryGenerator::CreateGrid(VkDevice device, VkPhysi
             geometry->AddIndex(bottomRight);
         }
     }
-    geometry->CreateBuffers();
     return geometry;
 }
 
-std::unique_ptr<Geometry> GeometryGenerator::CreateSphere(VkDevice device, VkPhysicalDevice physicalDevice, int stacks, int slices, float radius) {
+std::unique_ptr<Geometry> GeometryGenerator::BuildSphere(int stacks, int slices, float radius) {
     if (stacks < 2) stacks = 2;
     if (slices < 3) slices = 3;
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+    auto geometry = std::make_unique<Geometry>();
 
     geometry->ReserveVertices((stacks + 1) * (slices + 1));
     geometry->ReserveIndices(stacks * slices * 6);
@@ -371,7 +364,37 @@ std::unique_ptr<Geometry> GeometryGenerator::CreateSphere(VkDevice device, VkPhy
     }
 
     GenerateGridIndices(geometry.get(), slices, stacks);
-    geometry->CreateBuffers();
+    return geometry;
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::CreateCube(VkDevice device, VkPhysicalDevice physicalDevice) {
+    return Upload(BuildCube(), device, physicalDevice);
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::CreateGrid(VkDevice device, VkPhysicalDevice physicalDevice, int rows, int cols, float cellSize) {
+    return Upload(BuildGrid(rows, cols, cellSize), device, physicalDevice);
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::CreateSphere(VkDevice device, VkPhysicalDevice physicalDevice, int stacks, int slices, float radius) {
+    return Upload(BuildSphere(stacks, slices, radius), device, physicalDevice);
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::CreateTerrain(VkDevice device, VkPhysicalDevice physicalDevice,
+    float radius, int rings, int segments, float heightScale, float noiseFreq) {
+    return Upload(BuildTerrain(radius, rings, segments, heightScale, noiseFreq), device, physicalDevice);
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::CreateBowl(VkDevice device, VkPhysicalDevice physicalDevice, float radius, int slices, int stacks) {
+    return Upload(BuildBowl(radius, slices, stacks), device, physicalDevice);
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::CreatePedestal(VkDevice device, VkPhysicalDevice physicalDevice,
+    float topRadius, float baseWidth, float height, int slices, int stacks) {
+    return Upload(BuildPedestal(topRadius, baseWidth, height, slices, stacks), device, physicalDevice);
+}
+
+std::unique_ptr<Geometry> GeometryGenerator::Upload(std::unique_ptr<Geometry> geometry, VkDevice device, VkPhysicalDevice physicalDevice) {
+    geometry->CreateBuffers(device, physicalDevice);
     return geometry;
 }
 
@@ -15,6 +15,7 @@ public:
     GeometryGenerator(GeometryGenerator&&) = delete;
     GeometryGenerator& operator=(GeometryGenerator&&) = delete;
 
+    // Create* build the mesh and upload it; Build* only build it, without touching a device
     static std::unique_ptr<Geometry> CreateCube(VkDevice device, VkPhysicalDevice physicalDevice);
     static std::unique_ptr<Geometry> CreateGrid(VkDevice device, VkPhysicalDevice physicalDevice,
         int rows, int cols, float cellSize = 0.1f);
@@ -31,7 +32,18 @@ public:
     static std::unique_ptr<Geometry> CreatePedestal(VkDevice device, VkPhysicalDevice physicalDevice,
         float topRadius, float baseWidth, float height, int slices, int stacks);
 
+    static std::unique_ptr<Geometry> BuildCube();
+    static std::unique_ptr<Geometry> BuildGrid(int rows, int cols, float cellSize = 0.1f);
+    static std::unique_ptr<Geometry> BuildSphere(int stacks = 16, int slices = 32, float radius = 0.5f);
+    static std::unique_ptr<Geometry> BuildTerrain(float radius, int rings, int segments, float heightScale, float noiseFreq);
+    static std::unique_ptr<Geometry> BuildBowl(float radius, int slices, int stacks);
+    static std::unique_ptr<Geometry> BuildPedestal(float topRadius, float baseWidth, float height, int slices, int stacks);
+
+    // Replaces every vertex normal with the area-weighted average of the faces around it
+    static void ComputeSmoothNormals(Geometry* geometry);
+
 private:
     static glm::vec3 GenerateColor(int index, int total);
     static void GenerateGridIndices(Geometry* geometry, int slices, int stacks);
+    static std::unique_ptr<Geometry> Upload(std::unique_ptr<Geometry> geometry, VkDevice device, VkPhysicalDevice physicalDevice);
 };
\ No newline at end of file
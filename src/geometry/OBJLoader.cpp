@@ -1,4 +1,5 @@
 #include "OBJLoader.h"
+#include "../core/CpuProfiler.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -32,6 +33,13 @@ namespace {
 } // namespace
 
 std::unique_ptr<Geometry> OBJLoader::Load(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filepath) {
+    ProfileScope profileScope("OBJLoader::Load");
+    auto geometry = Parse(filepath);
+    geometry->CreateBuffers(device, physicalDevice);
+    return geometry;
+}
+
+std::unique_ptr<Geometry> OBJLoader::Parse(const std::string& filepath) {
     std::ifstream file(filepath);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open OBJ file: " + filepath);
@@ -45,7 +53,7 @@ std::unique_ptr<Geometry> OBJLoader::Load(VkDevice device, VkPhysicalDevice phys
     // Deduplication map: Key -> Index in the final geometry vertex array
     std::unordered_map<VertexKey, uint32_t, VertexKeyHash> uniqueVertices;
 
-    auto geometry = std::make_unique<Geometry>(device, physicalDevice);
+    auto geometry = std::make_unique<Geometry>();
 
     std::string line;
     while (std::getline(file, line)) {
@@ -151,6 +159,5 @@ std::unique_ptr<Geometry> OBJLoader::Load(VkDevice device, VkPhysicalDevice phys
         throw std::runtime_error("OBJ file contained no vertices or failed to parse: " + filepath);
     }
 
-    geometry->CreateBuffers();
     return geometry;
 }
\ No newline at end of file
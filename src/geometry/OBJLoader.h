@@ -17,4 +17,6 @@ public:
     OBJLoader& operator=(OBJLoader&&) = delete;
 
     static std::unique_ptr<Geometry> Load(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filepath);
+    // Load without the upload: parses the file into a Geometry with no GPU buffers
+    static std::unique_ptr<Geometry> Parse(const std::string& filepath);
 };
\ No newline at end of file
@@ -2,11 +2,120 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --workers N sets the job system's worker thread count (default: spare hardware threads)
+    // --threaded-sim simulates on its own thread, one frame ahead of rendering
+    // --track-allocations prints heap allocation reports; --assert-no-allocations fails if a steady-state frame allocates
+    //   (and hides the --gpu-profile/--render-stats overlay, which allocates to format its text)
+    // --gpu-profile times every render pass on the GPU and dumps gpu_profile.csv/.json on exit
+    // --render-stats shows per-pass draw, bind and culling counters in the window title
+    // --cpu-profile records CPU markers from startup and writes cpu_trace.json on exit
+    // --hitch-budget MS reports frames slower than MS with the stalls that ran in them (F12 or exit writes hitches.json);
+    //   --hitch-reports N keeps the newest N (default 32)
+    // --sim-rate HZ sets the fixed simulation rate (default 60, 0 = step once per rendered frame)
+    // --seed N makes procedural placement and particle emission repeatable
+    // --benchmark N renders N measured frames headless along a scripted camera path and exits;
+    //   --benchmark-size WxH (default 1280x720) and --benchmark-output FILE (default benchmark.json)
+    // --stress-scene objects=N,lights=M,emitters=P,terrain=R,textures=T replaces the scaling content of the
+    //   default scene (50, 3, 2, 512, 0); lights past MAX_LIGHTS are reported and dropped
+    // --record-trace FILE records held keys, camera and frame times every frame to a binary trace
+    // --replay-trace FILE drives the camera from a trace (also replaces the benchmark's camera path);
+    //   --replay-original-timing uses the recorded frame times instead of a fixed 60 Hz step
+    // --pipeline-cache FILE sets the pipeline cache file (default pipeline_cache.bin);
+    //   --no-pipeline-cache keeps it in memory only, so every launch is a cold start
+    // --refraction-scale F renders the crystal ball's refraction at F of the screen resolution (0.25 to 1);
+    //   --refraction-interval N re-renders it every N frames and reprojects it in between (default 1)
+    // --no-portal-stencil draws the orb's interior over the whole screen from outside, instead of through the ball's stencil
+    ApplicationOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            options.workerThreads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--threaded-sim") == 0) {
+            options.threadedSimulation = true;
+        }
+        else if (std::strcmp(argv[i], "--track-allocations") == 0) {
+            options.trackAllocations = true;
+        }
+        else if (std::strcmp(argv[i], "--assert-no-allocations") == 0) {
+            options.trackAllocations = true;
+            options.assertNoAllocations = true;
+        }
+        else if (std::strcmp(argv[i], "--gpu-profile") == 0) {
+            options.gpuProfiling = true;
+        }
+        else if (std::strcmp(argv[i], "--render-stats") == 0) {
+            options.renderStats = true;
+        }
+        else if (std::strcmp(argv[i], "--cpu-profile") == 0) {
+            options.cpuProfiling = true;
+        }
+        else if (std::strcmp(argv[i], "--hitch-budget") == 0 && i + 1 < argc) {
+            options.hitchBudgetMs = std::max(0.0, std::strtod(argv[++i], nullptr));
+        }
+        else if (std::strcmp(argv[i], "--hitch-reports") == 0 && i + 1 < argc) {
+            options.hitchReports = static_cast<uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+        }
+        else if (std::strcmp(argv[i], "--sim-rate") == 0 && i + 1 < argc) {
+            options.simulationRate = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.randomSeed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            options.benchmarkFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--benchmark-size") == 0 && i + 1 < argc) {
+            unsigned int width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0) {
+                options.benchmarkWidth = width;
+                options.benchmarkHeight = height;
+            }
+        }
+        else if (std::strcmp(argv[i], "--benchmark-output") == 0 && i + 1 < argc) {
+            options.benchmarkOutput = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--record-trace") == 0 && i + 1 < argc) {
+            options.recordTracePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay-trace") == 0 && i + 1 < argc) {
+            options.replayTracePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay-original-timing") == 0) {
+            options.replayOriginalTiming = true;
+        }
+        else if (std::strcmp(argv[i], "--pipeline-cache") == 0 && i + 1 < argc) {
+            options.pipelineCachePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--no-pipeline-cache") == 0) {
+            options.pipelineCachePath.clear();
+        }
+        else if (std::strcmp(argv[i], "--refraction-scale") == 0 && i + 1 < argc) {
+            options.refractionScale = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--refraction-interval") == 0 && i + 1 < argc) {
+            options.refractionInterval = static_cast<uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+        }
+        else if (std::strcmp(argv[i], "--no-portal-stencil") == 0) {
+            options.portalStencil = false;
+        }
+        else if (std::strcmp(argv[i], "--stress-scene") == 0 && i + 1 < argc) {
+            StressScene::Config config;
+            if (StressScene::Parse(argv[++i], config)) {
+                options.stressScene = config;
+            }
+            else {
+                std::cerr << "Warning: ignoring malformed --stress-scene " << argv[i] << std::endl;
+            }
+        }
+    }
 
     try {
-        Application app;
+        Application app(options);
         app.Run();
     }
     catch (const std::exception& e) {
@@ -132,4 +132,44 @@ void CameraController::OnKeyPress(int key, bool pressed) {
     if (key == GLFW_KEY_LEFT_SHIFT || key == GLFW_KEY_RIGHT_SHIFT) {
         keyShift = pressed;
     }
-}
\ No newline at end of file
+}
+
+uint16_t CameraController::GetInputState() const {
+    uint16_t state = 0;
+    if (keyW) state |= INPUT_W;
+    if (keyA) state |= INPUT_A;
+    if (keyS) state |= INPUT_S;
+    if (keyD) state |= INPUT_D;
+    if (keyQ) state |= INPUT_Q;
+    if (keyE) state |= INPUT_E;
+    if (keyI) state |= INPUT_I;
+    if (keyJ) state |= INPUT_J;
+    if (keyK) state |= INPUT_K;
+    if (keyL) state |= INPUT_L;
+    if (keyUp) state |= INPUT_UP;
+    if (keyDown) state |= INPUT_DOWN;
+    if (keyLeft) state |= INPUT_LEFT;
+    if (keyRight) state |= INPUT_RIGHT;
+    if (keyCtrl) state |= INPUT_CTRL;
+    if (keyShift) state |= INPUT_SHIFT;
+    return state;
+}
+
+void CameraController::SetInputState(uint16_t state) {
+    keyW = (state & INPUT_W) != 0;
+    keyA = (state & INPUT_A) != 0;
+    keyS = (state & INPUT_S) != 0;
+    keyD = (state & INPUT_D) != 0;
+    keyQ = (state & INPUT_Q) != 0;
+    keyE = (state & INPUT_E) != 0;
+    keyI = (state & INPUT_I) != 0;
+    keyJ = (state & INPUT_J) != 0;
+    keyK = (state & INPUT_K) != 0;
+    keyL = (state & INPUT_L) != 0;
+    keyUp = (state & INPUT_UP) != 0;
+    keyDown = (state & INPUT_DOWN) != 0;
+    keyLeft = (state & INPUT_LEFT) != 0;
+    keyRight = (state & INPUT_RIGHT) != 0;
+    keyCtrl = (state & INPUT_CTRL) != 0;
+    keyShift = (state & INPUT_SHIFT) != 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Camera.h"
+#include <cstdint>
 #include <memory>
 #include <map>
 
@@ -29,6 +30,17 @@ public:
     void OnKeyPress(int key, bool pressed);
     inline void OnKeyRelease(int key) { OnKeyPress(key, false); }
 
+    // Held keys as a bit mask, for recording and replaying input traces
+    enum InputBits : uint16_t {
+        INPUT_W = 1 << 0, INPUT_A = 1 << 1, INPUT_S = 1 << 2, INPUT_D = 1 << 3,
+        INPUT_Q = 1 << 4, INPUT_E = 1 << 5,
+        INPUT_I = 1 << 6, INPUT_J = 1 << 7, INPUT_K = 1 << 8, INPUT_L = 1 << 9,
+        INPUT_UP = 1 << 10, INPUT_DOWN = 1 << 11, INPUT_LEFT = 1 << 12, INPUT_RIGHT = 1 << 13,
+        INPUT_CTRL = 1 << 14, INPUT_SHIFT = 1 << 15
+    };
+    uint16_t GetInputState() const;
+    void SetInputState(uint16_t state);
+
 private:
     std::map<CameraType, std::unique_ptr<Camera>> cameras;
     Camera* activeCamera = nullptr;
@@ -4,12 +4,18 @@
 #include <stdexcept>
 #include <iostream>
 #include <stb_image.h>
+#include "../core/AllocationTracker.h"
+#include "../core/CpuProfiler.h"
+#include "../core/HitchDetector.h"
 
 Cubemap::Cubemap(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPoolArg, VkQueue graphicsQueueArg)
     : device(deviceArg), physicalDevice(physicalDeviceArg), commandPool(commandPoolArg), graphicsQueue(graphicsQueueArg) {
 }
 
 void Cubemap::LoadFromFiles(const std::vector<std::string>& paths) {
+    AllocationScope allocationScope("TextureLoading");
+    ProfileScope profileScope("Cubemap::LoadFromFiles");
+    HitchScope hitchScope(HitchDetector::Category::TextureLoad, "Cubemap::LoadFromFiles");
     if (paths.size() != 6) throw std::runtime_error("Cubemap requires 6 image paths");
 
     int texWidth, texHeight, texChannels;
@@ -126,7 +132,10 @@ void Cubemap::CreateDescriptorSet() {
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &descriptorSetLayout;
 
-    vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+    {
+        HitchScope hitchScope(HitchDetector::Category::DescriptorAllocation, "vkAllocateDescriptorSets", "cubemap");
+        vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+    }
 
     VkDescriptorImageInfo imageInfo{};
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
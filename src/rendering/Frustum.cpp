@@ -0,0 +1,32 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    // Gribb/Hartmann plane extraction. Uses the -w..w depth range, which is a superset of
+    // Vulkan's 0..w, so the near plane test stays conservative either way.
+    const glm::mat4& m = viewProjection;
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0; // Left
+    planes[1] = row3 - row0; // Right
+    planes[2] = row3 + row1; // Bottom
+    planes[3] = row3 - row1; // Top
+    planes[4] = row3 + row2; // Near
+    planes[5] = row3 - row2; // Far
+
+    for (auto& plane : planes) {
+        const float len = glm::length(glm::vec3(plane));
+        if (len > 1e-6f) plane /= len;
+    }
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+    for (const auto& plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+
+// View frustum as six inward-facing planes, extracted from a view-projection matrix.
+// A default-constructed frustum accepts everything.
+class Frustum final {
+public:
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+private:
+    std::array<glm::vec4, 6> planes{};
+};
@@ -0,0 +1,366 @@
+#include "GpuProfiler.h"
+#include "../bench/JsonMetrics.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+GpuProfiler::GpuProfiler(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, uint32_t framesInFlightArg)
+    : device(deviceArg), physicalDevice(physicalDeviceArg), framesInFlight(framesInFlightArg) {
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        slots.push_back(std::make_unique<FrameSlot>());
+        slots.back()->records.resize(MAX_SCOPES_PER_FRAME);
+    }
+
+    queryResults.resize(static_cast<size_t>(MAX_SCOPES_PER_FRAME) * 2 * 2);
+    resolvedScopes.reserve(MAX_SCOPES_PER_FRAME);
+    resolvedDraws.reserve(MAX_SCOPES_PER_FRAME);
+    history.resize(HISTORY_FRAMES);
+}
+
+GpuProfiler::~GpuProfiler() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void GpuProfiler::Initialize(uint32_t queueFamilyIndex) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+    uint32_t validBits = 0;
+    if (queueFamilyIndex < familyCount) {
+        validBits = families[queueFamilyIndex].timestampValidBits;
+    }
+    if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f) {
+        std::cerr << "Warning: graphics queue does not support timestamps, GPU profiling disabled" << std::endl;
+        return;
+    }
+
+    nanosecondsPerTick = static_cast<double>(properties.limits.timestampPeriod);
+    timestampMask = (validBits >= 64) ? UINT64_MAX : ((uint64_t{ 1 } << validBits) - 1);
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = FirstQuery(framesInFlight);
+
+    if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+}
+
+void GpuProfiler::Cleanup() {
+    if (queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+    }
+
+    // Their queries went with the pool
+    for (auto& slot : slots) {
+        slot->recorded = false;
+    }
+    frameActive = false;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer cmd, uint32_t frame) {
+    currentSlot = frame;
+    FrameSlot& slot = *slots[frame];
+
+    if (slot.recorded) {
+        Resolve(frame);
+        slot.recorded = false;
+    }
+
+    slot.scopeCount.store(0, std::memory_order_relaxed);
+    frameActive = enabled && queryPool != VK_NULL_HANDLE;
+    if (!frameActive) return;
+
+    vkCmdResetQueryPool(cmd, queryPool, FirstQuery(frame), MAX_SCOPES_PER_FRAME * 2);
+    slot.recorded = true;
+    slot.frameIndex = frameCounter++;
+    slot.cpuSubmitNs = -1;
+    slot.frameScope = BeginScope(cmd, "Frame");
+}
+
+void GpuProfiler::EndFrame(VkCommandBuffer cmd) {
+    if (!frameActive) return;
+    EndScope(cmd, slots[currentSlot]->frameScope);
+}
+
+void GpuProfiler::MarkSubmit() {
+    if (!frameActive) return;
+    slots[currentSlot]->cpuSubmitNs = CpuProfiler::Now();
+}
+
+uint32_t GpuProfiler::BeginScope(VkCommandBuffer cmd, const char* name) {
+    if (!frameActive) return INVALID_SCOPE;
+
+    FrameSlot& slot = *slots[currentSlot];
+    const uint32_t scope = slot.scopeCount.fetch_add(1, std::memory_order_relaxed);
+    if (scope >= MAX_SCOPES_PER_FRAME) return INVALID_SCOPE;
+
+    slot.records[scope] = ScopeRecord{ name, nullptr };
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, FirstQuery(currentSlot) + scope * 2);
+    return scope;
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer cmd, uint32_t scope) {
+    if (!frameActive || scope == INVALID_SCOPE) return;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, FirstQuery(currentSlot) + scope * 2 + 1);
+}
+
+uint32_t GpuProfiler::BeginDraw(VkCommandBuffer cmd, const std::string* objectName) {
+    if (!drawAttribution) return INVALID_SCOPE;
+
+    const uint32_t scope = BeginScope(cmd, nullptr);
+    if (scope != INVALID_SCOPE) {
+        slots[currentSlot]->records[scope].objectName = objectName;
+    }
+    return scope;
+}
+
+void GpuProfiler::Resolve(uint32_t slotIndex) {
+    FrameSlot& slot = *slots[slotIndex];
+    const uint32_t scopeCount = std::min(slot.scopeCount.load(std::memory_order_relaxed), MAX_SCOPES_PER_FRAME);
+    if (scopeCount == 0) return;
+
+    // Never waits: the slot's fence has signalled, and anything still unavailable is skipped
+    const VkResult result = vkGetQueryPoolResults(device, queryPool, FirstQuery(slotIndex), scopeCount * 2,
+        queryResults.size() * sizeof(uint64_t), queryResults.data(), sizeof(uint64_t) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+    resolvedScopes.clear();
+    resolvedDraws.clear();
+    for (uint32_t i = 0; i < scopeCount; ++i) {
+        const uint64_t* begin = &queryResults[static_cast<size_t>(i) * 4];
+        if (begin[1] == 0 || begin[3] == 0) continue;
+
+        const ResolvedScope scope{ &slot.records[i], begin[0] & timestampMask, begin[2] & timestampMask };
+        if (scope.end < scope.begin) continue;
+        (scope.record->objectName ? resolvedDraws : resolvedScopes).push_back(scope);
+    }
+
+    FrameTimings& frame = history[historyHead];
+    frame.frameIndex = slot.frameIndex;
+    frame.frameMilliseconds = 0.0;
+    frame.beginTicks = 0;
+    frame.cpuSubmitNs = slot.cpuSubmitNs;
+    frame.scopes.clear();
+    frame.draws.clear();
+    outputBegin.clear();
+    outputEnd.clear();
+    openScopes.clear();
+    openOutputs.clear();
+
+    // Rebuild the hierarchy: a scope is a child of the innermost open scope that encloses it
+    std::sort(resolvedScopes.begin(), resolvedScopes.end(), [](const ResolvedScope& a, const ResolvedScope& b) {
+        return (a.begin != b.begin) ? a.begin < b.begin : a.end > b.end;
+        });
+
+    for (size_t i = 0; i < resolvedScopes.size(); ++i) {
+        const ResolvedScope& scope = resolvedScopes[i];
+        while (!openScopes.empty()) {
+            const ResolvedScope& open = resolvedScopes[openScopes.back()];
+            // Same-named neighbours (draw chunks) overlap on the GPU but are siblings
+            const bool encloses = open.end >= scope.end && open.end > scope.begin
+                && std::strcmp(open.record->name, scope.record->name) != 0;
+            if (encloses) break;
+            openScopes.pop_back();
+            openOutputs.pop_back();
+        }
+
+        const uint32_t depth = static_cast<uint32_t>(openScopes.size());
+        const size_t firstSibling = openOutputs.empty() ? 0 : openOutputs.back() + 1;
+
+        // Merge repeats under the same parent into one span
+        size_t output = frame.scopes.size();
+        for (size_t j = firstSibling; j < frame.scopes.size(); ++j) {
+            if (frame.scopes[j].depth == depth && std::strcmp(frame.scopes[j].name, scope.record->name) == 0) {
+                output = j;
+                break;
+            }
+        }
+
+        if (output == frame.scopes.size()) {
+            frame.scopes.push_back({ scope.record->name, depth, 0.0 });
+            outputBegin.push_back(scope.begin);
+            outputEnd.push_back(scope.end);
+        }
+        else {
+            outputBegin[output] = std::min(outputBegin[output], scope.begin);
+            outputEnd[output] = std::max(outputEnd[output], scope.end);
+        }
+
+        openScopes.push_back(i);
+        openOutputs.push_back(output);
+    }
+
+    if (!frame.scopes.empty()) {
+        // Sorted by start, so the first output is the earliest (normally the Frame scope)
+        frame.beginTicks = outputBegin[0];
+        frame.frameMilliseconds = ToMilliseconds(outputEnd[0] - outputBegin[0]);
+    }
+    for (size_t j = 0; j < frame.scopes.size(); ++j) {
+        frame.scopes[j].milliseconds = ToMilliseconds(outputEnd[j] - outputBegin[j]);
+        frame.scopes[j].startMilliseconds = ToMilliseconds(outputBegin[j] - frame.beginTicks);
+    }
+
+    // Per-object cost, summed over passes
+    std::sort(resolvedDraws.begin(), resolvedDraws.end(), [](const ResolvedScope& a, const ResolvedScope& b) {
+        return a.record->objectName < b.record->objectName;
+        });
+    for (const auto& draw : resolvedDraws) {
+        const double milliseconds = ToMilliseconds(draw.end - draw.begin);
+        if (!frame.draws.empty() && frame.draws.back().objectName == draw.record->objectName) {
+            frame.draws.back().milliseconds += milliseconds;
+        }
+        else {
+            frame.draws.push_back({ draw.record->objectName, milliseconds });
+        }
+    }
+    std::sort(frame.draws.begin(), frame.draws.end(), [](const DrawTiming& a, const DrawTiming& b) {
+        return a.milliseconds > b.milliseconds;
+        });
+
+    historyHead = (historyHead + 1) % HISTORY_FRAMES;
+    historyCount = std::min(historyCount + 1, HISTORY_FRAMES);
+}
+
+const GpuProfiler::FrameTimings& GpuProfiler::GetHistoryFrame(size_t age) const {
+    return history[(historyHead + HISTORY_FRAMES - 1 - age) % HISTORY_FRAMES];
+}
+
+void GpuProfiler::AppendTraceEvents(std::vector<CpuProfiler::TraceEvent>& events) const {
+    bool haveOffset = false;
+    int64_t offsetNs = 0;
+    for (size_t age = 0; age < historyCount; ++age) {
+        const FrameTimings& frame = GetHistoryFrame(age);
+        if (frame.cpuSubmitNs < 0) continue;
+
+        const int64_t candidate = frame.cpuSubmitNs - static_cast<int64_t>(static_cast<double>(frame.beginTicks) * nanosecondsPerTick);
+        if (!haveOffset || candidate > offsetNs) offsetNs = candidate;
+        haveOffset = true;
+    }
+    if (!haveOffset) return;
+
+    for (size_t age = historyCount; age-- > 0;) {
+        const FrameTimings& frame = GetHistoryFrame(age);
+        const int64_t frameStartNs = static_cast<int64_t>(static_cast<double>(frame.beginTicks) * nanosecondsPerTick) + offsetNs;
+        for (const auto& scope : frame.scopes) {
+            events.push_back({ scope.name, frameStartNs + static_cast<int64_t>(scope.startMilliseconds * 1e6), static_cast<int64_t>(scope.milliseconds * 1e6) });
+        }
+    }
+}
+
+void GpuProfiler::GetTopDraws(size_t count, std::vector<DrawTiming>& topDraws) const {
+    topDraws.clear();
+    if (historyCount == 0) return;
+
+    std::unordered_map<const std::string*, double> totals;
+    for (size_t age = 0; age < historyCount; ++age) {
+        for (const auto& draw : GetHistoryFrame(age).draws) {
+            totals[draw.objectName] += draw.milliseconds;
+        }
+    }
+
+    for (const auto& entry : totals) {
+        topDraws.push_back({ entry.first, entry.second / static_cast<double>(historyCount) });
+    }
+    std::sort(topDraws.begin(), topDraws.end(), [](const DrawTiming& a, const DrawTiming& b) {
+        return a.milliseconds > b.milliseconds;
+        });
+    if (topDraws.size() > count) topDraws.resize(count);
+}
+
+std::string GpuProfiler::GetSummary(size_t frameCount) const {
+    const size_t frames = std::min(frameCount, historyCount);
+    if (frames == 0) return "GPU: no data";
+
+    // Per-pass averages, in the order the newest frame ran them
+    std::vector<std::pair<const char*, double>> passes;
+    double frameTotal = 0.0;
+    for (size_t age = 0; age < frames; ++age) {
+        const FrameTimings& frame = GetHistoryFrame(age);
+        frameTotal += frame.frameMilliseconds;
+        for (const auto& scope : frame.scopes) {
+            if (scope.depth != 1) continue;
+            auto it = std::find_if(passes.begin(), passes.end(), [&](const auto& pass) { return std::strcmp(pass.first, scope.name) == 0; });
+            if (it == passes.end()) {
+                passes.emplace_back(scope.name, 0.0);
+                it = passes.end() - 1;
+            }
+            it->second += scope.milliseconds;
+        }
+    }
+
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2) << "GPU " << frameTotal / frames << " ms";
+    for (const auto& pass : passes) {
+        summary << " | " << pass.first << " " << pass.second / frames;
+    }
+    return summary.str();
+}
+
+bool GpuProfiler::WriteCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Warning: could not write GPU profile to " << path << std::endl;
+        return false;
+    }
+
+    file << "frame,type,name,depth,milliseconds\n";
+    for (size_t age = historyCount; age-- > 0;) {
+        const FrameTimings& frame = GetHistoryFrame(age);
+        for (const auto& scope : frame.scopes) {
+            file << frame.frameIndex << ",scope," << scope.name << ',' << scope.depth << ',' << scope.milliseconds << '\n';
+        }
+        for (const auto& draw : frame.draws) {
+            file << frame.frameIndex << ",draw,\"" << *draw.objectName << "\",," << draw.milliseconds << '\n';
+        }
+    }
+    return true;
+}
+
+bool GpuProfiler::WriteJson(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Warning: could not write GPU profile to " << path << std::endl;
+        return false;
+    }
+
+    file << "{\"frames\":[";
+    for (size_t age = historyCount; age-- > 0;) {
+        const FrameTimings& frame = GetHistoryFrame(age);
+        file << "\n{\"frame\":" << frame.frameIndex << ",\"gpuMs\":" << frame.frameMilliseconds << ",\"scopes\":[";
+        for (size_t i = 0; i < frame.scopes.size(); ++i) {
+            const auto& scope = frame.scopes[i];
+            file << (i ? "," : "") << "{\"name\":\"";
+            JsonMetrics::WriteEscaped(file, scope.name);
+            file << "\",\"depth\":" << scope.depth << ",\"ms\":" << scope.milliseconds << "}";
+        }
+        file << "],\"draws\":[";
+        for (size_t i = 0; i < frame.draws.size(); ++i) {
+            const auto& draw = frame.draws[i];
+            file << (i ? "," : "") << "{\"object\":\"";
+            JsonMetrics::WriteEscaped(file, *draw.objectName);
+            file << "\",\"ms\":" << draw.milliseconds << "}";
+        }
+        file << "]}" << (age ? "," : "");
+    }
+    file << "\n]}\n";
+    return true;
+}
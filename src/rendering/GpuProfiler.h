@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "../core/CpuProfiler.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// GPU timing through timestamp queries. Scopes write a timestamp pair into the frame's command
+// buffers and are read back when the same frame slot comes round again: its fence has signalled
+// by then, so the CPU never waits on a query. Nesting is rebuilt from the timestamps themselves,
+// which lets secondary buffers recorded on any thread add scopes without coordinating.
+class GpuProfiler final {
+public:
+    struct ScopeTiming {
+        const char* name = nullptr;
+        uint32_t depth = 0;          // 0 = the whole frame
+        double startMilliseconds = 0.0; // From the start of the frame
+        double milliseconds = 0.0;   // Repeated scopes under one parent (draw chunks) are merged into one span
+    };
+
+    struct DrawTiming {
+        const std::string* objectName = nullptr;
+        double milliseconds = 0.0;   // Summed over every pass that drew the object
+    };
+
+    struct FrameTimings {
+        uint64_t frameIndex = 0;
+        double frameMilliseconds = 0.0;
+        uint64_t beginTicks = 0;          // Raw GPU timestamp of the frame's first command
+        int64_t cpuSubmitNs = -1;         // CpuProfiler clock just before the frame was submitted
+        std::vector<ScopeTiming> scopes;  // Execution order, parents before children
+        std::vector<DrawTiming> draws;    // Most expensive first; only with draw attribution
+    };
+
+    GpuProfiler(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, uint32_t framesInFlightArg);
+    ~GpuProfiler();
+
+    // Non-copyable
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Creates the query pool. Leaves the profiler inert if the queue can't write timestamps.
+    void Initialize(uint32_t queueFamilyIndex);
+    // Destroys the query pool. History and settings survive, so Initialize can follow a resize.
+    void Cleanup();
+
+    void SetEnabled(bool enabledArg) { enabled = enabledArg; }
+    bool IsEnabled() const { return enabled; }
+    bool IsSupported() const { return queryPool != VK_NULL_HANDLE; }
+
+    // Times every draw individually (two queries per draw) to name the most expensive objects
+    void SetDrawAttribution(bool enabledArg) { drawAttribution = enabledArg; }
+    bool IsDrawAttributionEnabled() const { return drawAttribution; }
+
+    // First and last commands of the frame's primary buffer, outside any render pass.
+    // BeginFrame also reads back what this frame slot recorded last time round.
+    void BeginFrame(VkCommandBuffer cmd, uint32_t frame);
+    void EndFrame(VkCommandBuffer cmd);
+    // Call right before submitting the frame: anchors the GPU clock to the CPU profiler's
+    void MarkSubmit();
+
+    // Thread-safe. Returns INVALID_SCOPE when disabled or out of queries; EndScope ignores it.
+    // In a primary buffer, scopes must stay outside render passes that execute secondaries.
+    uint32_t BeginScope(VkCommandBuffer cmd, const char* name);
+    void EndScope(VkCommandBuffer cmd, uint32_t scope);
+    uint32_t BeginDraw(VkCommandBuffer cmd, const std::string* objectName);
+    void EndDraw(VkCommandBuffer cmd, uint32_t scope) { EndScope(cmd, scope); }
+
+    // Rolling history of resolved frames, age 0 = newest
+    size_t GetHistorySize() const { return historyCount; }
+    const FrameTimings& GetHistoryFrame(size_t age) const;
+    double GetNanosecondsPerTick() const { return nanosecondsPerTick; }
+
+    // The history's scopes on the CpuProfiler clock, for a GPU track in CPU traces. The GPU can't
+    // start a frame before it is submitted, so the offset is the tightest such bound over the history.
+    void AppendTraceEvents(std::vector<CpuProfiler::TraceEvent>& events) const;
+
+    // Objects with the highest average GPU time per frame across the history
+    void GetTopDraws(size_t count, std::vector<DrawTiming>& topDraws) const;
+    // Averages of the per-pass scopes over the last frames, for the overlay
+    std::string GetSummary(size_t frameCount = 30) const;
+
+    bool WriteCsv(const std::string& path) const;
+    bool WriteJson(const std::string& path) const;
+
+    static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+private:
+    struct ScopeRecord {
+        const char* name = nullptr;
+        const std::string* objectName = nullptr; // Set for draws
+    };
+
+    struct FrameSlot {
+        std::atomic<uint32_t> scopeCount{ 0 };
+        std::vector<ScopeRecord> records;        // MAX_SCOPES_PER_FRAME, indexed by scope
+        uint32_t frameScope = INVALID_SCOPE;
+        uint64_t frameIndex = 0;
+        int64_t cpuSubmitNs = -1;
+        bool recorded = false;                   // Holds queries that haven't been read back
+    };
+
+    struct ResolvedScope {
+        const ScopeRecord* record;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    uint32_t framesInFlight;
+
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    double nanosecondsPerTick = 1.0;
+    uint64_t timestampMask = UINT64_MAX;
+
+    bool enabled = false;
+    bool drawAttribution = false;
+    bool frameActive = false;     // Whether the frame being recorded writes queries
+    uint32_t currentSlot = 0;
+    uint64_t frameCounter = 0;
+
+    std::vector<std::unique_ptr<FrameSlot>> slots;
+
+    // Resolve scratch, sized once
+    std::vector<uint64_t> queryResults;    // [timestamp, availability] per query
+    std::vector<ResolvedScope> resolvedScopes;
+    std::vector<ResolvedScope> resolvedDraws;
+    std::vector<size_t> openScopes;        // Index into resolvedScopes
+    std::vector<size_t> openOutputs;       // Matching index into the output scopes
+    std::vector<uint64_t> outputBegin;     // Merged span per output scope
+    std::vector<uint64_t> outputEnd;
+
+    std::vector<FrameTimings> history;     // Ring of HISTORY_FRAMES
+    size_t historyHead = 0;
+    size_t historyCount = 0;
+
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 4096;
+    static constexpr size_t HISTORY_FRAMES = 240;
+
+    uint32_t FirstQuery(uint32_t slot) const { return slot * MAX_SCOPES_PER_FRAME * 2; }
+    double ToMilliseconds(uint64_t ticks) const { return static_cast<double>(ticks) * nanosecondsPerTick * 1e-6; }
+    void Resolve(uint32_t slotIndex);
+};
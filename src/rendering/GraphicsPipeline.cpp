@@ -1,7 +1,11 @@
 #include "GraphicsPipeline.h"
 #include "../vulkan/PushConstantObject.h"
+#include "../core/HitchDetector.h"
+#include "../core/CpuProfiler.h"
+#include "../core/JobSystem.h"
 #include <stdexcept>
 #include <array>
+#include <chrono>
 
 GraphicsPipeline::GraphicsPipeline(VkDevice deviceArg, const GraphicsPipelineConfig& configArg)
     : config(configArg),
@@ -14,7 +18,13 @@ GraphicsPipeline::GraphicsPipeline(VkDevice deviceArg, const GraphicsPipelineCon
     device(deviceArg),
     pipelineLayout(VK_NULL_HANDLE),
     pipeline(VK_NULL_HANDLE) {
-    // Constructor uses initializer list for all members; nothing else required here.
+    // Own the vertex layout: creation may run later, on another thread, after the caller's arrays are gone
+    if (config.bindingDescription && config.attributeDescriptions) {
+        bindingDescriptions.assign(config.bindingDescription, config.bindingDescription + config.bindingCount);
+        attributeDescriptions.assign(config.attributeDescriptions, config.attributeDescriptions + config.attributeCount);
+    }
+    config.bindingDescription = nullptr;
+    config.attributeDescriptions = nullptr;
 }
 
 GraphicsPipeline::~GraphicsPipeline() {
@@ -27,7 +37,7 @@ GraphicsPipeline::~GraphicsPipeline() {
     }
 }
 
-void GraphicsPipeline::Create() {
+void GraphicsPipeline::Create(VkPipelineCache pipelineCache) {
     // Load shaders
     shader->LoadShader(config.vertShaderPath, VK_SHADER_STAGE_VERTEX_BIT);
     shader->LoadShader(config.fragShaderPath, VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -53,12 +63,12 @@ void GraphicsPipeline::Create() {
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    if (config.bindingDescription && config.attributeDescriptions) {
-        vertexInputInfo.vertexBindingDescriptionCount = config.bindingCount;
-        vertexInputInfo.pVertexBindingDescriptions = config.bindingDescription;
+    if (!bindingDescriptions.empty()) {
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 
-        vertexInputInfo.vertexAttributeDescriptionCount = config.attributeCount;
-        vertexInputInfo.pVertexAttributeDescriptions = config.attributeDescriptions;
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
     }
 
     // Input assembly
@@ -106,12 +116,22 @@ void GraphicsPipeline::Create() {
     depthStencil.depthCompareOp = config.depthCompareOp;
 
     depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.stencilTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = config.stencilTestEnable ? VK_TRUE : VK_FALSE;
+    if (config.stencilTestEnable) {
+        depthStencil.front.failOp = VK_STENCIL_OP_KEEP;
+        depthStencil.front.passOp = config.stencilPassOp;
+        depthStencil.front.depthFailOp = VK_STENCIL_OP_KEEP;
+        depthStencil.front.compareOp = config.stencilCompareOp;
+        depthStencil.front.compareMask = 0xFF;
+        depthStencil.front.writeMask = 0xFF;
+        depthStencil.front.reference = config.stencilReference;
+        depthStencil.back = depthStencil.front;
+    }
 
     // Color blending
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.colorWriteMask = config.colorWriteEnable ? (VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT) : 0;
     colorBlendAttachment.blendEnable = config.blendEnable ? VK_TRUE : VK_FALSE;
 
     if (config.blendEnable) {
@@ -168,7 +188,12 @@ void GraphicsPipeline::Create() {
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.pDepthStencilState = &depthStencil;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+    VkResult pipelineResult = VK_SUCCESS;
+    {
+        HitchScope hitchScope(HitchDetector::Category::PipelineCompile, "vkCreateGraphicsPipelines", config.fragShaderPath.c_str());
+        pipelineResult = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+    }
+    if (pipelineResult != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
@@ -185,4 +210,18 @@ void GraphicsPipeline::Cleanup() {
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         pipelineLayout = VK_NULL_HANDLE;
     }
+}
+
+double PipelineBatch::Create(JobSystem* jobSystem) {
+    ProfileScope profileScope("PipelineBatch::Create");
+    const auto start = std::chrono::steady_clock::now();
+
+    ParallelFor(jobSystem, pending.size(), 1, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            pending[i]->Create(pipelineCache);
+        }
+        }, "GraphicsPipeline::Create");
+
+    pending.clear();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
\ No newline at end of file
@@ -7,18 +7,21 @@
 #include "../vulkan/Vertex.h"
 #include "../vulkan/VulkanShader.h"
 
+class JobSystem;
+
 struct GraphicsPipelineConfig {
     std::string vertShaderPath;
     std::string fragShaderPath;
 
     std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 
+    // Copied by the GraphicsPipeline constructor, so they only need to outlive that call
     VkVertexInputBindingDescription* bindingDescription = nullptr;
     VkVertexInputAttributeDescription* attributeDescriptions = nullptr;
 
     VkRenderPass renderPass = VK_NULL_HANDLE;
 
-    VkExtent2D extent{ 0, 0 };
+    VkExtent2D extent{ 0, 0 }; // Not baked in: viewport and scissor are dynamic, so pipelines survive a resize
 
     uint32_t bindingCount = 1;
     uint32_t attributeCount = 0;
@@ -43,6 +46,13 @@ struct GraphicsPipelineConfig {
     bool depthWriteEnable = false;
     bool depthBiasEnable = false;
     bool blendEnable = false;
+    bool colorWriteEnable = true;
+
+    // Same for front and back faces, against a fixed reference. Needs a depth format with stencil.
+    bool stencilTestEnable = false;
+    VkCompareOp stencilCompareOp = VK_COMPARE_OP_ALWAYS;
+    VkStencilOp stencilPassOp = VK_STENCIL_OP_KEEP;
+    uint32_t stencilReference = 0;
 
     GraphicsPipelineConfig() = default;
     ~GraphicsPipelineConfig() = default;
@@ -65,7 +75,8 @@ public:
     GraphicsPipeline(GraphicsPipeline&&) noexcept = default;
     GraphicsPipeline& operator=(GraphicsPipeline&&) noexcept = default;
 
-    void Create();
+    // Thread-safe across pipelines: each owns its shader modules and layout
+    void Create(VkPipelineCache pipelineCache = VK_NULL_HANDLE);
     void Cleanup();
 
     VkPipeline GetPipeline() const { return pipeline; }
@@ -80,9 +91,35 @@ private:
         VK_DYNAMIC_STATE_LINE_WIDTH
     };
 
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+
     std::unique_ptr<VulkanShader> shader;
 
     VkDevice device;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipeline pipeline = VK_NULL_HANDLE;
+};
+
+// Defers GraphicsPipeline::Create so every pipeline of a renderer build compiles together,
+// one job each, through a shared VkPipelineCache (internally synchronized). Passes add
+// their pipelines while initializing and must not use them until Create has run.
+class PipelineBatch final {
+public:
+    explicit PipelineBatch(VkPipelineCache pipelineCacheArg) : pipelineCache(pipelineCacheArg) {}
+    ~PipelineBatch() = default;
+
+    // Non-copyable
+    PipelineBatch(const PipelineBatch&) = delete;
+    PipelineBatch& operator=(const PipelineBatch&) = delete;
+
+    void Add(GraphicsPipeline* pipeline) { pending.push_back(pipeline); }
+
+    // Creates every pending pipeline and waits. Rethrows the first failure. Inline without a job system.
+    // Returns the wall time in milliseconds.
+    double Create(JobSystem* jobSystem);
+
+private:
+    VkPipelineCache pipelineCache;
+    std::vector<GraphicsPipeline*> pending;
 };
\ No newline at end of file
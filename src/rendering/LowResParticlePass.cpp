@@ -0,0 +1,442 @@
+#include "LowResParticlePass.h"
+#include "../vulkan/VulkanUtils.h"
+#include "../core/HitchDetector.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    VkRenderPass CreateRenderPass(VkDevice device, const std::vector<VkAttachmentDescription>& attachments, bool hasDepth,
+        const std::vector<VkSubpassDependency>& dependencies, const char* errorMessage) {
+        VkAttachmentReference colorRef{};
+        colorRef.attachment = 0;
+        colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depthRef{};
+        depthRef.attachment = 1;
+        depthRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorRef;
+        subpass.pDepthStencilAttachment = hasDepth ? &depthRef : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.empty() ? nullptr : dependencies.data();
+
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+            throw std::runtime_error(errorMessage);
+        }
+        return renderPass;
+    }
+
+    VkFramebuffer CreateFramebuffer(VkDevice device, VkRenderPass renderPass, const std::vector<VkImageView>& attachments, const VkExtent2D& extent) {
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = renderPass;
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        framebufferInfo.pAttachments = attachments.data();
+        framebufferInfo.width = extent.width;
+        framebufferInfo.height = extent.height;
+        framebufferInfo.layers = 1;
+
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create low-res particle framebuffer!");
+        }
+        return framebuffer;
+    }
+
+}
+
+LowResParticlePass::LowResParticlePass(VkDevice deviceArg)
+    : device(deviceArg) {
+}
+
+LowResParticlePass::~LowResParticlePass() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void LowResParticlePass::Initialize(uint32_t divisorArg, VkFormat sceneColorFormat, PipelineBatch& pipelines) {
+    divisor = std::max(divisorArg, 1u);
+
+    CreateRenderPasses(sceneColorFormat);
+    CreateDescriptors();
+    CreatePipelines(pipelines);
+}
+
+void LowResParticlePass::DeclareTargets(RenderGraph& graph, RenderGraph::PassHandle pass, const VkExtent2D& sceneExtentArg,
+    RenderGraph::ImageHandle sceneDepthArg, RenderGraph::ImageHandle sceneColorArg) {
+    sceneExtent = sceneExtentArg;
+    lowResExtent = {
+        std::max(sceneExtent.width / divisor, 1u),
+        std::max(sceneExtent.height / divisor, 1u)
+    };
+    sceneDepth = sceneDepthArg;
+    sceneColor = sceneColorArg;
+
+    particleColor = graph.CreateImage("LowResParticleColor",
+        { lowResExtent, PARTICLE_COLOR_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT });
+    lowResDepthCopy = graph.CreateImage("LowResDepthCopy",
+        { lowResExtent, DEPTH_COPY_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT });
+    lowResDepth = graph.CreateImage("LowResDepth",
+        { lowResExtent, LOW_RES_DEPTH_FORMAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT });
+
+    // In the order Render and Composite touch them; the render passes make the transitions between uses
+    graph.Use(pass, sceneDepth, RenderGraph::Usage::DepthSampled);
+    graph.Use(pass, sceneColor, RenderGraph::Usage::ColorAttachment);
+    graph.Use(pass, lowResDepthCopy, RenderGraph::Usage::ColorAttachment);
+    graph.Use(pass, lowResDepthCopy, RenderGraph::Usage::Sampled);
+    graph.Use(pass, lowResDepth, RenderGraph::Usage::DepthAttachment);
+    graph.Use(pass, particleColor, RenderGraph::Usage::ColorAttachment);
+    graph.Use(pass, particleColor, RenderGraph::Usage::Sampled);
+}
+
+void LowResParticlePass::BindTargets(const RenderGraph& graph, const std::vector<VkImageView>& sceneColorViews) {
+    const VkImageView depthCopyView = graph.GetImageView(lowResDepthCopy);
+    const VkImageView depthView = graph.GetImageView(lowResDepth);
+    const VkImageView colorView = graph.GetImageView(particleColor);
+
+    downsampleFramebuffer = CreateFramebuffer(device, downsampleRenderPass, { depthCopyView, depthView }, lowResExtent);
+    particleFramebuffer = CreateFramebuffer(device, particleRenderPass, { colorView, depthView }, lowResExtent);
+    for (const VkImageView sceneColorView : sceneColorViews) {
+        compositeFramebuffers.push_back(CreateFramebuffer(device, compositeRenderPass, { sceneColorView }, sceneExtent));
+    }
+
+    const std::array<VkDescriptorImageInfo, 3> imageInfos = { {
+        { pointSampler, graph.GetImageView(sceneDepth), VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL },
+        { pointSampler, depthCopyView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+        { pointSampler, colorView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+    } };
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].descriptorCount = 1;
+        writes[i].pImageInfo = &imageInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void LowResParticlePass::ReleaseTargets() {
+    for (VkFramebuffer* framebuffer : { &downsampleFramebuffer, &particleFramebuffer }) {
+        if (*framebuffer != VK_NULL_HANDLE) {
+            vkDestroyFramebuffer(device, *framebuffer, nullptr);
+            *framebuffer = VK_NULL_HANDLE;
+        }
+    }
+    for (const VkFramebuffer framebuffer : compositeFramebuffers) {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    }
+    compositeFramebuffers.clear();
+}
+
+void LowResParticlePass::CreateRenderPasses(VkFormat sceneColorFormat) {
+    // --- 1. Depth downsample: R32F copy + depth attachment ---
+    {
+        VkAttachmentDescription depthCopy{};
+        depthCopy.format = DEPTH_COPY_FORMAT;
+        depthCopy.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthCopy.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE; // Fullscreen pass overwrites every texel
+        depthCopy.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depthCopy.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthCopy.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthCopy.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthCopy.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkAttachmentDescription depth{};
+        depth.format = LOW_RES_DEPTH_FORMAT;
+        depth.samples = VK_SAMPLE_COUNT_1_BIT;
+        depth.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depth.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depth.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depth.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depth.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        // Entry into the pass belongs to the render graph; this covers the hand-over to the particle pass
+        std::vector<VkSubpassDependency> dependencies(1);
+        dependencies[0].srcSubpass = 0;
+        dependencies[0].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+        downsampleRenderPass = CreateRenderPass(device, { depthCopy, depth }, true, dependencies,
+            "failed to create depth downsample render pass!");
+    }
+
+    // --- 2. Particles: color (cleared to transmittance 1) + downsampled depth, read only ---
+    {
+        VkAttachmentDescription color{};
+        color.format = PARTICLE_COLOR_FORMAT;
+        color.samples = VK_SAMPLE_COUNT_1_BIT;
+        color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        color.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkAttachmentDescription depth{};
+        depth.format = LOW_RES_DEPTH_FORMAT;
+        depth.samples = VK_SAMPLE_COUNT_1_BIT;
+        depth.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        depth.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depth.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depth.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        std::vector<VkSubpassDependency> dependencies(2);
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        particleRenderPass = CreateRenderPass(device, { color, depth }, true, dependencies,
+            "failed to create low-res particle render pass!");
+    }
+
+    // --- 3. Composite: blends onto the finished scene color; the render graph hands it on ---
+    {
+        VkAttachmentDescription color{};
+        color.format = sceneColorFormat;
+        color.samples = VK_SAMPLE_COUNT_1_BIT;
+        color.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        color.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        // Every dependency on the scene color is a render graph barrier, including the one from the
+        // particle target this pass samples (already covered by the particle pass's exit dependency)
+        compositeRenderPass = CreateRenderPass(device, { color }, false, {},
+            "failed to create particle composite render pass!");
+    }
+}
+
+void LowResParticlePass::CreateDescriptors() {
+    // Every tap is an explicit texelFetch, so filtering never matters
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &pointSampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create low-res particle sampler!");
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorCount = 1;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].pImmutableSamplers = nullptr;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create low-res particle set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = static_cast<uint32_t>(bindings.size());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create low-res particle descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+
+    VkResult allocResult = VK_SUCCESS;
+    {
+        HitchScope hitchScope(HitchDetector::Category::DescriptorAllocation, "vkAllocateDescriptorSets", "low-res particles");
+        allocResult = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+    }
+    if (allocResult != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate low-res particle descriptor set!");
+    }
+}
+
+void LowResParticlePass::CreatePipelines(PipelineBatch& pipelines) {
+    // Both passes draw a single fullscreen triangle generated in the vertex shader
+    GraphicsPipelineConfig config{};
+    config.vertShaderPath = "src/shaders/fullscreen_vert.spv";
+    config.descriptorSetLayouts = { setLayout };
+    config.cullMode = VK_CULL_MODE_NONE;
+
+    // Depth downsample writes gl_FragDepth unconditionally
+    config.fragShaderPath = "src/shaders/depth_downsample_frag.spv";
+    config.renderPass = downsampleRenderPass;
+    config.depthTestEnable = true;
+    config.depthWriteEnable = true;
+    config.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+
+    downsamplePipeline = std::make_unique<GraphicsPipeline>(device, config);
+    pipelines.Add(downsamplePipeline.get());
+
+    // Composite: scene * transmittance + particles
+    config.fragShaderPath = "src/shaders/particle_composite_frag.spv";
+    config.renderPass = compositeRenderPass;
+    config.depthTestEnable = false;
+    config.depthWriteEnable = false;
+    config.blendEnable = true;
+    config.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    config.dstColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    config.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    config.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+
+    compositePipeline = std::make_unique<GraphicsPipeline>(device, config);
+    pipelines.Add(compositePipeline.get());
+}
+
+void LowResParticlePass::BeginPass(VkCommandBuffer cmd, VkRenderPass pass, VkFramebuffer framebuffer, const VkExtent2D& extent, const VkClearValue* clearValues, uint32_t clearCount) const {
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = pass;
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.offset = { 0, 0 };
+    renderPassInfo.renderArea.extent = extent;
+    renderPassInfo.clearValueCount = clearCount;
+    renderPassInfo.pClearValues = clearValues;
+
+    vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = extent;
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+}
+
+void LowResParticlePass::Render(VkCommandBuffer cmd, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet, const ParticlePass& particles, RenderStats::Counters& counters) const {
+    // 1. Downsample depth (the render graph has made the scene depth readable)
+    {
+        std::array<VkClearValue, 2> clearValues{};
+        clearValues[0].color = { {1.0f, 0.0f, 0.0f, 0.0f} };
+        clearValues[1].depthStencil = { 1.0f, 0 };
+
+        BeginPass(cmd, downsampleRenderPass, downsampleFramebuffer, lowResExtent, clearValues.data(), static_cast<uint32_t>(clearValues.size()));
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, downsamplePipeline->GetPipeline());
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, downsamplePipeline->GetLayout(), 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+        vkCmdEndRenderPass(cmd);
+        ++counters.pipelineBinds;
+        ++counters.descriptorSetBinds;
+        counters.Draw(3);
+    }
+
+    // 2. Particles at reduced resolution
+    {
+        std::array<VkClearValue, 2> clearValues{};
+        clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} }; // No particles = full transmittance
+        clearValues[1].depthStencil = { 1.0f, 0 };
+
+        BeginPass(cmd, particleRenderPass, particleFramebuffer, lowResExtent, clearValues.data(), static_cast<uint32_t>(clearValues.size()));
+        particles.Draw(cmd, currentFrame, globalDescriptorSet, counters, true);
+        vkCmdEndRenderPass(cmd);
+    }
+}
+
+void LowResParticlePass::Composite(VkCommandBuffer cmd, uint32_t sceneColorIndex, RenderStats::Counters& counters) const {
+    BeginPass(cmd, compositeRenderPass, compositeFramebuffers[sceneColorIndex], sceneExtent, nullptr, 0);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, compositePipeline->GetPipeline());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, compositePipeline->GetLayout(), 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdDraw(cmd, 3, 1, 0, 0);
+    vkCmdEndRenderPass(cmd);
+    ++counters.pipelineBinds;
+    ++counters.descriptorSetBinds;
+    counters.Draw(3);
+}
+
+void LowResParticlePass::Cleanup() {
+    if (downsamplePipeline) {
+        downsamplePipeline->Cleanup();
+        downsamplePipeline.reset();
+    }
+    if (compositePipeline) {
+        compositePipeline->Cleanup();
+        compositePipeline.reset();
+    }
+
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+
+    ReleaseTargets();
+    for (VkRenderPass* pass : { &downsampleRenderPass, &particleRenderPass, &compositeRenderPass }) {
+        if (*pass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device, *pass, nullptr);
+            *pass = VK_NULL_HANDLE;
+        }
+    }
+
+    if (pointSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, pointSampler, nullptr);
+        pointSampler = VK_NULL_HANDLE;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+#include "GraphicsPipeline.h"
+#include "ParticlePass.h"
+#include "RenderGraph.h"
+
+// Renders particles into a reduced-resolution target and composites them back over the scene.
+//  1. The scene depth buffer is downsampled (farthest depth per footprint) into a low-res depth target.
+//  2. ParticlePass draws into a low-res color target, depth tested against the downsampled depth.
+//     RGB holds premultiplied particle color, A holds the remaining scene transmittance.
+//  3. A fullscreen composite upsamples with a nearest-depth filter so particles don't bleed across
+//     depth edges, then blends result = scene * A + RGB.
+class LowResParticlePass final {
+public:
+    explicit LowResParticlePass(VkDevice deviceArg);
+    ~LowResParticlePass();
+
+    // Non-copyable (explicitly declared)
+    LowResParticlePass(const LowResParticlePass&) = delete;
+    LowResParticlePass& operator=(const LowResParticlePass&) = delete;
+
+    // divisorArg: 2 = half resolution, 4 = quarter resolution. Creates everything but the targets, which
+    // belong to the render graph. The pipelines are added to pipelines and exist once the batch has been created.
+    void Initialize(uint32_t divisorArg, VkFormat sceneColorFormat, PipelineBatch& pipelines);
+
+    // Declares the low-res targets as transient images of graph, sized from the scene, and pass's uses of
+    // them and of the scene targets. The scene depth is sampled, so it needs VK_IMAGE_USAGE_SAMPLED_BIT.
+    void DeclareTargets(RenderGraph& graph, RenderGraph::PassHandle pass, const VkExtent2D& sceneExtentArg,
+        RenderGraph::ImageHandle sceneDepthArg, RenderGraph::ImageHandle sceneColorArg);
+    // Once graph is compiled: framebuffers over its images and the descriptors that sample them. The scene
+    // color is imported (the swap chain), so its views come separately: one composite framebuffer each.
+    void BindTargets(const RenderGraph& graph, const std::vector<VkImageView>& sceneColorViews);
+    // Drops the framebuffers over the graph's images, before the graph is rebuilt
+    void ReleaseTargets();
+
+    // Downsamples depth and draws all particles into the low-res target. Must run outside a render pass.
+    void Render(VkCommandBuffer cmd, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet, const ParticlePass& particles, RenderStats::Counters& counters) const;
+
+    // Upsamples the particle target and blends it over scene color view sceneColorIndex (left as a color attachment)
+    void Composite(VkCommandBuffer cmd, uint32_t sceneColorIndex, RenderStats::Counters& counters) const;
+
+    void Cleanup();
+
+    // Render pass ParticlePass must build its low-res pipelines against
+    VkRenderPass GetParticleRenderPass() const { return particleRenderPass; }
+    uint32_t GetDivisor() const { return divisor; }
+
+private:
+    VkDevice device;
+
+    VkExtent2D sceneExtent{ 0, 0 };
+    VkExtent2D lowResExtent{ 0, 0 };
+    uint32_t divisor = 2;
+
+    // Render graph images: the scene targets and the low-res ones, which only live during this pass
+    RenderGraph::ImageHandle sceneDepth = 0;
+    RenderGraph::ImageHandle sceneColor = 0;
+    RenderGraph::ImageHandle particleColor = 0;   // Premultiplied color + transmittance
+    RenderGraph::ImageHandle lowResDepthCopy = 0; // R32F copy of the downsampled depth, sampled by the composite
+    RenderGraph::ImageHandle lowResDepth = 0;     // Depth attachment the particles are tested against
+
+    VkSampler pointSampler = VK_NULL_HANDLE;
+
+    // Passes
+    VkRenderPass downsampleRenderPass = VK_NULL_HANDLE;
+    VkRenderPass particleRenderPass = VK_NULL_HANDLE;
+    VkRenderPass compositeRenderPass = VK_NULL_HANDLE;
+    VkFramebuffer downsampleFramebuffer = VK_NULL_HANDLE;
+    VkFramebuffer particleFramebuffer = VK_NULL_HANDLE;
+    std::vector<VkFramebuffer> compositeFramebuffers; // One per scene color view
+
+    // binding 0 = scene depth, 1 = low-res depth, 2 = particle color
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    std::unique_ptr<GraphicsPipeline> downsamplePipeline;
+    std::unique_ptr<GraphicsPipeline> compositePipeline;
+
+    static constexpr VkFormat PARTICLE_COLOR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+    static constexpr VkFormat DEPTH_COPY_FORMAT = VK_FORMAT_R32_SFLOAT;
+    static constexpr VkFormat LOW_RES_DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+
+    void CreateRenderPasses(VkFormat sceneColorFormat);
+    void CreateDescriptors();
+    void CreatePipelines(PipelineBatch& pipelines);
+
+    void BeginPass(VkCommandBuffer cmd, VkRenderPass pass, VkFramebuffer framebuffer, const VkExtent2D& extent, const VkClearValue* clearValues, uint32_t clearCount) const;
+};
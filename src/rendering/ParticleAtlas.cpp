@@ -0,0 +1,212 @@
+#include "ParticleAtlas.h"
+#include "../vulkan/VulkanBuffer.h"
+#include "../vulkan/VulkanUtils.h"
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include <stb_image.h>
+#include "../core/AllocationTracker.h"
+#include "../core/CpuProfiler.h"
+#include "../core/HitchDetector.h"
+
+ParticleAtlas::ParticleAtlas(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPoolArg, VkQueue graphicsQueueArg)
+    : device(deviceArg), physicalDevice(physicalDeviceArg), commandPool(commandPoolArg), graphicsQueue(graphicsQueueArg) {
+}
+
+ParticleAtlas::~ParticleAtlas() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void ParticleAtlas::LoadFromFiles(const std::vector<std::string>& paths) {
+    AllocationScope allocationScope("TextureLoading");
+    ProfileScope profileScope("ParticleAtlas::LoadFromFiles");
+    HitchScope hitchScope(HitchDetector::Category::TextureLoad, "ParticleAtlas::LoadFromFiles");
+    if (paths.empty()) throw std::runtime_error("Particle atlas requires at least one image path");
+
+    // Deduplicate while keeping the caller's order so layer indices are stable across rebuilds
+    std::vector<std::string> uniquePaths;
+    layerLookup.clear();
+    for (const auto& path : paths) {
+        if (layerLookup.find(path) != layerLookup.end()) continue;
+        layerLookup[path] = static_cast<uint32_t>(uniquePaths.size());
+        uniquePaths.push_back(path);
+    }
+    layerCount = static_cast<uint32_t>(uniquePaths.size());
+
+    int texWidth = 0, texHeight = 0, texChannels = 0;
+    std::vector<stbi_uc*> pixels(layerCount, nullptr);
+
+    for (size_t i = 0; i < layerCount; i++) {
+        int w = 0, h = 0;
+        pixels[i] = stbi_load(uniquePaths[i].c_str(), &w, &h, &texChannels, STBI_rgb_alpha);
+        if (!pixels[i]) {
+            std::cerr << "Warning: Failed to load particle texture '" << uniquePaths[i] << "'. Using a blank atlas layer.\n";
+            continue;
+        }
+        if (texWidth == 0) {
+            texWidth = w;
+            texHeight = h;
+        }
+        else if (w != texWidth || h != texHeight) {
+            std::cerr << "Warning: Particle texture '" << uniquePaths[i] << "' is " << w << "x" << h
+                << " but the atlas is " << texWidth << "x" << texHeight << ". Using a blank atlas layer.\n";
+            stbi_image_free(pixels[i]);
+            pixels[i] = nullptr;
+        }
+    }
+
+    if (texWidth == 0) {
+        // Nothing loaded; keep a valid 1x1 array so the descriptor can still be bound
+        texWidth = 1;
+        texHeight = 1;
+    }
+
+    const VkDeviceSize layerSize = static_cast<VkDeviceSize>(texWidth) * static_cast<VkDeviceSize>(texHeight) * 4u;
+    const VkDeviceSize totalSize = layerSize * layerCount;
+
+    VulkanBuffer stagingBuffer(device, physicalDevice);
+    stagingBuffer.CreateBuffer(totalSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    void* data;
+    vkMapMemory(device, stagingBuffer.GetBufferMemory(), 0, totalSize, 0, &data);
+    for (size_t i = 0; i < layerCount; i++) {
+        char* const dst = static_cast<char*>(data) + (layerSize * i);
+        if (pixels[i]) {
+            memcpy(dst, pixels[i], static_cast<size_t>(layerSize));
+            stbi_image_free(pixels[i]);
+        }
+        else {
+            memset(dst, 0, static_cast<size_t>(layerSize));
+        }
+    }
+    vkUnmapMemory(device, stagingBuffer.GetBufferMemory());
+
+    VulkanUtils::CreateImage(
+        device, physicalDevice, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1, layerCount,
+        VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        image, imageMemory
+    );
+
+    VulkanUtils::TransitionImageLayout(device, commandPool, graphicsQueue, image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, layerCount);
+
+    const VkCommandBuffer commandBuffer = VulkanUtils::BeginSingleTimeCommands(device, commandPool);
+    std::vector<VkBufferImageCopy> bufferCopyRegions;
+    bufferCopyRegions.reserve(layerCount);
+    for (uint32_t i = 0; i < layerCount; i++) {
+        VkBufferImageCopy region{};
+        region.bufferOffset = layerSize * static_cast<VkDeviceSize>(i);
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = i;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1u };
+        bufferCopyRegions.push_back(region);
+    }
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.GetBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(bufferCopyRegions.size()), bufferCopyRegions.data());
+    VulkanUtils::EndSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+
+    VulkanUtils::TransitionImageLayout(device, commandPool, graphicsQueue, image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, layerCount);
+
+    imageView = VulkanUtils::CreateImageView(device, image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY, layerCount);
+
+    // Clamp so neighbouring sheet cells do not bleed into each other at the edges
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_TRANSPARENT_BLACK;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create particle atlas sampler!");
+    }
+}
+
+void ParticleAtlas::CreateDescriptorSet(VkDescriptorSetLayout layout) {
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create particle atlas descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+    VkResult allocResult = VK_SUCCESS;
+    {
+        HitchScope hitchScope(HitchDetector::Category::DescriptorAllocation, "vkAllocateDescriptorSets", "particle atlas");
+        allocResult = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+    }
+    if (allocResult != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate particle atlas descriptor set!");
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = imageView;
+    imageInfo.sampler = sampler;
+
+    VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+ParticleAtlas::Region ParticleAtlas::GetRegion(const std::string& path) const {
+    Region region;
+    const auto it = layerLookup.find(path);
+    if (it != layerLookup.end()) {
+        region.layer = static_cast<float>(it->second);
+    }
+    else {
+        std::cerr << "Warning: Particle texture '" << path << "' is not in the atlas. Using layer 0.\n";
+    }
+    return region;
+}
+
+std::vector<ParticleAtlas::Region> ParticleAtlas::GetSheetRegions(const std::string& path, uint32_t columns, uint32_t rows) const {
+    const Region base = GetRegion(path);
+    if (columns == 0 || rows == 0) return { base };
+
+    const glm::vec2 cellSize(1.0f / static_cast<float>(columns), 1.0f / static_cast<float>(rows));
+
+    std::vector<Region> regions;
+    regions.reserve(static_cast<size_t>(columns) * rows);
+    for (uint32_t y = 0; y < rows; y++) {
+        for (uint32_t x = 0; x < columns; x++) {
+            Region cell = base;
+            cell.uvRect = glm::vec4(cellSize.x * static_cast<float>(x), cellSize.y * static_cast<float>(y), cellSize.x, cellSize.y);
+            regions.push_back(cell);
+        }
+    }
+    return regions;
+}
+
+void ParticleAtlas::Cleanup() {
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    VulkanUtils::CleanupImageResources(device, image, imageMemory, imageView, sampler);
+    layerCount = 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// Packs every particle texture into a single 2D texture array so that all
+// particle systems can share one descriptor set and be drawn in merged batches.
+// Each layer holds one source image; a region addresses a layer plus a UV
+// sub-rectangle, which lets sprite sheets be split into flipbook frames.
+class ParticleAtlas final {
+public:
+    struct Region {
+        glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // xy = offset, zw = scale
+        float layer = 0.0f;
+    };
+
+    ParticleAtlas(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPoolArg, VkQueue graphicsQueueArg);
+    ~ParticleAtlas();
+
+    // Non-copyable
+    ParticleAtlas(const ParticleAtlas&) = delete;
+    ParticleAtlas& operator=(const ParticleAtlas&) = delete;
+
+    // Uploads one layer per path. All images must share the size of the first one;
+    // mismatched or missing images are replaced by a blank layer.
+    void LoadFromFiles(const std::vector<std::string>& paths);
+    void CreateDescriptorSet(VkDescriptorSetLayout layout);
+    void Cleanup();
+
+    // Full-image region for a texture path. Unknown paths fall back to layer 0.
+    Region GetRegion(const std::string& path) const;
+
+    // Splits the image at `path` into a columns x rows grid (row-major, top-left first).
+    std::vector<Region> GetSheetRegions(const std::string& path, uint32_t columns, uint32_t rows) const;
+
+    VkDescriptorSet GetDescriptorSet() const { return descriptorSet; }
+    uint32_t GetLayerCount() const { return layerCount; }
+
+private:
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    VkCommandPool commandPool;
+    VkQueue graphicsQueue;
+
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+    VkImageView imageView = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    uint32_t layerCount = 0;
+    std::map<std::string, uint32_t> layerLookup;
+};
@@ -0,0 +1,215 @@
+#include "ParticleBudget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    uint32_t RoundUpToGranularity(float count, uint32_t granularity) {
+        const uint32_t whole = static_cast<uint32_t>(std::ceil(std::max(count, 0.0f)));
+        return ((whole + granularity - 1) / granularity) * granularity;
+    }
+}
+
+ParticleBudget::ParticleBudget(uint32_t totalParticlesArg)
+    : totalParticles(totalParticlesArg),
+    arena(totalParticlesArg),
+    scratch(totalParticlesArg) {
+    stats.capacity = totalParticlesArg;
+}
+
+void ParticleBudget::SetViewer(const glm::vec3& cameraPosArg, const glm::mat4& viewMatrix, const glm::mat4& projMatrix) {
+    cameraPos = cameraPosArg;
+    projScale = std::fabs(projMatrix[1][1]);
+    hasViewer = true;
+
+    frustum = Frustum(projMatrix * viewMatrix);
+}
+
+float ParticleBudget::ScreenCoverage(const glm::vec3& center, float radius) const {
+    const float dist = glm::length(center - cameraPos);
+    if (dist <= radius) return 1.0f; // Camera is inside the volume
+
+    // Projected disc area relative to the 2x2 NDC square
+    const float ndcRadius = radius * projScale / dist;
+    return std::min(1.0f, 3.14159265f * ndcRadius * ndcRadius * 0.25f);
+}
+
+void ParticleBudget::Update(const std::vector<std::unique_ptr<ParticleSystem>>& systems, float dt) {
+    const size_t count = systems.size();
+    demand.assign(count, 0.0f);
+    weight.assign(count, 0.0f);
+
+    stats.pausedSystems = 0;
+
+    // 1. Per-emitter LOD and per-system demand
+    for (size_t i = 0; i < count; ++i) {
+        ParticleSystem& sys = *systems[i];
+
+        bool anyVisible = false;
+        float sysDemand = 0.0f;
+        float sysWeight = 0.0f;
+
+        for (size_t e = 0; e < sys.GetEmitterCount(); ++e) {
+            ParticleSystem::EmitterLod& lod = sys.GetEmitterLod(e);
+            float coverage = 1.0f;
+
+            if (hasViewer) {
+                lod.visible = frustum.IntersectsSphere(lod.center, lod.radius);
+
+                const float surfaceDist = std::max(0.0f, glm::length(lod.center - cameraPos) - lod.radius);
+                const float distScale = (surfaceDist <= FULL_RATE_DISTANCE)
+                    ? 1.0f
+                    : std::max(MIN_RATE_SCALE, FULL_RATE_DISTANCE / surfaceDist);
+
+                lod.rateScale = lod.visible ? distScale : CULLED_RATE_SCALE;
+                coverage = lod.visible ? ScreenCoverage(lod.center, lod.radius) : 0.0f;
+            }
+            else {
+                lod.visible = true;
+                lod.rateScale = 1.0f;
+            }
+
+            anyVisible = anyVisible || lod.visible;
+            sysDemand += lod.steadyStateCount * lod.rateScale;
+            sysWeight = std::max(sysWeight, lod.priority * (coverage + 0.01f));
+        }
+
+        const bool paused = hasViewer && sys.GetEmitterCount() > 0 && !anyVisible;
+        sys.SetPaused(paused);
+
+        if (paused) {
+            // Frozen systems only need to keep what they already have
+            stats.pausedSystems++;
+            sysDemand = static_cast<float>(sys.GetAliveCount());
+        }
+        else {
+            sysDemand *= DEMAND_HEADROOM;
+        }
+
+        demand[i] = sysDemand;
+        weight[i] = sysWeight;
+    }
+
+    // 2. Periodically redistribute the arena
+    timeSinceRebalance += dt;
+    if (count != lastSystemCount || timeSinceRebalance >= REBALANCE_INTERVAL) {
+        ComputeAllocation();
+
+        bool needsRepack = (count != lastSystemCount);
+        for (size_t i = 0; i < count && !needsRepack; ++i) {
+            const uint32_t current = systems[i]->GetCapacity();
+            const uint32_t target = allocation[i];
+            const uint32_t diff = (target > current) ? target - current : current - target;
+            needsRepack = diff > std::max(SLICE_GRANULARITY, current / 8);
+        }
+
+        if (needsRepack) {
+            Repack(systems);
+        }
+
+        lastSystemCount = count;
+        timeSinceRebalance = 0.0f;
+    }
+
+    // 3. Throttle emission so each system's steady state fits its slice without dropping
+    stats.allocated = 0;
+    stats.alive = 0;
+    stats.dropped = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ParticleSystem& sys = *systems[i];
+        const float capacity = static_cast<float>(sys.GetCapacity());
+        const float scale = (demand[i] > capacity && demand[i] > 0.0f) ? capacity / demand[i] : 1.0f;
+        sys.SetEmissionScale(scale);
+
+        stats.allocated += sys.GetCapacity();
+        stats.alive += sys.GetAliveCount();
+        stats.dropped += sys.GetDroppedCount();
+    }
+}
+
+void ParticleBudget::ComputeAllocation() {
+    const size_t count = demand.size();
+    allocation.assign(count, 0);
+
+    wanted.resize(count);
+    uint64_t totalWanted = 0;
+    for (size_t i = 0; i < count; ++i) {
+        wanted[i] = RoundUpToGranularity(demand[i], SLICE_GRANULARITY);
+        totalWanted += wanted[i];
+    }
+
+    if (totalWanted <= totalParticles) {
+        allocation = wanted;
+        return;
+    }
+
+    // Oversubscribed: weighted water-filling. Systems whose demand fits inside their weighted
+    // share are satisfied first and the remainder is split again among the rest.
+    pending.resize(count);
+    for (size_t i = 0; i < count; ++i) pending[i] = i;
+    uint32_t remaining = totalParticles;
+
+    while (!pending.empty()) {
+        float weightSum = 0.0f;
+        for (const size_t i : pending) weightSum += weight[i];
+
+        const auto shareOf = [&](size_t i) {
+            const float w = (weightSum > 0.0f) ? weight[i] / weightSum : 1.0f / static_cast<float>(pending.size());
+            return static_cast<float>(remaining) * w;
+        };
+
+        unsatisfied.clear();
+        uint32_t granted = 0;
+        for (const size_t i : pending) {
+            if (static_cast<float>(wanted[i]) <= shareOf(i)) {
+                allocation[i] = wanted[i];
+                granted += wanted[i];
+            }
+            else {
+                unsatisfied.push_back(i);
+            }
+        }
+
+        if (unsatisfied.size() == pending.size()) {
+            // Nobody fits: everyone gets their weighted share, rounded down to the slice granularity
+            for (const size_t i : pending) {
+                const uint32_t share = static_cast<uint32_t>(shareOf(i));
+                allocation[i] = (share / SLICE_GRANULARITY) * SLICE_GRANULARITY;
+            }
+            break;
+        }
+
+        remaining -= granted;
+        pending.swap(unsatisfied);
+    }
+}
+
+void ParticleBudget::Repack(const std::vector<std::unique_ptr<ParticleSystem>>& systems) {
+    uint32_t offset = 0;
+    for (size_t i = 0; i < systems.size(); ++i) {
+        ParticleSystem& sys = *systems[i];
+        const uint32_t capacity = allocation[i];
+        const uint32_t alive = sys.GetAliveCount();
+        const uint32_t keep = std::min(alive, capacity);
+
+        if (keep > 0) {
+            std::copy(sys.GetPool(), sys.GetPool() + keep, scratch.begin() + offset);
+        }
+        stats.evicted += alive - keep;
+
+        sys.AssignPool(scratch.data() + offset, capacity, keep);
+        offset += capacity;
+    }
+
+    // Vector swap exchanges buffers, so the slices handed out above stay valid
+    arena.swap(scratch);
+}
+
+void ParticleBudget::Reset() {
+    lastSystemCount = 0;
+    timeSinceRebalance = 0.0f;
+    demand.clear();
+    weight.clear();
+    allocation.clear();
+    stats = Stats{};
+    stats.capacity = totalParticles;
+}
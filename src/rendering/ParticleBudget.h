@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "ParticleSystem.h"
+#include "Frustum.h"
+
+// Global particle budget. Owns one shared arena of particles and hands out slices of it
+// to particle systems by priority, screen coverage and distance. Each frame it also
+// scales emitter rates down with distance, throttles emitters outside the view
+// frustum and pauses whole systems that cannot be seen.
+class ParticleBudget final {
+public:
+    struct Stats {
+        uint32_t capacity = 0;       // Total arena size
+        uint32_t allocated = 0;      // Sum of all slices handed out
+        uint32_t alive = 0;
+        uint32_t pausedSystems = 0;
+        uint64_t dropped = 0;        // Emits rejected because a slice was full
+        uint64_t evicted = 0;        // Live particles discarded when a slice shrank
+    };
+
+    explicit ParticleBudget(uint32_t totalParticlesArg);
+    ~ParticleBudget() = default;
+
+    // Non-copyable
+    ParticleBudget(const ParticleBudget&) = delete;
+    ParticleBudget& operator=(const ParticleBudget&) = delete;
+
+    void SetViewer(const glm::vec3& cameraPosArg, const glm::mat4& viewMatrix, const glm::mat4& projMatrix);
+
+    // Runs before the systems simulate: updates LOD, pause state and, periodically, slice sizes
+    void Update(const std::vector<std::unique_ptr<ParticleSystem>>& systems, float dt);
+
+    // Drops every slice (call when the owning scene clears its systems)
+    void Reset();
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    // Tuning
+    static constexpr float FULL_RATE_DISTANCE = 60.0f;  // Emitters closer than this emit at full rate
+    static constexpr float MIN_RATE_SCALE = 0.15f;      // Floor for distance-based emission scaling
+    static constexpr float CULLED_RATE_SCALE = 0.1f;    // Rate for emitters outside the frustum in a visible system
+    static constexpr float DEMAND_HEADROOM = 1.1f;      // Slack so emission bursts don't hit the slice limit
+    static constexpr float REBALANCE_INTERVAL = 0.25f;  // Seconds between arena repacks
+    static constexpr uint32_t SLICE_GRANULARITY = 64;
+
+    uint32_t totalParticles;
+
+    // Double-buffered arena: repacking copies live particles from one into the other
+    std::vector<ParticleSystem::Particle> arena;
+    std::vector<ParticleSystem::Particle> scratch;
+
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    Frustum frustum;
+    float projScale = 1.0f;           // cot(fovY / 2), used for screen coverage
+    bool hasViewer = false;
+
+    float timeSinceRebalance = 0.0f;
+    size_t lastSystemCount = 0;
+
+    // Per-system scratch, indexed like the systems vector
+    std::vector<float> demand;
+    std::vector<float> weight;
+    std::vector<uint32_t> allocation;
+    std::vector<uint32_t> wanted;       // ComputeAllocation scratch, kept so rebalancing doesn't allocate
+    std::vector<size_t> pending;
+    std::vector<size_t> unsatisfied;
+
+    Stats stats;
+
+    float ScreenCoverage(const glm::vec3& center, float radius) const;
+    void ComputeAllocation();
+    void Repack(const std::vector<std::unique_ptr<ParticleSystem>>& systems);
+};
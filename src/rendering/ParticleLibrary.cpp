@@ -1,5 +1,7 @@
 #include "ParticleLibrary.h"
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
 
 namespace ParticleLibrary {
 
@@ -33,18 +35,27 @@ namespace ParticleLibrary {
     }
 
     const ParticleProps& GetFireProps() {
-        static const ParticleProps props = CreateProps(
-            glm::vec3(0.0f, 2.0f, 0.0f),        // Velocity
-            glm::vec3(0.5f, 1.0f, 0.5f),        // Velocity Variation
-            glm::vec4(1.0f, 0.5f, 0.0f, 1.0f),  // Color Begin
-            glm::vec4(1.0f, 0.0f, 0.0f, 0.0f),  // Color End
-            0.5f,                               // Size Begin
-            0.1f,                               // Size End
-            0.3f,                               // Size Variation
-            1.0f,                               // Lifetime
-            "textures/kenney_particle-pack/transparent/fire_01.png", // Texture
-            true                                // Is Additive
-        );
+        static const ParticleProps props = [] {
+            ParticleProps p = CreateProps(
+                glm::vec3(0.0f, 2.0f, 0.0f),        // Velocity
+                glm::vec3(0.5f, 1.0f, 0.5f),        // Velocity Variation
+                glm::vec4(1.0f, 0.5f, 0.0f, 1.0f),  // Color Begin
+                glm::vec4(1.0f, 0.0f, 0.0f, 0.0f),  // Color End
+                0.5f,                               // Size Begin
+                0.1f,                               // Size End
+                0.3f,                               // Size Variation
+                1.0f,                               // Lifetime
+                "textures/kenney_particle-pack/transparent/fire_01.png", // Texture
+                true                                // Is Additive
+            );
+            // Flicker between the two flame shapes
+            p.flipbookFrames = {
+                "textures/kenney_particle-pack/transparent/fire_01.png",
+                "textures/kenney_particle-pack/transparent/fire_02.png"
+            };
+            p.flipbookFps = 12.0f;
+            return p;
+        }();
         return props;
     }
 
@@ -112,4 +123,25 @@ namespace ParticleLibrary {
         return props;
     }
 
+    std::vector<std::string> GetAtlasTextures() {
+        const std::array<const ParticleProps*, 5> allProps = {
+            &GetFireProps(), &GetSmokeProps(), &GetRainProps(), &GetSnowProps(), &GetDustProps()
+        };
+
+        std::vector<std::string> textures;
+        const auto addUnique = [&textures](const std::string& path) {
+            if (!path.empty() && std::find(textures.begin(), textures.end(), path) == textures.end()) {
+                textures.push_back(path);
+            }
+        };
+
+        for (const ParticleProps* props : allProps) {
+            addUnique(props->texturePath);
+            for (const auto& frame : props->flipbookFrames) {
+                addUnique(frame);
+            }
+        }
+        return textures;
+    }
+
 } // namespace ParticleLibrary
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ParticleSystem.h"
+#include <string>
+#include <vector>
 
 namespace ParticleLibrary {
     const ParticleProps& GetFireProps();
@@ -8,4 +10,7 @@ namespace ParticleLibrary {
     const ParticleProps& GetRainProps();
     const ParticleProps& GetSnowProps();
     const ParticleProps& GetDustProps();
+
+    // Every texture referenced by the props above, in a stable order (one atlas layer each)
+    std::vector<std::string> GetAtlasTextures();
 }
\ No newline at end of file
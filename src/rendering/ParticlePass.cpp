@@ -0,0 +1,239 @@
+#include "ParticlePass.h"
+#include "ParticleLibrary.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+ParticlePass::ParticlePass(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPoolArg, VkQueue graphicsQueueArg)
+    : device(deviceArg), physicalDevice(physicalDeviceArg), commandPool(commandPoolArg), graphicsQueue(graphicsQueueArg) {
+}
+
+ParticlePass::~ParticlePass() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void ParticlePass::Initialize(VkRenderPass renderPass, const VkExtent2D& extent, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout textureSetLayout, uint32_t framesInFlightArg, PipelineBatch& pipelines) {
+    pipelineExtent = extent;
+    globalLayout = globalSetLayout;
+    textureLayout = textureSetLayout;
+
+    // 1. Atlas (texture array) shared by every particle system
+    atlas = std::make_unique<ParticleAtlas>(device, physicalDevice, commandPool, graphicsQueue);
+    atlas->LoadFromFiles(ParticleLibrary::GetAtlasTextures());
+    atlas->CreateDescriptorSet(textureSetLayout);
+
+    // 2. Pipelines + geometry
+    CreatePipelines(renderPass, false, additivePipeline, alphaPipeline, pipelines);
+    CreateQuadBuffer();
+
+    instanceBuffers.resize(framesInFlightArg);
+    instanceBuffersMapped.assign(framesInFlightArg, nullptr);
+    instanceCapacity.assign(framesInFlightArg, 0);
+    additiveCounts.assign(framesInFlightArg, 0);
+    alphaCounts.assign(framesInFlightArg, 0);
+    for (uint32_t i = 0; i < framesInFlightArg; ++i) {
+        CreateInstanceBuffer(i, INITIAL_INSTANCE_CAPACITY);
+    }
+}
+
+void ParticlePass::CreateLowResPipelines(VkRenderPass lowResRenderPass, PipelineBatch& pipelines) {
+    DestroyLowResPipelines();
+    CreatePipelines(lowResRenderPass, true, lowResAdditivePipeline, lowResAlphaPipeline, pipelines);
+}
+
+void ParticlePass::DestroyLowResPipelines() {
+    if (lowResAdditivePipeline) {
+        lowResAdditivePipeline->Cleanup();
+        lowResAdditivePipeline.reset();
+    }
+    if (lowResAlphaPipeline) {
+        lowResAlphaPipeline->Cleanup();
+        lowResAlphaPipeline.reset();
+    }
+}
+
+void ParticlePass::CreatePipelines(VkRenderPass renderPass, bool lowRes, std::unique_ptr<GraphicsPipeline>& additive, std::unique_ptr<GraphicsPipeline>& alpha, PipelineBatch& pipelines) const {
+    auto bindings = ParticleSystem::GetBindingDescriptions();
+    auto attribs = ParticleSystem::GetAttributeDescriptions();
+
+    GraphicsPipelineConfig config{};
+    config.vertShaderPath = "src/shaders/particle_vert.spv";
+    config.fragShaderPath = "src/shaders/particle_frag.spv";
+    config.renderPass = renderPass;
+    config.extent = pipelineExtent;
+
+    config.bindingDescription = bindings.data();
+    config.bindingCount = static_cast<uint32_t>(bindings.size());
+    config.attributeDescriptions = attribs.data();
+    config.attributeCount = static_cast<uint32_t>(attribs.size());
+
+    config.descriptorSetLayouts = { globalLayout, textureLayout };
+
+    config.depthWriteEnable = false;
+    config.depthTestEnable = true;
+    config.blendEnable = true;
+
+    // Additive Pipeline
+    config.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    config.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    if (lowRes) {
+        // Additive light doesn't occlude: transmittance unchanged
+        config.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        config.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    }
+
+    additive = std::make_unique<GraphicsPipeline>(device, config);
+    pipelines.Add(additive.get());
+
+    // Alpha Blended Pipeline
+    config.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    config.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    if (lowRes) {
+        // transmittance *= (1 - alpha)
+        config.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        config.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    }
+
+    alpha = std::make_unique<GraphicsPipeline>(device, config);
+    pipelines.Add(alpha.get());
+}
+
+void ParticlePass::CreateQuadBuffer() {
+    // x, y, z, u, v (6 vertices * 5 floats = 30 floats)
+    const std::array<float, 30> vertices = {
+        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
+         0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
+         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
+         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f
+    };
+
+    vertexBuffer = std::make_unique<VulkanBuffer>(device, physicalDevice);
+    vertexBuffer->CreateBuffer(sizeof(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vertexBuffer->CopyData(vertices.data(), sizeof(vertices));
+}
+
+void ParticlePass::CreateInstanceBuffer(uint32_t frame, uint32_t capacity) {
+    const VkDeviceSize size = static_cast<VkDeviceSize>(capacity) * sizeof(ParticleSystem::InstanceData);
+
+    instanceBuffers[frame] = std::make_unique<VulkanBuffer>(device, physicalDevice);
+    instanceBuffers[frame]->CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vkMapMemory(device, instanceBuffers[frame]->GetBufferMemory(), 0, size, 0, &instanceBuffersMapped[frame]);
+    instanceCapacity[frame] = capacity;
+}
+
+void ParticlePass::DestroyInstanceBuffer(uint32_t frame) {
+    if (!instanceBuffers[frame]) return;
+
+    if (instanceBuffersMapped[frame]) {
+        vkUnmapMemory(device, instanceBuffers[frame]->GetBufferMemory());
+        instanceBuffersMapped[frame] = nullptr;
+    }
+    instanceBuffers[frame]->Cleanup();
+    instanceBuffers[frame].reset();
+    instanceCapacity[frame] = 0;
+}
+
+void ParticlePass::Prepare(const RenderSnapshot& snapshot, uint32_t currentFrame) {
+    const auto& additiveInstances = snapshot.additiveParticles;
+    const auto& alphaInstances = snapshot.alphaParticles;
+
+    const uint32_t additiveCount = static_cast<uint32_t>(additiveInstances.size());
+    const uint32_t alphaCount = static_cast<uint32_t>(alphaInstances.size());
+    const uint32_t total = additiveCount + alphaCount;
+
+    // The fence for this frame has already been waited on, so its buffer is free to replace
+    if (total > instanceCapacity[currentFrame]) {
+        DestroyInstanceBuffer(currentFrame);
+        CreateInstanceBuffer(currentFrame, std::max(total, INITIAL_INSTANCE_CAPACITY * 2u));
+    }
+
+    auto* const dst = static_cast<ParticleSystem::InstanceData*>(instanceBuffersMapped[currentFrame]);
+    if (additiveCount > 0) {
+        std::memcpy(dst, additiveInstances.data(), additiveCount * sizeof(ParticleSystem::InstanceData));
+    }
+    if (alphaCount > 0) {
+        std::memcpy(dst + additiveCount, alphaInstances.data(), alphaCount * sizeof(ParticleSystem::InstanceData));
+    }
+
+    additiveCounts[currentFrame] = additiveCount;
+    alphaCounts[currentFrame] = alphaCount;
+}
+
+void ParticlePass::Draw(VkCommandBuffer cmd, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet, RenderStats::Counters& counters, bool lowRes) const {
+    const uint32_t additiveCount = additiveCounts[currentFrame];
+    const uint32_t alphaCount = alphaCounts[currentFrame];
+    if (additiveCount == 0 && alphaCount == 0) return;
+
+    const GraphicsPipeline& alphaPipe = lowRes ? *lowResAlphaPipeline : *alphaPipeline;
+    const GraphicsPipeline& additivePipe = lowRes ? *lowResAdditivePipeline : *additivePipeline;
+
+    const std::array<VkBuffer, 2> vertexBuffers = { vertexBuffer->GetBuffer(), instanceBuffers[currentFrame]->GetBuffer() };
+    const std::array<VkDeviceSize, 2> offsets = { 0, 0 };
+    vkCmdBindVertexBuffers(cmd, 0, static_cast<uint32_t>(vertexBuffers.size()), vertexBuffers.data(), offsets.data());
+    ++counters.bufferBinds;
+
+    // Both pipelines are built from the same set layouts, so the sets stay bound across the pipeline switch
+    const std::array<VkDescriptorSet, 2> sets = { globalDescriptorSet, atlas->GetDescriptorSet() };
+    bool setsBound = false;
+
+    if (alphaCount > 0) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, alphaPipe.GetPipeline());
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, alphaPipe.GetLayout(), 0, static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
+        setsBound = true;
+        vkCmdDraw(cmd, 6, alphaCount, 0, additiveCount);
+        ++counters.pipelineBinds;
+        ++counters.descriptorSetBinds;
+        counters.Draw(6, alphaCount);
+    }
+
+    if (additiveCount > 0) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, additivePipe.GetPipeline());
+        if (!setsBound) {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, additivePipe.GetLayout(), 0, static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
+            ++counters.descriptorSetBinds;
+        }
+        vkCmdDraw(cmd, 6, additiveCount, 0, 0);
+        ++counters.pipelineBinds;
+        counters.Draw(6, additiveCount);
+    }
+}
+
+void ParticlePass::Cleanup() {
+    for (uint32_t i = 0; i < instanceBuffers.size(); ++i) {
+        DestroyInstanceBuffer(i);
+    }
+    instanceBuffers.clear();
+    instanceBuffersMapped.clear();
+    instanceCapacity.clear();
+    additiveCounts.clear();
+    alphaCounts.clear();
+
+    if (vertexBuffer) {
+        vertexBuffer->Cleanup();
+        vertexBuffer.reset();
+    }
+
+    if (additivePipeline) {
+        additivePipeline->Cleanup();
+        additivePipeline.reset();
+    }
+    if (alphaPipeline) {
+        alphaPipeline->Cleanup();
+        alphaPipeline.reset();
+    }
+    DestroyLowResPipelines();
+
+    if (atlas) {
+        atlas->Cleanup();
+        atlas.reset();
+    }
+}
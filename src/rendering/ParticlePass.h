@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+#include "GraphicsPipeline.h"
+#include "ParticleAtlas.h"
+#include "ParticleSystem.h"
+#include "RenderSnapshot.h"
+#include "RenderStats.h"
+#include "../vulkan/VulkanBuffer.h"
+
+// Draws every particle system in the scene with two instanced draws:
+// one for additive particles and one back-to-front sorted draw for alpha-blended ones.
+class ParticlePass final {
+public:
+    ParticlePass(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPoolArg, VkQueue graphicsQueueArg);
+    ~ParticlePass();
+
+    // Non-copyable (explicitly declared)
+    ParticlePass(const ParticlePass&) = delete;
+    ParticlePass& operator=(const ParticlePass&) = delete;
+
+    // The pipelines are added to pipelines and exist once the batch has been created
+    void Initialize(VkRenderPass renderPass, const VkExtent2D& extent, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout textureSetLayout, uint32_t framesInFlightArg, PipelineBatch& pipelines);
+
+    // Uploads the snapshot's particle instances into this frame's instance buffer. Must run outside a render pass.
+    void Prepare(const RenderSnapshot& snapshot, uint32_t currentFrame);
+    // lowRes selects the pipelines built by CreateLowResPipelines
+    void Draw(VkCommandBuffer cmd, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet, RenderStats::Counters& counters, bool lowRes = false) const;
+    void Cleanup();
+
+    // Pipeline pair for LowResParticlePass. Same color blending, but destination alpha
+    // accumulates scene transmittance for the upsample composite.
+    void CreateLowResPipelines(VkRenderPass lowResRenderPass, PipelineBatch& pipelines);
+    void DestroyLowResPipelines();
+
+    const ParticleAtlas* GetAtlas() const { return atlas.get(); }
+
+private:
+    // Vulkan handles grouped together
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    VkCommandPool commandPool;
+    VkQueue graphicsQueue;
+
+    std::unique_ptr<GraphicsPipeline> additivePipeline;
+    std::unique_ptr<GraphicsPipeline> alphaPipeline;
+    std::unique_ptr<GraphicsPipeline> lowResAdditivePipeline;
+    std::unique_ptr<GraphicsPipeline> lowResAlphaPipeline;
+    std::unique_ptr<ParticleAtlas> atlas;
+    std::unique_ptr<VulkanBuffer> vertexBuffer;
+
+    // Per frame in flight: persistently mapped instance buffer holding [additive | alpha]
+    std::vector<std::unique_ptr<VulkanBuffer>> instanceBuffers;
+    std::vector<void*> instanceBuffersMapped;
+    std::vector<uint32_t> instanceCapacity;
+    std::vector<uint32_t> additiveCounts;
+    std::vector<uint32_t> alphaCounts;
+
+    // Kept for building the low-res pipelines later
+    VkExtent2D pipelineExtent{ 0, 0 };
+    VkDescriptorSetLayout globalLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout textureLayout = VK_NULL_HANDLE;
+
+    static constexpr uint32_t INITIAL_INSTANCE_CAPACITY = 8192;
+
+    void CreatePipelines(VkRenderPass renderPass, bool lowRes, std::unique_ptr<GraphicsPipeline>& additive, std::unique_ptr<GraphicsPipeline>& alpha, PipelineBatch& pipelines) const;
+    void CreateQuadBuffer();
+    void CreateInstanceBuffer(uint32_t frame, uint32_t capacity);
+    void DestroyInstanceBuffer(uint32_t frame);
+};
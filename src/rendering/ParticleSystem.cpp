@@ -1,119 +1,166 @@
 #include "ParticleSystem.h"
+#include "../core/AllocationTracker.h"
 #include <random>
 #include <algorithm> 
-#include <iostream>
 #include <array>
-#include <cstring> // for memcpy
-#include <stdexcept>
 
-// Helper for random numbers
-static float RandomFloat(float min, float max) {
-    static std::random_device rd;
-    static std::mt19937 mt(rd());
+// Fraction of the weather box (per axis) over which particles fade out near its faces
+static constexpr float WEATHER_FADE_BAND = 0.15f;
+
+// Helper for random numbers (each system owns its generator: systems update in parallel)
+static float RandomFloat(std::mt19937& mt, float min, float max) {
     std::uniform_real_distribution<float> dist(min, max);
     return dist(mt);
 }
 
-ParticleSystem::ParticleSystem(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPool, VkQueue graphicsQueue, uint32_t maxParticlesArg, uint32_t framesInFlightArg)
-    : device(deviceArg),
-    physicalDevice(physicalDeviceArg),
-    maxParticles(maxParticlesArg),
-    framesInFlight(framesInFlightArg),
-    poolIndex(maxParticlesArg > 0 ? maxParticlesArg - 1 : 0),
-    particles(maxParticlesArg),
-    texture(std::make_unique<Texture>(deviceArg, physicalDeviceArg, commandPool, graphicsQueue)) {
-    // Nothing left to assign in body; all members initialized above.
+ParticleSystem::ParticleSystem(const std::string& texturePathArg)
+    : texturePath(texturePathArg) {
+    // Storage is handed out by ParticleBudget on its next update.
 }
 
-ParticleSystem::~ParticleSystem() {
-    // Only destroy the descriptor pool if it was created.
-    if (descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        descriptorPool = VK_NULL_HANDLE;
-    }
+ParticleAtlas::Region ParticleSystem::ResolveRegion(const std::string& path) const {
+    return atlas ? atlas->GetRegion(path) : ParticleAtlas::Region{};
+}
 
-    texture.reset();
-    vertexBuffer.reset();
-    // Clear vector
-    instanceBuffers.clear();
+uint32_t ParticleSystem::GetFrameCount(const ParticleProps& props) {
+    if (!props.flipbookFrames.empty()) return static_cast<uint32_t>(props.flipbookFrames.size());
+    // Matches ParticleAtlas::GetSheetRegions, which returns the whole image for an empty grid
+    if (props.sheetColumns == 0 || props.sheetRows == 0) return 1;
+    return props.sheetColumns * props.sheetRows;
 }
 
-void ParticleSystem::Initialize(VkDescriptorSetLayout textureLayoutArg, GraphicsPipeline* pipelineArg, const std::string& texturePathArg, bool isAdditiveArg) {
-    texturePath = texturePathArg;
-    textureLayout = textureLayoutArg;
-    pipeline = pipelineArg;
-    isAdditive = isAdditiveArg;
-
-    texture->LoadFromFile(texturePath);
-    SetupBuffers();
-
-    // Pool & Set creation remains here because each system needs its own descriptor set (for its specific texture)
-    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
-    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
-    poolInfo.maxSets = 1;
-    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create particle descriptor pool!");
+void ParticleSystem::ResolveFrames(const ParticleEmitter& emitter) {
+    const ParticleProps& props = emitter.props;
+    ParticleAtlas::Region* const slots = frames.data() + emitter.frameOffset;
+    if (!props.flipbookFrames.empty()) {
+        for (uint32_t i = 0; i < emitter.frameCount; ++i) {
+            slots[i] = ResolveRegion(props.flipbookFrames[i]);
+        }
     }
-
-    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &textureLayout;
-    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
-        // Clean up pool if allocation failed to avoid leaving a dangling pool
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        descriptorPool = VK_NULL_HANDLE;
-        throw std::runtime_error("failed to allocate particle descriptor set!");
+    else if (emitter.frameCount > 1) {
+        if (atlas) {
+            const auto cells = atlas->GetSheetRegions(props.texturePath, props.sheetColumns, props.sheetRows);
+            std::copy(cells.begin(), cells.end(), slots);
+        }
+        else {
+            std::fill(slots, slots + emitter.frameCount, ParticleAtlas::Region{});
+        }
+    }
+    else {
+        slots[0] = ResolveRegion(props.texturePath);
     }
+}
 
-    VkDescriptorImageInfo imageInfo{};
-    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    imageInfo.imageView = texture->GetImageView();
-    imageInfo.sampler = texture->GetSampler();
-
-    VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-    write.dstSet = descriptorSet;
-    write.dstBinding = 0;
-    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    write.descriptorCount = 1;
-    write.pImageInfo = &imageInfo;
-    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+void ParticleSystem::SetAtlas(const ParticleAtlas* atlasArg) {
+    atlas = atlasArg;
+    // Slots don't depend on the atlas, so live particles' frame offsets stay valid
+    for (const ParticleEmitter& emitter : emitters) {
+        ResolveFrames(emitter);
+    }
 }
 
 void ParticleSystem::SetSimulationBounds(const glm::vec3& center, float radius) {
     boundsCenter = center;
     boundsRadius = radius;
     useBounds = true;
+
+    for (auto& emitter : emitters) {
+        UpdateEmitterBounds(emitter);
+    }
+}
+
+void ParticleSystem::SetWeatherVolume(const glm::vec3& halfExtent) {
+    viewerHalfExtent = glm::max(halfExtent, glm::vec3(0.01f));
+    volumeHalfExtent = viewerHalfExtent;
+    useWeatherVolume = true;
+
+    for (auto& emitter : emitters) {
+        UpdateEmitterBounds(emitter);
+    }
+}
+
+void ParticleSystem::SetViewerPosition(const glm::vec3& position) {
+    if (!useWeatherVolume) return;
+
+    // From outside the bounds a box around the viewer would be culled entirely, so the volume
+    // fills the bounds instead, as a regular bounded emitter would
+    if (useBounds && glm::distance(position, boundsCenter) > boundsRadius) {
+        volumeCenter = boundsCenter;
+        volumeHalfExtent = glm::vec3(boundsRadius);
+    }
+    else {
+        volumeCenter = position;
+        volumeHalfExtent = viewerHalfExtent;
+    }
+    for (auto& emitter : emitters) {
+        UpdateEmitterBounds(emitter);
+    }
 }
 
-void ParticleSystem::Emit(const ParticleProps& props) {
-    Particle& p = particles[poolIndex];
-    p.active = true;
+void ParticleSystem::AssignPool(Particle* poolArg, uint32_t capacityArg, uint32_t aliveArg) {
+    pool = poolArg;
+    capacity = capacityArg;
+    aliveCount = std::min(aliveArg, capacityArg);
+}
+
+void ParticleSystem::UpdateEmitterBounds(ParticleEmitter& emitter) const {
+    const ParticleProps& props = emitter.props;
+
+    // Weather particles never leave the box around the viewer
+    if (useWeatherVolume) {
+        emitter.lod.center = volumeCenter;
+        emitter.lod.radius = glm::length(volumeHalfExtent) + std::max(props.sizeBegin, props.sizeEnd);
+        return;
+    }
+
+    // Sphere around the spawn box plus the furthest a particle can travel in its lifetime
+    const glm::vec3 travel = props.velocity * props.lifeTime;
+    emitter.lod.center = props.position + travel * 0.5f;
+    emitter.lod.radius = glm::length(props.positionVariation)
+        + glm::length(props.velocityVariation) * props.lifeTime
+        + glm::length(travel) * 0.5f
+        + std::max(props.sizeBegin, props.sizeEnd);
+
+    // Bounded systems can never leave their simulation sphere
+    if (useBounds && emitter.lod.radius > boundsRadius) {
+        emitter.lod.center = boundsCenter;
+        emitter.lod.radius = boundsRadius;
+    }
+}
+
+void ParticleSystem::Emit(const ParticleEmitter& emitter) {
+    // Never overwrite live particles: when the slice is full the new particle is dropped
+    if (aliveCount >= capacity) {
+        droppedCount++;
+        return;
+    }
 
-    p.position.x = props.position.x + props.positionVariation.x * RandomFloat(-1.0f, 1.0f);
-    p.position.y = props.position.y + props.positionVariation.y * RandomFloat(-1.0f, 1.0f);
-    p.position.z = props.position.z + props.positionVariation.z * RandomFloat(-1.0f, 1.0f);
+    const ParticleProps& props = emitter.props;
+    Particle& p = pool[aliveCount++];
+    p.additive = props.isAdditive;
+
+    // Weather spawns anywhere in the volume; the emitter's own position is ignored
+    const glm::vec3 origin = useWeatherVolume ? volumeCenter : props.position;
+    const glm::vec3 variation = useWeatherVolume ? volumeHalfExtent : props.positionVariation;
+    p.position.x = origin.x + variation.x * RandomFloat(rng, -1.0f, 1.0f);
+    p.position.y = origin.y + variation.y * RandomFloat(rng, -1.0f, 1.0f);
+    p.position.z = origin.z + variation.z * RandomFloat(rng, -1.0f, 1.0f);
+    p.previousPosition = p.position;
 
     p.velocity = props.velocity;
-    p.velocity.x += props.velocityVariation.x * RandomFloat(-1.0f, 1.0f);
-    p.velocity.y += props.velocityVariation.y * RandomFloat(-1.0f, 1.0f);
-    p.velocity.z += props.velocityVariation.z * RandomFloat(-1.0f, 1.0f);
+    p.velocity.x += props.velocityVariation.x * RandomFloat(rng, -1.0f, 1.0f);
+    p.velocity.y += props.velocityVariation.y * RandomFloat(rng, -1.0f, 1.0f);
+    p.velocity.z += props.velocityVariation.z * RandomFloat(rng, -1.0f, 1.0f);
 
     p.colorBegin = props.colorBegin;
     p.colorEnd = props.colorEnd;
     p.lifeTime = props.lifeTime;
     p.lifeRemaining = props.lifeTime;
-    p.sizeBegin = props.sizeBegin + props.sizeVariation * RandomFloat(-1.0f, 1.0f);
+    p.sizeBegin = props.sizeBegin + props.sizeVariation * RandomFloat(rng, -1.0f, 1.0f);
     p.sizeEnd = props.sizeEnd;
-
-    if (poolIndex == 0) {
-        poolIndex = maxParticles - 1;
-    }
-    else {
-        poolIndex--;
-    }
+    p.frameOffset = emitter.frameOffset;
+    p.frameCount = emitter.frameCount;
+    p.frameRate = props.flipbookFps;
 }
 
 void ParticleSystem::AddEmitter(const ParticleProps& props, float particlesPerSecond) {
@@ -121,31 +168,61 @@ void ParticleSystem::AddEmitter(const ParticleProps& props, float particlesPerSe
     emitter.props = props;
     emitter.particlesPerSecond = particlesPerSecond;
     emitter.timeSinceLastEmit = 0.0f;
+
+    // Resolve the flipbook once so Emit only copies indices
+    emitter.frameOffset = static_cast<uint32_t>(frames.size());
+    emitter.frameCount = GetFrameCount(props);
+    frames.resize(frames.size() + emitter.frameCount);
+    ResolveFrames(emitter);
+
+    emitter.lod.priority = props.priority;
+    emitter.lod.steadyStateCount = particlesPerSecond * props.lifeTime;
+    UpdateEmitterBounds(emitter);
+
     emitters.push_back(emitter);
 }
 
 void ParticleSystem::Update(float dt) {
+    AllocationScope allocationScope("ParticleSystem::Update");
+
+    // Off-screen systems are frozen by ParticleBudget until they come back into view
+    if (paused) return;
+
     for (auto& emitter : emitters) {
-        emitter.timeSinceLastEmit += dt;
+        // LOD and budget scaling slow the emission clock instead of skipping emitters outright
+        emitter.timeSinceLastEmit += dt * emitter.lod.rateScale * emissionScale;
         const float emitInterval = 1.0f / emitter.particlesPerSecond;
         const float maxTime = 0.1f;
         if (emitter.timeSinceLastEmit > maxTime) emitter.timeSinceLastEmit = maxTime;
         while (emitter.timeSinceLastEmit >= emitInterval) {
-            Emit(emitter.props);
+            Emit(emitter);
             emitter.timeSinceLastEmit -= emitInterval;
         }
     }
-    for (auto& p : particles) {
-        if (!p.active) continue;
+
+    uint32_t i = 0;
+    while (i < aliveCount) {
+        Particle& p = pool[i];
         if (p.lifeRemaining <= 0.0f) {
-            p.active = false;
+            // Swap-remove keeps live particles packed at the front of the slice
+            p = pool[--aliveCount];
             continue;
         }
         p.lifeRemaining -= dt;
+        p.previousPosition = p.position;
         p.position += p.velocity * dt;
 
+        if (useWeatherVolume) {
+            // Toroidal wrap: anything leaving one face of the box re-enters from the opposite one.
+            // The previous position moves with it so interpolation doesn't streak across the box.
+            const glm::vec3 size = volumeHalfExtent * 2.0f;
+            const glm::vec3 offset = p.position - volumeCenter + volumeHalfExtent;
+            const glm::vec3 wrapped = volumeCenter - volumeHalfExtent + (offset - size * glm::floor(offset / size));
+            p.previousPosition += wrapped - p.position;
+            p.position = wrapped;
+        }
         // --- Clamping Logic ---
-        if (useBounds) {
+        else if (useBounds) {
             const float dist = glm::distance(p.position, boundsCenter);
             // If outside the radius, pull back to surface
             if (dist > boundsRadius) {
@@ -156,89 +233,68 @@ void ParticleSystem::Update(float dt) {
                 }
             }
         }
+        ++i;
     }
 }
 
-void ParticleSystem::UpdateInstanceBuffer(uint32_t currentFrame) {
-    std::vector<InstanceData> instanceData;
-    instanceData.reserve(maxParticles);
+void ParticleSystem::ReportStats(RenderStats::ParticleSystemStats& stats) const {
+    stats.name = &texturePath;
+    stats.liveParticles = aliveCount;
+    stats.capacity = capacity;
+    stats.paused = paused;
+}
 
-    for (const auto& p : particles) {
-        if (!p.active) continue;
+void ParticleSystem::AppendInstances(const glm::vec3& cameraPos, float interpolation, std::vector<InstanceData>& additive, std::vector<InstanceData>& alpha) const {
+    for (uint32_t i = 0; i < aliveCount; ++i) {
+        const Particle& p = pool[i];
+        const glm::vec3 position = glm::mix(p.previousPosition, p.position, interpolation);
+
+        // Weather: hide particles outside the simulation sphere and fade them out
+        // towards the box faces so wrapping doesn't pop
+        float volumeFade = 1.0f;
+        if (useWeatherVolume) {
+            if (useBounds && glm::distance(position, boundsCenter) > boundsRadius) continue;
+
+            const glm::vec3 edge = glm::abs(position - volumeCenter) / volumeHalfExtent;
+            const float maxEdge = std::max(edge.x, std::max(edge.y, edge.z));
+            volumeFade = glm::clamp((1.0f - maxEdge) / WEATHER_FADE_BAND, 0.0f, 1.0f);
+            if (volumeFade <= 0.0f) continue;
+        }
 
         const float lifeT = 1.0f - (p.lifeRemaining / p.lifeTime);
 
+        // Pick the flipbook frame: fixed rate loops, otherwise stretch over the lifetime
+        uint32_t frame = 0;
+        if (p.frameCount > 1) {
+            if (p.frameRate > 0.0f) {
+                const float age = p.lifeTime - p.lifeRemaining;
+                frame = static_cast<uint32_t>(age * p.frameRate) % p.frameCount;
+            }
+            else {
+                frame = std::min(static_cast<uint32_t>(lifeT * static_cast<float>(p.frameCount)), p.frameCount - 1);
+            }
+        }
+        const ParticleAtlas::Region& region = frames[p.frameOffset + frame];
+
         InstanceData data{}; // Zero initialize
 
-        // Explicitly convert vec3 -> vec4 (w=1.0)
-        data.position = glm::vec4(p.position, 1.0f);
+        const glm::vec3 toCamera = position - cameraPos;
+        data.position = glm::vec4(position, glm::dot(toCamera, toCamera));
 
         // Color is already vec4
         data.color = glm::mix(p.colorBegin, p.colorEnd, lifeT);
+        data.color.a *= volumeFade;
 
-        // Explicitly convert float -> vec4 (put size in x)
         const float currentSize = glm::mix(p.sizeBegin, p.sizeEnd, lifeT);
-        data.size = glm::vec4(currentSize, 0.0f, 0.0f, 0.0f);
+        data.size = glm::vec4(currentSize, region.layer, 0.0f, 0.0f);
+        data.uvRect = region.uvRect;
 
-        instanceData.push_back(data);
-    }
-
-    if (!instanceData.empty()) {
-        const VkDeviceSize size = static_cast<VkDeviceSize>(instanceData.size() * sizeof(InstanceData));
-        void* dataPtr = nullptr;
-        vkMapMemory(device, instanceBuffers[currentFrame]->GetBufferMemory(), 0, size, 0, &dataPtr);
-        std::memcpy(dataPtr, instanceData.data(), static_cast<size_t>(size));
-        vkUnmapMemory(device, instanceBuffers[currentFrame]->GetBufferMemory());
-    }
-}
-
-void ParticleSystem::Draw(VkCommandBuffer cmd, VkDescriptorSet globalDescriptorSet, uint32_t currentFrame) {
-    // Update the GPU buffer for THIS frame right before drawing
-    UpdateInstanceBuffer(currentFrame);
-
-    uint32_t activeCount = 0;
-    for (const auto& p : particles) if (p.active) activeCount++;
-
-    if (activeCount == 0 || !pipeline) return;
-
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetPipeline());
-
-    const std::array<VkDescriptorSet, 2> sets = { globalDescriptorSet, descriptorSet };
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetLayout(), 0, static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
-
-    const std::array<VkBuffer, 1> vertexBuffers = { vertexBuffer->GetBuffer() };
-    const std::array<VkDeviceSize, 1> offsets = { 0 };
-    vkCmdBindVertexBuffers(cmd, 0, static_cast<uint32_t>(vertexBuffers.size()), vertexBuffers.data(), offsets.data());
-
-    // Bind the Instance Buffer for the CURRENT frame
-    const std::array<VkBuffer, 1> instanceBufferRaw = { instanceBuffers[currentFrame]->GetBuffer() };
-    vkCmdBindVertexBuffers(cmd, 1, static_cast<uint32_t>(instanceBufferRaw.size()), instanceBufferRaw.data(), offsets.data());
-
-    vkCmdDraw(cmd, 6, activeCount, 0, 0);
-}
-
-void ParticleSystem::SetupBuffers() {
-    // x, y, z, u, v (6 vertices * 5 floats = 30 floats)
-    const std::array<float, 30> vertices = {
-        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
-         0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
-         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
-        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
-         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
-        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f
-    };
-
-    vertexBuffer = std::make_unique<VulkanBuffer>(device, physicalDevice);
-    vertexBuffer->CreateBuffer(sizeof(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vertexBuffer->CopyData(vertices.data(), sizeof(vertices));
-
-    instanceBuffers.resize(framesInFlight);
-    for (uint32_t i = 0; i < framesInFlight; ++i) {
-        instanceBuffers[i] = std::make_unique<VulkanBuffer>(device, physicalDevice);
-        instanceBuffers[i]->CreateBuffer(maxParticles * sizeof(InstanceData),
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (p.additive) {
+            additive.push_back(data);
+        }
+        else {
+            alpha.push_back(data);
+        }
     }
 }
 
@@ -259,8 +315,8 @@ std::array<VkVertexInputBindingDescription, 2> ParticleSystem::GetBindingDescrip
     return bindings;
 }
 
-std::array<VkVertexInputAttributeDescription, 5> ParticleSystem::GetAttributeDescriptions() {
-    std::array<VkVertexInputAttributeDescription, 5> attribs{};
+std::array<VkVertexInputAttributeDescription, 6> ParticleSystem::GetAttributeDescriptions() {
+    std::array<VkVertexInputAttributeDescription, 6> attribs{};
 
     // Binding 0: Mesh Data (Unchanged)
     // Location 0: Position (vec3)
@@ -276,8 +332,11 @@ std::array<VkVertexInputAttributeDescription, 5> ParticleSystem::GetAttributeDes
     // Location 3: Color (Host sends vec4, Shader reads vec4)
     attribs[3] = { 3, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, color) };
 
-    // Location 4: Size (Host sends vec4, Shader reads float. Uses x.)
+    // Location 4: Size + atlas layer (Host sends vec4, Shader reads vec2. Uses xy.)
     attribs[4] = { 4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, size) };
 
+    // Location 5: Atlas UV rect (vec4)
+    attribs[5] = { 5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, uvRect) };
+
     return attribs;
 }
\ No newline at end of file
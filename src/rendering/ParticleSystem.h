@@ -4,9 +4,10 @@
 #include <vector>
 #include <memory>
 #include <array>
-#include "GraphicsPipeline.h"
-#include "Texture.h"
-#include "../vulkan/VulkanBuffer.h"
+#include <random>
+#include <string>
+#include "ParticleAtlas.h"
+#include "RenderStats.h"
 
 struct ParticleProps {
     glm::vec3 position = glm::vec3(0.0f);
@@ -20,12 +21,25 @@ struct ParticleProps {
     float lifeTime = 1.0f;
     bool isAdditive = false;
     std::string texturePath;
+
+    // Flipbook animation. Frames come from flipbookFrames (one atlas layer each) or,
+    // if that is empty, from a sheetColumns x sheetRows grid cut out of texturePath.
+    std::vector<std::string> flipbookFrames;
+    uint32_t sheetColumns = 1;
+    uint32_t sheetRows = 1;
+    float flipbookFps = 0.0f; // 0 = play the sequence once over the particle's lifetime
+
+    // Relative importance when the global particle budget is oversubscribed
+    float priority = 1.0f;
 };
 
+// CPU-side particle simulation. Rendering is batched across all systems by ParticlePass.
+// Particle storage is a slice of the shared arena owned by ParticleBudget; live particles
+// are kept packed at the front of the slice.
 class ParticleSystem final {
 public:
-    ParticleSystem(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, VkCommandPool commandPool, VkQueue graphicsQueue, uint32_t maxParticlesArg, uint32_t framesInFlightArg);
-    ~ParticleSystem();
+    explicit ParticleSystem(const std::string& texturePathArg);
+    ~ParticleSystem() = default;
 
     // Non-copyable
     ParticleSystem(const ParticleSystem&) = delete;
@@ -35,85 +49,139 @@ public:
     ParticleSystem(ParticleSystem&&) noexcept = default;
     ParticleSystem& operator=(ParticleSystem&&) noexcept = default;
 
-    // Change: Added isAdditive parameter
-    void Initialize(VkDescriptorSetLayout textureLayoutArg, GraphicsPipeline* pipelineArg, const std::string& texturePathArg, bool isAdditiveArg);
+    struct Particle {
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 previousPosition = glm::vec3(0.0f); // Position before the last Update, for render interpolation
+        glm::vec3 velocity = glm::vec3(0.0f);
+        glm::vec4 colorBegin = glm::vec4(1.0f);
+        glm::vec4 colorEnd = glm::vec4(1.0f);
+        float sizeBegin = 0.0f;
+        float sizeEnd = 0.0f;
+        float lifeTime = 0.0f;
+        float lifeRemaining = 0.0f;
+        float frameRate = 0.0f;
+        uint32_t frameOffset = 0;
+        uint32_t frameCount = 1;
+        bool additive = false;
+    };
+
+    // Per-emitter scheduling data. Bounds and demand are filled in by AddEmitter;
+    // rateScale and visible are written each frame by ParticleBudget.
+    struct EmitterLod {
+        glm::vec3 center = glm::vec3(0.0f); // World-space sphere covering everything the emitter can reach
+        float radius = 0.0f;
+        float priority = 1.0f;
+        float steadyStateCount = 0.0f;      // particlesPerSecond * lifeTime at full rate
+        float rateScale = 1.0f;
+        bool visible = true;
+    };
+
+    // Atlas used to resolve emitter texture paths into layer/UV regions. Emitters added earlier are
+    // re-resolved against it, so a rebuilt atlas with a different layer order doesn't leave them stale.
+    void SetAtlas(const ParticleAtlas* atlasArg);
 
-    // Set constraints for particle movement
+    // Set constraints for particle movement. In weather mode particles outside the sphere
+    // are hidden instead of clamped, so the volume can follow the camera across the boundary.
     void SetSimulationBounds(const glm::vec3& center, float radius);
 
+    // Weather mode: emitters spawn inside a box of the given half extent centered on the
+    // viewer, and particles wrap toroidally as the viewer moves. Density near the camera is
+    // then independent of world size for a fixed particle count.
+    void SetWeatherVolume(const glm::vec3& halfExtent);
+    bool IsWeatherVolume() const { return useWeatherVolume; }
+
+    // Recenters the weather volume (no-op for regular systems). Outside the simulation bounds
+    // it covers the whole bounds sphere, so weather stays visible from outside.
+    void SetViewerPosition(const glm::vec3& position);
+
     void Update(float dt);
-    void Draw(VkCommandBuffer cmd, VkDescriptorSet globalDescriptorSet, uint32_t currentFrame);
 
-    void Emit(const ParticleProps& props);
     void AddEmitter(const ParticleProps& props, float particlesPerSecond);
 
-    std::string GetTexturePath() const { return texture ? texturePath : ""; }
+    // Emission draws from a generator owned by the system, so a seeded run emits the same
+    // particles whichever worker thread updates it
+    void SetRandomSeed(uint32_t seed) { rng.seed(seed); }
+
+    const std::string& GetTexturePath() const { return texturePath; }
+
+    // --- Budget / LOD hooks ---
+    size_t GetEmitterCount() const { return emitters.size(); }
+    EmitterLod& GetEmitterLod(size_t index) { return emitters[index].lod; }
+    const EmitterLod& GetEmitterLod(size_t index) const { return emitters[index].lod; }
 
-    void SetPipeline(GraphicsPipeline* newPipeline) { pipeline = newPipeline; }
-    bool IsAdditive() const { return isAdditive; }
+    void SetEmissionScale(float scale) { emissionScale = scale; }
+    void SetPaused(bool pausedArg) { paused = pausedArg; }
+    bool IsPaused() const { return paused; }
+
+    // Rebinds storage to a new arena slice. The first aliveArg entries of poolArg must hold live particles.
+    void AssignPool(Particle* poolArg, uint32_t capacityArg, uint32_t aliveArg);
+    const Particle* GetPool() const { return pool; }
+    uint32_t GetCapacity() const { return capacity; }
+    uint32_t GetAliveCount() const { return aliveCount; }
+    uint64_t GetDroppedCount() const { return droppedCount; }
+
+    // Fills everything but drawnParticles, which depends on the viewer
+    void ReportStats(RenderStats::ParticleSystemStats& stats) const;
 
     // Data sent to GPU per instance (Modified for 16-byte alignment)
     struct InstanceData {
-        glm::vec4 position; // xyz = position, w = padding (Offset 0)
+        glm::vec4 position; // xyz = position, w = squared camera distance (sort key) (Offset 0)
         glm::vec4 color;    // rgba (Offset 16)
-        glm::vec4 size;     // x = size, yzw = padding   (Offset 32)
+        glm::vec4 size;     // x = size, y = atlas layer, zw = padding   (Offset 32)
+        glm::vec4 uvRect;   // xy = atlas UV offset, zw = atlas UV scale (Offset 48)
     };
 
+    // Appends every live particle to the batch matching its blend mode. interpolation blends
+    // positions between the previous (0) and latest (1) Update.
+    void AppendInstances(const glm::vec3& cameraPos, float interpolation, std::vector<InstanceData>& additive, std::vector<InstanceData>& alpha) const;
+
     // Static helpers to describe vertex input for the shared pipeline
     static std::array<VkVertexInputBindingDescription, 2> GetBindingDescriptions();
-    static std::array<VkVertexInputAttributeDescription, 5> GetAttributeDescriptions();
+    static std::array<VkVertexInputAttributeDescription, 6> GetAttributeDescriptions();
 
 private:
-    struct Particle {
-        glm::vec3 position = glm::vec3(0.0f);
-        glm::vec3 velocity = glm::vec3(0.0f);
-        glm::vec4 colorBegin = glm::vec4(1.0f);
-        glm::vec4 colorEnd = glm::vec4(1.0f);
-        float sizeBegin = 0.0f;
-        float sizeEnd = 0.0f;
-        float lifeTime = 0.0f;
-        float lifeRemaining = 0.0f;
-        bool active = false;
-        float camDistance = -1.0f;
-    };
-
     struct ParticleEmitter {
         ParticleProps props;
         float particlesPerSecond = 0.0f;
         float timeSinceLastEmit = 0.0f;
+        uint32_t frameOffset = 0;
+        uint32_t frameCount = 1;
+        EmitterLod lod;
     };
 
-    // Device handles first for compact layout
-    VkDevice device;
-    VkPhysicalDevice physicalDevice;
-
-    // Small PODs next
-    uint32_t maxParticles;
-    uint32_t framesInFlight;
-    uint32_t poolIndex = 9999;
+    // Arena slice (owned by ParticleBudget)
+    Particle* pool = nullptr;
+    uint32_t capacity = 0;
+    uint32_t aliveCount = 0;
+    uint64_t droppedCount = 0;
 
     // Simulation state
     bool useBounds = false;
+    bool paused = false;
+    float emissionScale = 1.0f;
+    std::mt19937 rng{ std::random_device{}() };
     glm::vec3 boundsCenter = glm::vec3(0.0f);
     float boundsRadius = 0.0f;
 
+    // Weather volume
+    bool useWeatherVolume = false;
+    glm::vec3 volumeCenter = glm::vec3(0.0f);
+    glm::vec3 volumeHalfExtent = glm::vec3(0.0f);
+    glm::vec3 viewerHalfExtent = glm::vec3(0.0f); // As configured; the volume grows to the bounds when the viewer leaves them
+
     // Texture/meta
     std::string texturePath;
-    bool isAdditive = false;
+    const ParticleAtlas* atlas = nullptr;
 
-    // Dynamic collections and heap resources
-    std::vector<Particle> particles;
+    // Dynamic collections
     std::vector<ParticleEmitter> emitters;
-    std::vector<std::unique_ptr<VulkanBuffer>> instanceBuffers;
-    std::unique_ptr<Texture> texture;
-    std::unique_ptr<VulkanBuffer> vertexBuffer;
-
-    // Rendering resources
-    GraphicsPipeline* pipeline = nullptr;
-    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
-    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-    VkDescriptorSetLayout textureLayout = VK_NULL_HANDLE;
-
-    void SetupBuffers();
-    void UpdateInstanceBuffer(uint32_t currentFrame);
-};
\ No newline at end of file
+    std::vector<ParticleAtlas::Region> frames; // Flipbook frames referenced by emitters
+
+    void Emit(const ParticleEmitter& emitter);
+    void UpdateEmitterBounds(ParticleEmitter& emitter) const;
+    ParticleAtlas::Region ResolveRegion(const std::string& path) const;
+    // Frames an emitter occupies, from its props alone so a new atlas never moves them
+    static uint32_t GetFrameCount(const ParticleProps& props);
+    // Writes the emitter's frames into its slots in frames
+    void ResolveFrames(const ParticleEmitter& emitter);
+};
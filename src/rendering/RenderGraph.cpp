@@ -0,0 +1,598 @@
+#include "RenderGraph.h"
+#include "../vulkan/VulkanUtils.h"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    // Accesses a later use has to have made visible; reads only need the execution dependency
+    constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+        | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+
+    bool HasStencil(VkFormat format) {
+        return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT;
+    }
+
+    VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    double Megabytes(VkDeviceSize bytes) {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+RenderGraph::RenderGraph(VulkanDevice* deviceArg)
+    : device(deviceArg) {
+    if (device->SupportsSynchronization2()) {
+        cmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+            vkGetDeviceProcAddr(device->GetDevice(), "vkCmdPipelineBarrier2KHR"));
+    }
+}
+
+RenderGraph::~RenderGraph() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+RenderGraph::Access RenderGraph::GetAccess(Usage usage) {
+    switch (usage) {
+    case Usage::ColorAttachment:
+        return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    case Usage::DepthAttachment:
+        return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+    case Usage::DepthSampled:
+        return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+    case Usage::Sampled:
+        return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    case Usage::TransferSrc:
+        return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+    case Usage::TransferDst:
+        return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+    case Usage::Present:
+        // The stage the acquire semaphore is waited at, so the next frame's first use is ordered after it
+        return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+    }
+    throw std::runtime_error("unknown render graph usage!");
+}
+
+RenderGraph::ImageHandle RenderGraph::CreateImage(const char* name, const ImageDesc& desc) {
+    Image image;
+    image.name = name;
+    image.desc = desc;
+    image.barrierAspect = desc.aspect;
+    if ((desc.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) && HasStencil(desc.format)) {
+        image.barrierAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+    images.push_back(image);
+    return static_cast<ImageHandle>(images.size() - 1);
+}
+
+RenderGraph::ImageHandle RenderGraph::ImportImage(const char* name, VkFormat format, VkImageAspectFlags aspect) {
+    ImageDesc desc;
+    desc.format = format;
+    desc.aspect = aspect;
+
+    const ImageHandle handle = CreateImage(name, desc);
+    images[handle].imported = true;
+    return handle;
+}
+
+RenderGraph::PassHandle RenderGraph::AddPass(const char* name, ExecuteFn execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    return static_cast<PassHandle>(passes.size() - 1);
+}
+
+void RenderGraph::Use(PassHandle pass, ImageHandle image, Usage usage) {
+    passes[pass].uses.push_back({ image, usage });
+}
+
+void RenderGraph::SetOutput(ImageHandle image, Usage finalUsage) {
+    images[image].output = true;
+    images[image].finalUsage = finalUsage;
+}
+
+void RenderGraph::SetImportedImage(ImageHandle image, VkImage vkImage) {
+    images[image].image = vkImage;
+}
+
+void RenderGraph::Compile() {
+    CullPasses();
+    OrderPasses();
+    ComputeLifetimes();
+    CreateTransientImages();
+    BuildBarriers();
+    if (reported) return;
+    reported = true;
+
+    VkDeviceSize allocated = 0;
+    VkDeviceSize unaliased = 0;
+    for (const MemoryBlock& block : memoryBlocks) allocated += block.size;
+    for (const Image& image : images) unaliased += image.size;
+
+    std::cout << "Render graph: " << order.size() << " passes (" << passes.size() - order.size() << " culled), "
+        << barriers.size() << " barriers" << (cmdPipelineBarrier2 ? " (synchronization2)" : "")
+        << ", transient images in " << Megabytes(allocated) << " MB (" << Megabytes(unaliased) << " MB unaliased)" << std::endl;
+}
+
+void RenderGraph::CullPasses() {
+    // Backwards from the outputs: a pass is kept when something still needed reads an image it writes
+    std::vector<bool> needed(images.size(), false);
+    for (size_t i = 0; i < images.size(); ++i) {
+        needed[i] = images[i].output;
+    }
+
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        pass.culled = true;
+        for (const PassUse& use : pass.uses) {
+            if ((GetAccess(use.usage).access & WRITE_ACCESS) && needed[use.image]) {
+                pass.culled = false;
+            }
+        }
+        if (pass.culled) {
+            if (!reported) std::cout << "Render graph: culled " << pass.name << ", nothing reads what it writes" << std::endl;
+            continue;
+        }
+
+        for (const PassUse& use : pass.uses) {
+            if (GetAccess(use.usage).access & ~WRITE_ACCESS) {
+                needed[use.image] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::OrderPasses() {
+    // Edges follow declaration order: a pass depends on the last earlier writer of every image it uses,
+    // and a writer also on the readers since then. Any topological order keeps each pass's inputs.
+    std::vector<std::vector<PassHandle>> dependents(passes.size());
+    std::vector<std::vector<PassHandle>> producers(passes.size()); // Writers of what the pass reads
+    std::vector<uint32_t> pending(passes.size(), 0);
+    std::vector<PassHandle> lastWriter(images.size(), NOT_USED);
+    std::vector<std::vector<PassHandle>> readers(images.size());
+
+    const auto addEdge = [&](PassHandle from, PassHandle to) {
+        if (from == NOT_USED || from == to) return;
+        if (std::find(dependents[from].begin(), dependents[from].end(), to) != dependents[from].end()) return;
+        dependents[from].push_back(to);
+        ++pending[to];
+    };
+
+    for (PassHandle p = 0; p < passes.size(); ++p) {
+        if (passes[p].culled) continue;
+
+        for (const PassUse& use : passes[p].uses) {
+            const VkAccessFlags2 access = GetAccess(use.usage).access;
+            addEdge(lastWriter[use.image], p);
+            if ((access & ~WRITE_ACCESS) && lastWriter[use.image] != NOT_USED) {
+                producers[p].push_back(lastWriter[use.image]);
+            }
+            if (access & WRITE_ACCESS) {
+                for (const PassHandle reader : readers[use.image]) addEdge(reader, p);
+            }
+        }
+        for (const PassUse& use : passes[p].uses) {
+            if (GetAccess(use.usage).access & WRITE_ACCESS) {
+                lastWriter[use.image] = p;
+                readers[use.image].clear();
+            }
+            else if (lastWriter[use.image] != p) {
+                readers[use.image].push_back(p);
+            }
+        }
+    }
+
+    // Of the ready passes, run the one consuming the most recent output (keeping its inputs short-lived
+    // and in cache), then the one declared first
+    order.clear();
+    std::vector<uint32_t> position(passes.size(), NOT_USED);
+    std::vector<PassHandle> ready;
+    for (PassHandle p = 0; p < passes.size(); ++p) {
+        if (!passes[p].culled && pending[p] == 0) ready.push_back(p);
+    }
+
+    while (!ready.empty()) {
+        size_t best = 0;
+        uint32_t bestScore = 0;
+        for (size_t i = 0; i < ready.size(); ++i) {
+            uint32_t score = 0; // Position of the latest producer, plus one
+            for (const PassHandle producer : producers[ready[i]]) {
+                score = std::max(score, position[producer] + 1);
+            }
+            if (i == 0 || score > bestScore || (score == bestScore && ready[i] < ready[best])) {
+                best = i;
+                bestScore = score;
+            }
+        }
+
+        const PassHandle next = ready[best];
+        ready.erase(ready.begin() + static_cast<std::ptrdiff_t>(best));
+        position[next] = static_cast<uint32_t>(order.size());
+        order.push_back(next);
+
+        for (const PassHandle dependent : dependents[next]) {
+            if (--pending[dependent] == 0) ready.push_back(dependent);
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes() {
+    for (uint32_t position = 0; position < order.size(); ++position) {
+        for (const PassUse& use : passes[order[position]].uses) {
+            Image& image = images[use.image];
+            if (image.firstUse == NOT_USED) image.firstUse = position;
+            image.lastUse = position;
+        }
+    }
+}
+
+void RenderGraph::CreateTransientImages() {
+    std::vector<ImageHandle> transient;
+    std::vector<uint32_t> memoryTypes(images.size(), 0);
+    std::vector<VkDeviceSize> alignments(images.size(), 1);
+
+    for (ImageHandle handle = 0; handle < images.size(); ++handle) {
+        Image& image = images[handle];
+        if (image.imported) continue;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { image.desc.extent.width, image.desc.extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = image.desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = image.desc.usage;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(device->GetDevice(), &imageInfo, nullptr, &image.image) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create render graph image!");
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device->GetDevice(), image.image, &requirements);
+        image.size = requirements.size;
+        alignments[handle] = requirements.alignment;
+        memoryTypes[handle] = VulkanUtils::FindMemoryType(device->GetPhysicalDevice(), requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        transient.push_back(handle);
+    }
+
+    // Largest first, each at the lowest offset of its memory type's block that no image alive at the same time occupies
+    std::sort(transient.begin(), transient.end(), [this](ImageHandle a, ImageHandle b) { return images[a].size > images[b].size; });
+
+    std::vector<ImageHandle> placed;
+    for (const ImageHandle handle : transient) {
+        Image& image = images[handle];
+
+        const auto block = std::find_if(memoryBlocks.begin(), memoryBlocks.end(),
+            [&](const MemoryBlock& candidate) { return candidate.memoryType == memoryTypes[handle]; });
+        image.memoryBlock = static_cast<uint32_t>(block - memoryBlocks.begin());
+        if (block == memoryBlocks.end()) {
+            memoryBlocks.push_back({ memoryTypes[handle], 0, VK_NULL_HANDLE });
+        }
+
+        VkDeviceSize offset = 0;
+        for (bool moved = true; moved;) {
+            moved = false;
+            for (const ImageHandle other : placed) {
+                const Image& occupant = images[other];
+                if (occupant.memoryBlock != image.memoryBlock) continue;
+                if (!LifetimesOverlap(image, occupant) && !image.desc.persistent && !occupant.desc.persistent) continue;
+                if (offset < occupant.offset + occupant.size && occupant.offset < offset + image.size) {
+                    offset = AlignUp(occupant.offset + occupant.size, alignments[handle]);
+                    moved = true;
+                }
+            }
+        }
+
+        image.offset = offset;
+        memoryBlocks[image.memoryBlock].size = std::max(memoryBlocks[image.memoryBlock].size, offset + image.size);
+        placed.push_back(handle);
+    }
+
+    for (MemoryBlock& block : memoryBlocks) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = block.size;
+        allocInfo.memoryTypeIndex = block.memoryType;
+
+        if (vkAllocateMemory(device->GetDevice(), &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate render graph memory!");
+        }
+    }
+
+    for (const ImageHandle handle : transient) {
+        Image& image = images[handle];
+        vkBindImageMemory(device->GetDevice(), image.image, memoryBlocks[image.memoryBlock].memory, image.offset);
+        image.view = VulkanUtils::CreateImageView(device->GetDevice(), image.image, image.desc.format, image.desc.aspect);
+    }
+}
+
+void RenderGraph::BuildBarriers() {
+    barriers.clear();
+    legacyBarriers.clear();
+    barrierImages.clear();
+
+    // Everything each image is used for in a frame: its first use in the next frame waits on all of it
+    // and, for persistent images, starts from the layout it ended in
+    std::vector<VkPipelineStageFlags2> frameStages(images.size(), 0);
+    std::vector<VkAccessFlags2> frameWrites(images.size(), 0);
+    std::vector<VkImageLayout> frameLayouts(images.size(), VK_IMAGE_LAYOUT_UNDEFINED);
+    for (const PassHandle p : order) {
+        for (const PassUse& use : passes[p].uses) {
+            const Access access = GetAccess(use.usage);
+            frameStages[use.image] |= access.stages;
+            frameWrites[use.image] |= access.access & WRITE_ACCESS;
+            frameLayouts[use.image] = access.layout;
+        }
+    }
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!images[i].output) continue;
+        const Access finalAccess = GetAccess(images[i].finalUsage);
+        frameStages[i] |= finalAccess.stages;
+        frameLayouts[i] = finalAccess.layout;
+    }
+
+    struct State {
+        bool touched = false;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStages = 0;
+        VkAccessFlags2 writeAccess = 0;
+        VkPipelineStageFlags2 readStages = 0;    // Since the last write
+        VkPipelineStageFlags2 visibleStages = 0; // That the last write has been made visible to
+    };
+    std::vector<State> states(images.size());
+
+    const auto isFirstUse = [](const std::vector<PassUse>& uses, size_t index) {
+        for (size_t k = 0; k < index; ++k) {
+            if (uses[k].image == uses[index].image) return false;
+        }
+        return true;
+    };
+
+    for (const PassHandle p : order) {
+        Pass& pass = passes[p];
+        pass.barriers = BarrierBatch{};
+        pass.barriers.first = static_cast<uint32_t>(barriers.size());
+
+        // Into the state of each image's first use in the pass
+        for (size_t u = 0; u < pass.uses.size(); ++u) {
+            if (!isFirstUse(pass.uses, u)) continue;
+
+            const ImageHandle handle = pass.uses[u].image;
+            const Access entry = GetAccess(pass.uses[u].usage);
+            State& state = states[handle];
+
+            if (!state.touched && images[handle].desc.persistent) {
+                // Picks up where the previous frame left it
+                AddBarrier(pass.barriers, handle, frameStages[handle], frameWrites[handle], frameLayouts[handle], entry.stages, entry.access, entry.layout);
+                state.visibleStages = entry.stages;
+                continue;
+            }
+            if (!state.touched) {
+                // Discards the contents, after the previous frame's uses of the image and of any
+                // transient image sharing its memory
+                VkPipelineStageFlags2 srcStages = 0;
+                VkAccessFlags2 srcAccess = 0;
+                for (ImageHandle other = 0; other < images.size(); ++other) {
+                    if (other == handle || MemoryOverlaps(images[handle], images[other])) {
+                        srcStages |= frameStages[other];
+                        srcAccess |= frameWrites[other];
+                    }
+                }
+                AddBarrier(pass.barriers, handle, srcStages, srcAccess, VK_IMAGE_LAYOUT_UNDEFINED, entry.stages, entry.access, entry.layout);
+                state.visibleStages = entry.stages;
+                continue;
+            }
+
+            const bool writes = (entry.access & WRITE_ACCESS) != 0;
+            const bool newLayout = state.layout != entry.layout;
+            const bool unseenWrite = state.writeAccess != 0 && (entry.stages & ~state.visibleStages) != 0;
+            if (!writes && !newLayout && !unseenWrite) continue;
+
+            // Writes and layout changes also wait for the reads since the last write
+            const VkPipelineStageFlags2 srcStages = state.writeStages | ((writes || newLayout) ? state.readStages : 0);
+            AddBarrier(pass.barriers, handle, srcStages, state.writeAccess, state.layout, entry.stages, entry.access, entry.layout);
+            state.visibleStages = newLayout ? entry.stages : (state.visibleStages | entry.stages);
+        }
+
+        // Then the state the pass leaves each image in
+        for (size_t u = 0; u < pass.uses.size(); ++u) {
+            if (!isFirstUse(pass.uses, u)) continue;
+
+            const ImageHandle handle = pass.uses[u].image;
+            VkPipelineStageFlags2 writeStages = 0;
+            VkAccessFlags2 writeAccess = 0;
+            VkPipelineStageFlags2 readStages = 0;
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            for (size_t k = u; k < pass.uses.size(); ++k) {
+                if (pass.uses[k].image != handle) continue;
+
+                const Access access = GetAccess(pass.uses[k].usage);
+                if (access.access & WRITE_ACCESS) {
+                    writeStages |= access.stages;
+                    writeAccess |= access.access & WRITE_ACCESS;
+                }
+                if (access.access & ~WRITE_ACCESS) {
+                    readStages |= access.stages;
+                }
+                layout = access.layout;
+            }
+
+            State& state = states[handle];
+            if (writeAccess != 0) {
+                state.writeStages = writeStages;
+                state.writeAccess = writeAccess;
+                state.readStages = readStages;
+                state.visibleStages = 0;
+            }
+            else {
+                state.readStages |= readStages;
+            }
+            state.layout = layout;
+            state.touched = true;
+        }
+    }
+
+    // Outputs into their final usage. Nothing later in the submission touches them and its signal
+    // operation waits for the transition.
+    finalBarriers = BarrierBatch{};
+    finalBarriers.first = static_cast<uint32_t>(barriers.size());
+    for (ImageHandle handle = 0; handle < images.size(); ++handle) {
+        const State& state = states[handle];
+        if (!images[handle].output || !state.touched) continue;
+
+        const Access finalAccess = GetAccess(images[handle].finalUsage);
+        AddBarrier(finalBarriers, handle, state.writeStages | state.readStages, state.writeAccess, state.layout,
+            VK_PIPELINE_STAGE_2_NONE, 0, finalAccess.layout);
+    }
+
+    // Before their first frame, persistent images are put in the layout a frame leaves them in
+    initialBarriers = BarrierBatch{};
+    initialBarriers.first = static_cast<uint32_t>(barriers.size());
+    for (ImageHandle handle = 0; handle < images.size(); ++handle) {
+        if (!images[handle].desc.persistent || !states[handle].touched) continue;
+        AddBarrier(initialBarriers, handle, VK_PIPELINE_STAGE_2_NONE, 0, VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_PIPELINE_STAGE_2_NONE, 0, frameLayouts[handle]);
+    }
+    initialBarriersPending = initialBarriers.count > 0;
+}
+
+void RenderGraph::AddBarrier(BarrierBatch& batch, ImageHandle image, VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess,
+    VkImageLayout oldLayout, VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess, VkImageLayout newLayout) {
+    const Image& target = images[image];
+
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = dstStages;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target.image;
+    barrier.subresourceRange.aspectMask = target.barrierAspect;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    VkImageMemoryBarrier legacy{};
+    legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    legacy.srcAccessMask = static_cast<VkAccessFlags>(srcAccess);
+    legacy.dstAccessMask = static_cast<VkAccessFlags>(dstAccess);
+    legacy.oldLayout = oldLayout;
+    legacy.newLayout = newLayout;
+    legacy.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    legacy.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    legacy.image = target.image;
+    legacy.subresourceRange = barrier.subresourceRange;
+
+    barriers.push_back(barrier);
+    legacyBarriers.push_back(legacy);
+    barrierImages.push_back(image);
+
+    ++batch.count;
+    batch.srcStages |= static_cast<VkPipelineStageFlags>(srcStages);
+    batch.dstStages |= static_cast<VkPipelineStageFlags>(dstStages);
+}
+
+void RenderGraph::Execute(VkCommandBuffer cmd, uint32_t currentFrame) {
+    // Imported images may have been replaced since Compile
+    for (size_t i = 0; i < barrierImages.size(); ++i) {
+        const Image& image = images[barrierImages[i]];
+        if (!image.imported) continue;
+        barriers[i].image = image.image;
+        legacyBarriers[i].image = image.image;
+    }
+
+    if (initialBarriersPending) {
+        RecordBarriers(cmd, initialBarriers);
+        initialBarriersPending = false;
+    }
+
+    for (const PassHandle p : order) {
+        const Pass& pass = passes[p];
+        RecordBarriers(cmd, pass.barriers);
+        pass.execute(cmd, currentFrame);
+    }
+    RecordBarriers(cmd, finalBarriers);
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer cmd, const BarrierBatch& batch) const {
+    if (batch.count == 0) return;
+
+    if (cmdPipelineBarrier2) {
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.imageMemoryBarrierCount = batch.count;
+        dependencyInfo.pImageMemoryBarriers = barriers.data() + batch.first;
+        cmdPipelineBarrier2(cmd, &dependencyInfo);
+        return;
+    }
+
+    // Without synchronization2 an empty stage mask is not allowed
+    const VkPipelineStageFlags srcStages = batch.srcStages != 0 ? batch.srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    const VkPipelineStageFlags dstStages = batch.dstStages != 0 ? batch.dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, batch.count, legacyBarriers.data() + batch.first);
+}
+
+bool RenderGraph::LifetimesOverlap(const Image& a, const Image& b) const {
+    if (a.firstUse == NOT_USED || b.firstUse == NOT_USED) return false;
+    return a.firstUse <= b.lastUse && b.firstUse <= a.lastUse;
+}
+
+bool RenderGraph::MemoryOverlaps(const Image& a, const Image& b) const {
+    if (&a == &b || a.imported || b.imported || a.memoryBlock != b.memoryBlock) return false;
+    return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+void RenderGraph::Cleanup() {
+    for (Image& image : images) {
+        if (image.imported) continue;
+
+        if (image.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device->GetDevice(), image.view, nullptr);
+            image.view = VK_NULL_HANDLE;
+        }
+        if (image.image != VK_NULL_HANDLE) {
+            vkDestroyImage(device->GetDevice(), image.image, nullptr);
+            image.image = VK_NULL_HANDLE;
+        }
+    }
+    for (MemoryBlock& block : memoryBlocks) {
+        if (block.memory != VK_NULL_HANDLE) {
+            vkFreeMemory(device->GetDevice(), block.memory, nullptr);
+            block.memory = VK_NULL_HANDLE;
+        }
+    }
+
+    images.clear();
+    passes.clear();
+    order.clear();
+    memoryBlocks.clear();
+    barriers.clear();
+    legacyBarriers.clear();
+    barrierImages.clear();
+    finalBarriers = BarrierBatch{};
+    initialBarriers = BarrierBatch{};
+    initialBarriersPending = false;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../vulkan/VulkanDevice.h"
+
+// Frame graph over the renderer's passes. Every pass declares the images it touches and how, then Compile:
+//  1. culls passes whose results nothing consumes (outputs are consumed outside the graph),
+//  2. orders the rest by their dependencies, running a consumer right after its producer where it can,
+//  3. derives the barrier in front of each pass from the previous use of every image it touches, plus the
+//     ones that hand the outputs over at the end of the frame,
+//  4. creates the transient images, placing images whose lifetimes don't overlap in the same memory.
+// Barriers are recorded with synchronization2 when the device has it and vkCmdPipelineBarrier otherwise.
+// Passes, images and barriers only change when the graph is rebuilt (Cleanup, declare, Compile); Execute
+// allocates nothing.
+class RenderGraph final {
+public:
+    // How a pass touches an image. Each is the stage, access and layout the barrier in front of the pass
+    // produces. Attachment uses count as reads too: a render pass may load or blend over the contents.
+    enum class Usage : uint8_t {
+        ColorAttachment,
+        DepthAttachment,
+        DepthSampled, // Depth read by a fragment shader, in the read-only depth layout
+        Sampled,      // Read by a fragment shader
+        TransferSrc,
+        TransferDst,
+        Present,      // Handed to the presentation engine
+    };
+
+    using ImageHandle = uint32_t;
+    using PassHandle = uint32_t;
+    // currentFrame is the frame-in-flight slot Execute was called with
+    using ExecuteFn = std::function<void(VkCommandBuffer cmd, uint32_t currentFrame)>;
+
+    struct ImageDesc {
+        VkExtent2D extent{ 0, 0 };
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT; // Of the view; barriers add stencil for depth/stencil formats
+        // Keeps its contents from frame to frame (e.g. a target that isn't redrawn every frame): it never
+        // shares memory, and each frame starts from the state the previous one left it in
+        bool persistent = false;
+    };
+
+    explicit RenderGraph(VulkanDevice* deviceArg);
+    ~RenderGraph();
+
+    // Non-copyable
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // --- Declaration. Unless persistent, every image's contents are discarded at the start of each frame. ---
+
+    // Created by Compile and owned by the graph
+    ImageHandle CreateImage(const char* name, const ImageDesc& desc);
+    // Owned elsewhere. May be replaced between frames (one per swap chain image) with SetImportedImage.
+    ImageHandle ImportImage(const char* name, VkFormat format, VkImageAspectFlags aspect);
+    PassHandle AddPass(const char* name, ExecuteFn execute);
+    // The first use of an image in a pass is the state it must be in when the pass begins and the last is
+    // the state the pass leaves it in, for passes whose render passes transition attachments themselves
+    void Use(PassHandle pass, ImageHandle image, Usage usage);
+    // Consumed outside the graph: whatever produces it is kept, and it ends every frame in finalUsage
+    void SetOutput(ImageHandle image, Usage finalUsage);
+
+    void Compile();
+
+    // --- Per frame ---
+    void SetImportedImage(ImageHandle image, VkImage vkImage);
+    // Records every pass that survived culling, in order, with its barriers
+    void Execute(VkCommandBuffer cmd, uint32_t currentFrame);
+
+    // Destroys the transient images and forgets every pass and image. Nothing may still be using them.
+    void Cleanup();
+
+    VkImage GetImage(ImageHandle image) const { return images[image].image; }
+    VkImageView GetImageView(ImageHandle image) const { return images[image].view; } // Transient images only
+
+private:
+    struct Access {
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+        VkImageLayout layout;
+    };
+    // Only stage and access bits that exist in the original flags, so the fallback can narrow them
+    static Access GetAccess(Usage usage);
+
+    static constexpr uint32_t NOT_USED = UINT32_MAX;
+
+    struct Image {
+        const char* name = "";
+        ImageDesc desc;
+        bool imported = false;
+        bool output = false;
+        Usage finalUsage = Usage::Present;
+        VkImageAspectFlags barrierAspect = 0;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+
+        // Positions in the compiled order of the first and last pass that uses the image
+        uint32_t firstUse = NOT_USED;
+        uint32_t lastUse = NOT_USED;
+
+        // Placement of a transient image
+        uint32_t memoryBlock = 0;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+    };
+
+    struct PassUse {
+        ImageHandle image;
+        Usage usage;
+    };
+
+    // A run of barriers recorded together
+    struct BarrierBatch {
+        uint32_t first = 0;
+        uint32_t count = 0;
+        VkPipelineStageFlags srcStages = 0; // Unions for the vkCmdPipelineBarrier fallback
+        VkPipelineStageFlags dstStages = 0;
+    };
+
+    struct Pass {
+        const char* name = "";
+        ExecuteFn execute;
+        std::vector<PassUse> uses;
+        bool culled = false;
+        BarrierBatch barriers;
+    };
+
+    struct MemoryBlock {
+        uint32_t memoryType = 0;
+        VkDeviceSize size = 0;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+    };
+
+    VulkanDevice* device;
+    PFN_vkCmdPipelineBarrier2KHR cmdPipelineBarrier2 = nullptr; // Null without synchronization2
+
+    std::vector<Image> images;
+    std::vector<Pass> passes;
+    std::vector<PassHandle> order; // Surviving passes, in execution order
+    std::vector<MemoryBlock> memoryBlocks;
+
+    // Indexed by BarrierBatch::first; the image handles let Execute patch in the current imported images
+    std::vector<VkImageMemoryBarrier2> barriers;
+    std::vector<VkImageMemoryBarrier> legacyBarriers;
+    std::vector<ImageHandle> barrierImages;
+    BarrierBatch finalBarriers; // Outputs into their final usage
+    BarrierBatch initialBarriers; // Persistent images out of UNDEFINED, recorded by the first Execute only
+    bool initialBarriersPending = false;
+    // Compile reports the graph the first time only; the rebuild on every resize would repeat it
+    bool reported = false;
+
+    void CullPasses();
+    void OrderPasses();
+    void ComputeLifetimes();
+    void CreateTransientImages();
+    void BuildBarriers();
+
+    void AddBarrier(BarrierBatch& batch, ImageHandle image, VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess,
+        VkImageLayout oldLayout, VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess, VkImageLayout newLayout);
+    void RecordBarriers(VkCommandBuffer cmd, const BarrierBatch& batch) const;
+
+    bool LifetimesOverlap(const Image& a, const Image& b) const;
+    bool MemoryOverlaps(const Image& a, const Image& b) const;
+};
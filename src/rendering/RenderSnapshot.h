@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../geometry/Geometry.h"
+#include "../vulkan/UniformBufferObject.h"
+#include "ParticleSystem.h"
+#include "RenderStats.h"
+
+// Everything the renderer needs to draw one simulated frame, copied out of the Scene by
+// Scene::BuildSnapshot. Once published it is immutable, so the renderer can record it while
+// the simulation is already working on the next one.
+struct RenderSnapshot {
+    struct Object {
+        const Geometry* geometry = nullptr;     // GPU buffers are immutable, owned by the Scene
+        const std::string* texturePath = nullptr;
+        const std::string* name = nullptr;
+        glm::mat4 transform = glm::mat4(1.0f);
+        glm::vec3 localBoundsCenter = glm::vec3(0.0f);
+        float localBoundsRadius = 0.0f;
+        int shadingMode = 1;
+        int layerMask = 0;
+        bool castsShadow = true;
+        bool receiveShadows = true;
+    };
+
+    // Camera the frame was simulated for
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 proj = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    int layerMask = 0;             // SceneLayers the camera sees
+
+    std::vector<Object> objects;   // Visible objects only, in scene order
+    std::vector<Light> lights;
+
+    // Particle instances, alpha already sorted back to front
+    std::vector<ParticleSystem::InstanceData> additiveParticles;
+    std::vector<ParticleSystem::InstanceData> alphaParticles;
+    std::vector<RenderStats::ParticleSystemStats> particleSystems; // Live and drawn counts per system
+
+    uint64_t frameIndex = 0;
+};
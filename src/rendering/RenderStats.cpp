@@ -0,0 +1,261 @@
+#include "RenderStats.h"
+#include "../geometry/Geometry.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    // 1234567 -> "1.23M", keeps the overlay line short
+    std::string Abbreviate(uint64_t value) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2);
+        if (value >= 1000000000ull) text << static_cast<double>(value) / 1e9 << "G";
+        else if (value >= 1000000ull) text << static_cast<double>(value) / 1e6 << "M";
+        else if (value >= 10000ull) text << static_cast<double>(value) / 1e3 << "k";
+        else text << value;
+        return text.str();
+    }
+}
+
+void RenderStats::Counters::Draw(uint32_t vertexCount, uint32_t instanceCount) {
+    ++drawCalls;
+    if (instanceCount > 1) ++instancedDraws;
+    instances += instanceCount;
+    vertices += static_cast<uint64_t>(vertexCount) * instanceCount;
+    triangles += static_cast<uint64_t>(vertexCount / 3) * instanceCount;
+}
+
+void RenderStats::Counters::GeometryDraw(const Geometry& geometry) {
+    bufferBinds += geometry.HasIndices() ? 2 : 1;
+    Draw(static_cast<uint32_t>(geometry.HasIndices() ? geometry.IndexCount() : geometry.VertexCount()));
+}
+
+void RenderStats::Counters::Add(const Counters& other) {
+    drawCalls += other.drawCalls;
+    instancedDraws += other.instancedDraws;
+    instances += other.instances;
+    vertices += other.vertices;
+    triangles += other.triangles;
+    pipelineBinds += other.pipelineBinds;
+    descriptorSetBinds += other.descriptorSetBinds;
+    pushConstants += other.pushConstants;
+    bufferBinds += other.bufferBinds;
+}
+
+RenderStats::Counters RenderStats::FrameStats::TotalCommands() const {
+    Counters total;
+    for (const auto& pass : passes) {
+        total.Add(pass.commands);
+    }
+    return total;
+}
+
+RenderStats::RenderStats(VkDevice deviceArg, uint32_t framesInFlightArg)
+    : device(deviceArg), framesInFlight(framesInFlightArg), slots(framesInFlightArg) {
+    queryResults.resize(static_cast<size_t>(STATISTIC_COUNT + 1) * PASS_COUNT);
+}
+
+RenderStats::~RenderStats() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void RenderStats::Initialize(const VkPhysicalDeviceFeatures& enabledFeatures) {
+    if (enabledFeatures.pipelineStatisticsQuery != VK_TRUE || enabledFeatures.inheritedQueries != VK_TRUE) {
+        std::cerr << "Warning: pipeline statistics queries unavailable, render stats will only count commands" << std::endl;
+        return;
+    }
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    poolInfo.queryCount = framesInFlight * static_cast<uint32_t>(PASS_COUNT);
+    poolInfo.pipelineStatistics = STATISTICS;
+
+    if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline statistics query pool!");
+    }
+}
+
+void RenderStats::Cleanup() {
+    if (queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+    }
+
+    // Their queries went with the pool
+    for (auto& slot : slots) {
+        slot.passesBegun = 0;
+    }
+    latestPipeline = {};
+    frameActive = false;
+    queriesActive = false;
+}
+
+void RenderStats::BeginFrame(VkCommandBuffer cmd, uint32_t frame, uint64_t frameIndex) {
+    currentSlot = frame;
+    if (slots[frame].passesBegun != 0) {
+        Resolve(frame);
+        slots[frame].passesBegun = 0;
+    }
+
+    frameActive = enabled;
+    queriesActive = enabled && queryPool != VK_NULL_HANDLE;
+    if (!frameActive) return;
+
+    current.frameIndex = frameIndex;
+    for (auto& pass : current.passes) {
+        pass = PassStats{};
+    }
+    current.particleSystems.clear();
+
+    if (queriesActive) {
+        vkCmdResetQueryPool(cmd, queryPool, Query(frame, Pass::Shadow), static_cast<uint32_t>(PASS_COUNT));
+    }
+}
+
+void RenderStats::EndFrame() {
+    if (!frameActive) return;
+
+    for (size_t i = 0; i < PASS_COUNT; ++i) {
+        current.passes[i].pipeline = latestPipeline[i];
+    }
+    // Element-wise copy so the published vectors keep their capacity
+    published.frameIndex = current.frameIndex;
+    published.passes = current.passes;
+    published.particleSystems.assign(current.particleSystems.begin(), current.particleSystems.end());
+}
+
+void RenderStats::BeginPass(VkCommandBuffer cmd, Pass pass) {
+    if (!queriesActive) return;
+    vkCmdBeginQuery(cmd, queryPool, Query(currentSlot, pass), 0);
+    slots[currentSlot].passesBegun |= 1u << static_cast<uint32_t>(pass);
+}
+
+void RenderStats::EndPass(VkCommandBuffer cmd, Pass pass) {
+    if (!queriesActive) return;
+    vkCmdEndQuery(cmd, queryPool, Query(currentSlot, pass));
+}
+
+void RenderStats::AddCounters(Pass pass, const Counters& counters) {
+    if (!frameActive) return;
+    std::lock_guard<std::mutex> lock(countersMutex);
+    current.passes[static_cast<size_t>(pass)].commands.Add(counters);
+}
+
+void RenderStats::SetObjectCounts(Pass pass, uint32_t drawn, uint32_t culled) {
+    if (!frameActive) return;
+    PassStats& stats = current.passes[static_cast<size_t>(pass)];
+    stats.objectsDrawn = drawn;
+    stats.objectsCulled = culled;
+}
+
+void RenderStats::SetParticleSystems(const std::vector<ParticleSystemStats>& systems) {
+    if (!frameActive) return;
+    current.particleSystems.assign(systems.begin(), systems.end());
+}
+
+const char* RenderStats::GetPassName(Pass pass) {
+    static constexpr const char* NAMES[PASS_COUNT] = { "Shadow", "Refraction", "Main", "LowResParticles" };
+    return NAMES[static_cast<size_t>(pass)];
+}
+
+void RenderStats::Resolve(uint32_t slotIndex) {
+    if (queryPool == VK_NULL_HANDLE) return;
+
+    // Never waits: the slot's fence has signalled, and anything still unavailable is skipped
+    const VkDeviceSize stride = sizeof(uint64_t) * (STATISTIC_COUNT + 1);
+    const VkResult result = vkGetQueryPoolResults(device, queryPool, Query(slotIndex, Pass::Shadow), static_cast<uint32_t>(PASS_COUNT),
+        queryResults.size() * sizeof(uint64_t), queryResults.data(), stride,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+    for (size_t i = 0; i < PASS_COUNT; ++i) {
+        PipelineCounters& counters = latestPipeline[i];
+        const uint64_t* values = &queryResults[i * (STATISTIC_COUNT + 1)];
+        if ((slots[slotIndex].passesBegun & (1u << i)) == 0 || values[STATISTIC_COUNT] == 0) {
+            counters.valid = false;
+            continue;
+        }
+
+        counters.vertexInvocations = values[0];
+        counters.clippingInvocations = values[1];
+        counters.clippingPrimitives = values[2];
+        counters.fragmentInvocations = values[3];
+        counters.valid = true;
+    }
+}
+
+std::string RenderStats::GetSummary() const {
+    const FrameStats& frame = published;
+    const Counters total = frame.TotalCommands();
+
+    uint32_t drawn = 0;
+    uint32_t culled = 0;
+    PipelineCounters pipeline;
+    for (const auto& pass : frame.passes) {
+        drawn += pass.objectsDrawn;
+        culled += pass.objectsCulled;
+        if (!pass.pipeline.valid) continue;
+        pipeline.vertexInvocations += pass.pipeline.vertexInvocations;
+        pipeline.fragmentInvocations += pass.pipeline.fragmentInvocations;
+        pipeline.valid = true;
+    }
+
+    uint64_t particles = 0;
+    for (const auto& system : frame.particleSystems) {
+        particles += system.liveParticles;
+    }
+
+    std::ostringstream summary;
+    summary << "Draws " << total.drawCalls << " (" << total.instancedDraws << " inst)"
+        << " | Tris " << Abbreviate(total.triangles)
+        << " | Binds P" << total.pipelineBinds << " D" << total.descriptorSetBinds << " B" << total.bufferBinds
+        << " | Push " << total.pushConstants
+        << " | Objects " << drawn << "/" << culled << " culled"
+        << " | Particles " << Abbreviate(particles);
+    if (pipeline.valid) {
+        summary << " | VS " << Abbreviate(pipeline.vertexInvocations) << " FS " << Abbreviate(pipeline.fragmentInvocations);
+    }
+    return summary.str();
+}
+
+std::string RenderStats::GetReport() const {
+    const FrameStats& frame = published;
+
+    std::ostringstream report;
+    report << "Render stats, frame " << frame.frameIndex << "\n";
+    report << std::left << std::setw(16) << "pass" << std::right
+        << std::setw(8) << "draws" << std::setw(8) << "inst" << std::setw(12) << "vertices" << std::setw(12) << "triangles"
+        << std::setw(7) << "pipe" << std::setw(7) << "sets" << std::setw(7) << "push" << std::setw(7) << "bufs"
+        << std::setw(8) << "drawn" << std::setw(8) << "culled"
+        << std::setw(12) << "vs inv" << std::setw(12) << "clip in" << std::setw(12) << "clip out" << std::setw(12) << "fs inv" << "\n";
+
+    for (size_t i = 0; i < PASS_COUNT; ++i) {
+        const PassStats& pass = frame.passes[i];
+        const Counters& c = pass.commands;
+        report << std::left << std::setw(16) << GetPassName(static_cast<Pass>(i)) << std::right
+            << std::setw(8) << c.drawCalls << std::setw(8) << c.instancedDraws << std::setw(12) << c.vertices << std::setw(12) << c.triangles
+            << std::setw(7) << c.pipelineBinds << std::setw(7) << c.descriptorSetBinds << std::setw(7) << c.pushConstants << std::setw(7) << c.bufferBinds
+            << std::setw(8) << pass.objectsDrawn << std::setw(8) << pass.objectsCulled;
+        if (pass.pipeline.valid) {
+            report << std::setw(12) << pass.pipeline.vertexInvocations << std::setw(12) << pass.pipeline.clippingInvocations
+                << std::setw(12) << pass.pipeline.clippingPrimitives << std::setw(12) << pass.pipeline.fragmentInvocations;
+        }
+        else {
+            report << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-";
+        }
+        report << "\n";
+    }
+
+    for (const auto& system : frame.particleSystems) {
+        report << "  particles " << *system.name << ": " << system.liveParticles << " live, " << system.drawnParticles << " drawn, "
+            << system.capacity << " capacity" << (system.paused ? " (paused)" : "") << "\n";
+    }
+    return report.str();
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Geometry;
+
+// Per-frame counts of what the renderer submitted, per pass, so the effect of an optimization
+// shows up as numbers. Command counters are filled in while recording (cheap enough to always
+// run) and merged when stats are enabled. Where the device allows it, a pipeline statistics
+// query per pass adds what the GPU actually processed; those arrive a few frames late, once
+// the frame slot comes round again.
+class RenderStats final {
+public:
+    enum class Pass : uint32_t { Shadow, Refraction, Main, LowResParticles };
+    static constexpr size_t PASS_COUNT = 4;
+
+    // Commands recorded into one command buffer. Plain counters: every recording thread keeps its own.
+    struct Counters {
+        uint64_t drawCalls = 0;
+        uint64_t instancedDraws = 0;     // Draws with more than one instance
+        uint64_t instances = 0;
+        uint64_t vertices = 0;           // Vertices (or indices) submitted, times instances
+        uint64_t triangles = 0;
+        uint64_t pipelineBinds = 0;
+        uint64_t descriptorSetBinds = 0; // vkCmdBindDescriptorSets calls
+        uint64_t pushConstants = 0;
+        uint64_t bufferBinds = 0;        // Vertex and index buffer bind calls
+
+        void Draw(uint32_t vertexCount, uint32_t instanceCount = 1);
+        // Geometry::Bind followed by Geometry::Draw
+        void GeometryDraw(const Geometry& geometry);
+        void Add(const Counters& other);
+    };
+
+    struct PipelineCounters {
+        uint64_t vertexInvocations = 0;
+        uint64_t clippingInvocations = 0; // Primitives entering the clipper
+        uint64_t clippingPrimitives = 0;  // Primitives leaving it
+        uint64_t fragmentInvocations = 0;
+        bool valid = false;
+    };
+
+    struct PassStats {
+        Counters commands;
+        uint32_t objectsDrawn = 0;
+        uint32_t objectsCulled = 0;      // Eligible for the pass but outside its frustum
+        PipelineCounters pipeline;       // From an earlier frame, see GetFrameStats
+    };
+
+    struct ParticleSystemStats {
+        const std::string* name = nullptr;
+        uint32_t liveParticles = 0;
+        uint32_t drawnParticles = 0;
+        uint32_t capacity = 0;
+        bool paused = false;
+    };
+
+    struct FrameStats {
+        uint64_t frameIndex = 0;
+        std::array<PassStats, PASS_COUNT> passes;
+        std::vector<ParticleSystemStats> particleSystems;
+
+        Counters TotalCommands() const;
+    };
+
+    RenderStats(VkDevice deviceArg, uint32_t framesInFlightArg);
+    ~RenderStats();
+
+    // Non-copyable
+    RenderStats(const RenderStats&) = delete;
+    RenderStats& operator=(const RenderStats&) = delete;
+
+    // Creates the pipeline statistics query pool when the device enabled pipelineStatisticsQuery
+    // and inheritedQueries (the passes execute secondary buffers while a query is active)
+    void Initialize(const VkPhysicalDeviceFeatures& enabledFeatures);
+    // Destroys the query pool. The last frame's stats survive, so Initialize can follow a resize.
+    void Cleanup();
+
+    void SetEnabled(bool enabledArg) { enabled = enabledArg; }
+    bool IsEnabled() const { return enabled; }
+    bool HasPipelineStatistics() const { return queryPool != VK_NULL_HANDLE; }
+
+    // BeginFrame reads back the pipeline statistics this slot recorded last time round and resets
+    // its queries; it must be recorded outside any render pass. EndFrame publishes the frame.
+    void BeginFrame(VkCommandBuffer cmd, uint32_t frame, uint64_t frameIndex);
+    void EndFrame();
+
+    // Recorded around a pass's render pass, in the primary buffer
+    void BeginPass(VkCommandBuffer cmd, Pass pass);
+    void EndPass(VkCommandBuffer cmd, Pass pass);
+    // For the inheritance info of secondaries executed inside BeginPass/EndPass
+    VkQueryPipelineStatisticFlags GetInheritedStatistics() const { return queriesActive ? STATISTICS : 0; }
+
+    // Thread-safe: every recording task adds its own counters
+    void AddCounters(Pass pass, const Counters& counters);
+    void SetObjectCounts(Pass pass, uint32_t drawn, uint32_t culled);
+    void SetParticleSystems(const std::vector<ParticleSystemStats>& systems);
+
+    // The last completed frame. Pipeline counters belong to the newest frame read back, framesInFlight earlier.
+    const FrameStats& GetFrameStats() const { return published; }
+    static const char* GetPassName(Pass pass);
+
+    // One line for the overlay, and a per-pass table for the console
+    std::string GetSummary() const;
+    std::string GetReport() const;
+
+private:
+    struct FrameSlot {
+        uint32_t passesBegun = 0; // Bit per Pass with a query recorded
+    };
+
+    VkDevice device;
+    uint32_t framesInFlight;
+
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    bool enabled = false;
+    bool frameActive = false;     // Enabled when the frame began
+    bool queriesActive = false;   // frameActive and the pool exists
+    uint32_t currentSlot = 0;
+
+    std::vector<FrameSlot> slots;
+    std::vector<uint64_t> queryResults; // Sized once
+    std::array<PipelineCounters, PASS_COUNT> latestPipeline;
+
+    std::mutex countersMutex;     // Guards current.passes[].commands
+    FrameStats current;
+    FrameStats published;
+
+    // Results come back in bit order: vertex shader, clipping in, clipping out, fragment shader
+    static constexpr VkQueryPipelineStatisticFlags STATISTICS =
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    static constexpr uint32_t STATISTIC_COUNT = 4;
+
+    uint32_t Query(uint32_t slot, Pass pass) const { return slot * static_cast<uint32_t>(PASS_COUNT) + static_cast<uint32_t>(pass); }
+    void Resolve(uint32_t slotIndex);
+};
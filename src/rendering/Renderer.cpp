@@ -3,45 +3,37 @@
 #include "Renderer.h"
 #include "../vulkan/Vertex.h"
 #include "../vulkan/VulkanUtils.h"
+#include "../core/JobSystem.h"
+#include "../core/AllocationTracker.h"
+#include "../core/CpuProfiler.h"
+#include "../core/HitchDetector.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <stdexcept>
 #include <iostream>
 #include <array>
+#include <algorithm>
 
 Renderer::Renderer(VulkanDevice* deviceArg, VulkanSwapChain* swapChainArg)
     : device(deviceArg), swapChain(swapChainArg) {
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        frameArenas.push_back(std::make_unique<FrameArena>());
+    }
+    gpuProfiler = std::make_unique<GpuProfiler>(device->GetDevice(), device->GetPhysicalDevice(), MAX_FRAMES_IN_FLIGHT);
+    renderStats = std::make_unique<RenderStats>(device->GetDevice(), MAX_FRAMES_IN_FLIGHT);
 }
 
 void Renderer::Initialize() {
-    CreateRenderPass();
+    // Passes only describe their pipelines; they all compile together at the end
+    PipelineBatch pipelines(pipelineCache);
 
-    // 1. Main Offscreen Framebuffer (Color + Depth)
-    CreateOffScreenResources();
-    renderPass->CreateOffScreenFramebuffer(offScreenImageView, depthImageView, swapChain->GetExtent());
-
-    // 2. Refraction Framebuffer
-    {
-        const std::array<VkImageView, 2> attachments = {
-            refractionImageView,
-            depthImageView // Reuse depth buffer
-        };
-
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = renderPass->GetRenderPass();
-        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        framebufferInfo.pAttachments = attachments.data();
-        framebufferInfo.width = swapChain->GetExtent().width;
-        framebufferInfo.height = swapChain->GetExtent().height;
-        framebufferInfo.layers = 1;
-
-        if (vkCreateFramebuffer(device->GetDevice(), &framebufferInfo, nullptr, &refractionFramebuffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create refraction framebuffer!");
-        }
-    }
+    CreateRenderPass();
+    CreateRefractionSampler();
+    renderGraph = std::make_unique<RenderGraph>(device);
 
     CreateUniformBuffers();
     CreateCommandBuffer();
+    gpuProfiler->Initialize(device->GetQueueFamilies().graphicsFamily.value());
+    renderStats->Initialize(device->GetEnabledFeatures());
 
     CreateTextureDescriptorSetLayout();
     CreateTextureDescriptorPool();
@@ -56,9 +48,16 @@ void Renderer::Initialize() {
         device->GetDevice(), device->GetPhysicalDevice(),
         commandBuffer->GetCommandPool(), device->GetGraphicsQueue()
     );
-    skyboxPass->Initialize(renderPass->GetRenderPass(), swapChain->GetExtent(), descriptorSet->GetLayout());
+    skyboxPass->Initialize(renderPass->GetRenderPass(), swapChain->GetExtent(), descriptorSet->GetLayout(), pipelines);
+
+    CreateShadowPass(pipelines);
 
-    CreateShadowPass();
+    // --- Create Shared Particle Pass ---
+    CreateParticlePass(pipelines);
+    CreateLowResParticlePass(pipelines);
+
+    // Every pass exists now, so the frame can be declared and its targets created
+    BuildRenderGraph();
 
     // Create Descriptor Sets
     descriptorSet->CreateDescriptorPool(MAX_FRAMES_IN_FLIGHT);
@@ -71,32 +70,52 @@ void Renderer::Initialize() {
         sizeof(UniformBufferObject),
         shadowPass->GetShadowImageView(),
         shadowPass->GetShadowSampler(),
-        refractionImageView,
+        renderGraph->GetImageView(refractionTarget),
         refractionSampler
     );
 
-    // --- Create Shared Particle Pipelines ---
-    CreateParticlePipelines();
-
-    CreatePipeline(); // Main scene object pipeline
+    CreatePipeline(pipelines); // Main scene object pipeline
+    // Only the startup batch is reported; later rebuilds show up in the profiler under PipelineBatch::Create
+    const double pipelineMilliseconds = pipelines.Create(jobSystem);
+    std::cout << "Pipelines: created in " << pipelineMilliseconds << " ms" << std::endl;
     CreateSyncObjects();
 }
 
-void Renderer::DrawFrame(Scene& scene, uint32_t currentFrame, const glm::mat4& viewMatrix, const glm::mat4& projMatrix, int layerMask) {
+void Renderer::DrawFrame(const RenderSnapshot& snapshot, uint32_t currentFrame) {
+    ProfileScope profileScope("Renderer::DrawFrame");
+
     // Wait for this frame's fence
     const VkFence fence = syncObjects->GetInFlightFence(currentFrame);
-    vkWaitForFences(device->GetDevice(), 1, &fence, VK_TRUE, UINT64_MAX);
+    {
+        ProfileScope waitScope("WaitForFence");
+        HitchScope hitchScope(HitchDetector::Category::FenceWait, "WaitForFence");
+        vkWaitForFences(device->GetDevice(), 1, &fence, VK_TRUE, UINT64_MAX);
+    }
 
-    // Acquire next image
-    uint32_t imageIndex;
-    const VkResult result = vkAcquireNextImageKHR(
-        device->GetDevice(),
-        swapChain->GetSwapChain(),
-        UINT64_MAX,
-        syncObjects->GetImageAvailableSemaphore(currentFrame),
-        VK_NULL_HANDLE,
-        &imageIndex
-    );
+    // This slot's last frame is retired, so its transient allocations can be recycled
+    frameLists.reset();
+    frameArenas[currentFrame]->Reset();
+    frameLists.emplace(frameArenas[currentFrame].get());
+
+    // Acquire next image. Headless targets are simply cycled: nothing else uses them.
+    const bool headless = swapChain->IsHeadless();
+    uint32_t imageIndex = 0;
+    VkResult result = VK_SUCCESS;
+    if (headless) {
+        imageIndex = headlessImageIndex;
+        headlessImageIndex = (headlessImageIndex + 1) % static_cast<uint32_t>(swapChain->GetImages().size());
+    }
+    else {
+        ProfileScope acquireScope("AcquireNextImage");
+        result = vkAcquireNextImageKHR(
+            device->GetDevice(),
+            swapChain->GetSwapChain(),
+            UINT64_MAX,
+            syncObjects->GetImageAvailableSemaphore(currentFrame),
+            VK_NULL_HANDLE,
+            &imageIndex
+        );
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
         return;
@@ -108,6 +127,8 @@ void Renderer::DrawFrame(Scene& scene, uint32_t currentFrame, const glm::mat4& v
     // Check if this image is already in use
     VkFence& imageInFlightFence = syncObjects->GetImageInFlight(imageIndex);
     if (imageInFlightFence != VK_NULL_HANDLE) {
+        ProfileScope waitScope("WaitForImageFence");
+        HitchScope hitchScope(HitchDetector::Category::FenceWait, "WaitForImageFence");
         vkWaitForFences(device->GetDevice(), 1, &imageInFlightFence, VK_TRUE, UINT64_MAX);
     }
     imageInFlightFence = fence;
@@ -115,27 +136,34 @@ void Renderer::DrawFrame(Scene& scene, uint32_t currentFrame, const glm::mat4& v
     vkResetFences(device->GetDevice(), 1, &fence);
 
     VkCommandBuffer cmd = commandBuffer->GetCommandBuffer(currentFrame);
-    RecordCommandBuffer(cmd, imageIndex, currentFrame, scene, viewMatrix, projMatrix, layerMask);
+    RecordCommandBuffer(cmd, imageIndex, currentFrame, snapshot);
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
+    // Headless frames have no acquire to wait on and no present to signal; the fence orders them
     const VkSemaphore waitSemaphore = syncObjects->GetImageAvailableSemaphore(currentFrame);
     const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headless ? 0 : 1;
     submitInfo.pWaitSemaphores = &waitSemaphore;
     submitInfo.pWaitDstStageMask = &waitStage;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmd;
 
     const VkSemaphore signalSemaphore = syncObjects->GetRenderFinishedSemaphore(imageIndex);
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = &signalSemaphore;
 
-    if (vkQueueSubmit(device->GetGraphicsQueue(), 1, &submitInfo, fence) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit draw command buffer!");
+    gpuProfiler->MarkSubmit();
+    {
+        ProfileScope submitScope("QueueSubmit");
+        if (vkQueueSubmit(device->GetGraphicsQueue(), 1, &submitInfo, fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
     }
 
+    if (headless) return;
+
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -146,12 +174,13 @@ void Renderer::DrawFrame(Scene& scene, uint32_t currentFrame, const glm::mat4& v
     presentInfo.pSwapchains = &swapChainHandle;
     presentInfo.pImageIndices = &imageIndex;
 
+    ProfileScope presentScope("QueuePresent");
     vkQueuePresentKHR(device->GetPresentQueue(), &presentInfo);
 }
 
-void Renderer::CreateShadowPass() {
+void Renderer::CreateShadowPass(PipelineBatch& pipelines) {
     shadowPass = std::make_unique<ShadowPass>(device, 16384, 16384);
-    shadowPass->Initialize(descriptorSet->GetLayout());
+    shadowPass->Initialize(descriptorSet->GetLayout(), pipelines);
 }
 
 void Renderer::CreateUniformBuffers() {
@@ -187,13 +216,13 @@ void Renderer::CreateTextureDescriptorSetLayout() {
 void Renderer::CreateTextureDescriptorPool() {
     VkDescriptorPoolSize poolSize{};
     poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSize.descriptorCount = 100;
+    poolSize.descriptorCount = MAX_TEXTURE_SETS;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = 1;
     poolInfo.pPoolSizes = &poolSize;
-    poolInfo.maxSets = 100;
+    poolInfo.maxSets = MAX_TEXTURE_SETS;
 
     if (vkCreateDescriptorPool(device->GetDevice(), &poolInfo, nullptr, &textureDescriptorPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create texture descriptor pool!");
@@ -213,7 +242,10 @@ void Renderer::CreateDefaultTexture() {
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &textureSetLayout;
 
-    vkAllocateDescriptorSets(device->GetDevice(), &allocInfo, &defaultTextureResource.descriptorSet);
+    {
+        HitchScope hitchScope(HitchDetector::Category::DescriptorAllocation, "vkAllocateDescriptorSets", "default texture");
+        vkAllocateDescriptorSets(device->GetDevice(), &allocInfo, &defaultTextureResource.descriptorSet);
+    }
 
     VkDescriptorImageInfo imageInfo{};
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -255,7 +287,16 @@ VkDescriptorSet Renderer::GetTextureDescriptorSet(const std::string& path) {
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &textureSetLayout;
 
-    vkAllocateDescriptorSets(device->GetDevice(), &allocInfo, &descSet);
+    VkResult allocResult = VK_SUCCESS;
+    {
+        HitchScope hitchScope(HitchDetector::Category::DescriptorAllocation, "vkAllocateDescriptorSets", path.c_str());
+        allocResult = vkAllocateDescriptorSets(device->GetDevice(), &allocInfo, &descSet);
+    }
+    if (allocResult != VK_SUCCESS) {
+        std::cerr << "Warning: texture descriptor pool exhausted (" << MAX_TEXTURE_SETS << " sets), drawing " << path << " with the default texture" << std::endl;
+        textureCache[path] = { nullptr, defaultTextureResource.descriptorSet };
+        return defaultTextureResource.descriptorSet;
+    }
 
     VkDescriptorImageInfo imageInfo{};
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -301,22 +342,25 @@ VkFormat findSupportedFormat(VkPhysicalDevice physicalDevice, const std::vector<
     throw std::runtime_error("failed to find supported format!");
 }
 
+// Stencil formats first: the main pass masks the orb's interior with it
 VkFormat findDepthFormat(VkPhysicalDevice physicalDevice) {
     return findSupportedFormat(physicalDevice,
-        { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+        { VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT },
         VK_IMAGE_TILING_OPTIMAL,
         VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
 
 void Renderer::CreateRenderPass() {
+    depthFormat = findDepthFormat(device->GetPhysicalDevice());
     renderPass = std::make_unique<VulkanRenderPass>(
         device->GetDevice(),
-        swapChain->GetImageFormat()
+        swapChain->GetImageFormat(),
+        depthFormat
     );
     renderPass->Create(true);
 }
 
-void Renderer::CreatePipeline() {
+void Renderer::CreatePipeline(PipelineBatch& pipelines) {
     auto bindingDescription = Vertex::getBindingDescription();
     auto attributeDescriptions = Vertex::getAttributeDescriptions();
 
@@ -339,47 +383,37 @@ void Renderer::CreatePipeline() {
     pipelineConfig.blendEnable = true;
 
     graphicsPipeline = std::make_unique<GraphicsPipeline>(device->GetDevice(), pipelineConfig);
-    graphicsPipeline->Create();
-}
+    pipelines.Add(graphicsPipeline.get());
 
-void Renderer::CreateOffScreenResources() {
-    const VkExtent2D extent = swapChain->GetExtent();
-    const VkFormat imageFormat = swapChain->GetImageFormat();
-
-    // 1. Main OffScreen Color Attachment
-    VulkanUtils::CreateImage(
-        device->GetDevice(),
-        device->GetPhysicalDevice(),
-        extent.width, extent.height, 1, 1,
-        imageFormat,
-        VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        offScreenImage,
-        offScreenImageMemory
-    );
-
-    offScreenImageView = VulkanUtils::CreateImageView(
-        device->GetDevice(), offScreenImage, imageFormat, VK_IMAGE_ASPECT_COLOR_BIT
-    );
-
-    // 2. Refraction Color Attachment
-    VulkanUtils::CreateImage(
-        device->GetDevice(),
-        device->GetPhysicalDevice(),
-        extent.width, extent.height, 1, 1,
-        imageFormat,
-        VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        refractionImage,
-        refractionImageMemory
-    );
+    if (!HasStencilComponent(depthFormat)) {
+        std::cerr << "Warning: no depth format with stencil, the crystal ball's interior is drawn unmasked." << std::endl;
+        return;
+    }
 
-    refractionImageView = VulkanUtils::CreateImageView(
-        device->GetDevice(), refractionImage, imageFormat, VK_IMAGE_ASPECT_COLOR_BIT
-    );
+    // Interior objects: as above, only where a crystal ball was stenciled
+    GraphicsPipelineConfig interiorConfig = pipelineConfig;
+    interiorConfig.stencilTestEnable = true;
+    interiorConfig.stencilCompareOp = VK_COMPARE_OP_EQUAL;
+    interiorConfig.stencilReference = PORTAL_STENCIL;
+    portalInteriorPipeline = std::make_unique<GraphicsPipeline>(device->GetDevice(), interiorConfig);
+    pipelines.Add(portalInteriorPipeline.get());
+
+    // The ball's front faces into stencil, before anything has depth to occlude them; no color or depth
+    GraphicsPipelineConfig maskConfig = pipelineConfig;
+    maskConfig.fragShaderPath = "src/shaders/shadow_frag.spv";
+    maskConfig.depthTestEnable = false;
+    maskConfig.depthWriteEnable = false;
+    maskConfig.blendEnable = false;
+    maskConfig.colorWriteEnable = false;
+    maskConfig.stencilTestEnable = true;
+    maskConfig.stencilCompareOp = VK_COMPARE_OP_ALWAYS;
+    maskConfig.stencilPassOp = VK_STENCIL_OP_REPLACE;
+    maskConfig.stencilReference = PORTAL_STENCIL;
+    portalMaskPipeline = std::make_unique<GraphicsPipeline>(device->GetDevice(), maskConfig);
+    pipelines.Add(portalMaskPipeline.get());
+}
 
+void Renderer::CreateRefractionSampler() {
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -392,104 +426,198 @@ void Renderer::CreateOffScreenResources() {
     if (vkCreateSampler(device->GetDevice(), &samplerInfo, nullptr, &refractionSampler) != VK_SUCCESS) {
         throw std::runtime_error("failed to create refraction sampler!");
     }
+}
 
-    // 3. Shared Depth Attachment
-    const VkFormat depthFormat = findDepthFormat(device->GetPhysicalDevice());
+void Renderer::BuildRenderGraph() {
+    // Nothing may still reference the old graph's images
+    DestroyFramebuffers();
+    if (lowResParticlePass) {
+        lowResParticlePass->ReleaseTargets();
+    }
+    renderGraph->Cleanup();
 
-    VulkanUtils::CreateImage(
-        device->GetDevice(),
-        device->GetPhysicalDevice(),
-        extent.width, extent.height, 1, 1,
-        depthFormat,
-        VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        depthImage,
-        depthImageMemory
-    );
+    const VkExtent2D extent = swapChain->GetExtent();
+    const VkFormat imageFormat = swapChain->GetImageFormat();
+    using Usage = RenderGraph::Usage;
+
+    // --- Images ---
+    shadowMapTarget = renderGraph->ImportImage("ShadowMap", VK_FORMAT_D32_SFLOAT, VK_IMAGE_ASPECT_DEPTH_BIT);
+    renderGraph->SetImportedImage(shadowMapTarget, shadowPass->GetShadowImage());
+    swapChainTarget = renderGraph->ImportImage("SwapChain", imageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+    // Headless images are never presented; they end the frame ready to be read back instead
+    renderGraph->SetOutput(swapChainTarget, swapChain->IsHeadless() ? Usage::TransferSrc : Usage::Present);
+
+    // Kept across frames when it is only re-rendered every few: the frames between reproject the last render
+    refractionExtent = {
+        std::max(1u, static_cast<uint32_t>(static_cast<float>(extent.width) * refractionScale)),
+        std::max(1u, static_cast<uint32_t>(static_cast<float>(extent.height) * refractionScale))
+    };
+    RenderGraph::ImageDesc refractionDesc{ refractionExtent, imageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT };
+    refractionDesc.persistent = refractionInterval > 1;
+    refractionTarget = renderGraph->CreateImage("Refraction", refractionDesc);
+    refractionHistoryValid = false;
+
+    // Shared by the refraction and main passes; sampled by the low-res particle pass
+    sceneDepthTarget = renderGraph->CreateImage("SceneDepth",
+        { extent, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT });
+    refractionDepthTarget = sceneDepthTarget;
+    if (refractionExtent.width != extent.width || refractionExtent.height != extent.height) {
+        refractionDepthTarget = renderGraph->CreateImage("RefractionDepth",
+            { refractionExtent, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT });
+    }
 
-    depthImageView = VulkanUtils::CreateImageView(
-        device->GetDevice(), depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT
-    );
+    // --- Passes ---
+    const RenderGraph::PassHandle shadow = renderGraph->AddPass("Shadow",
+        [this](VkCommandBuffer cmd, uint32_t) { RenderShadowMap(cmd); });
+    renderGraph->Use(shadow, shadowMapTarget, Usage::DepthAttachment);
+
+    const RenderGraph::PassHandle refraction = renderGraph->AddPass("Refraction",
+        [this](VkCommandBuffer cmd, uint32_t) { RenderRefractionPass(cmd); });
+    renderGraph->Use(refraction, shadowMapTarget, Usage::Sampled);
+    renderGraph->Use(refraction, refractionTarget, Usage::ColorAttachment);
+    renderGraph->Use(refraction, refractionDepthTarget, Usage::DepthAttachment);
+
+    // Skybox and full-resolution particles are drawn inside this pass's render pass. It renders straight
+    // into the swap chain image: nothing needs the scene in a separate image, so there is no copy.
+    const RenderGraph::PassHandle mainPass = renderGraph->AddPass("Main",
+        [this](VkCommandBuffer cmd, uint32_t) { RenderScene(cmd); });
+    renderGraph->Use(mainPass, shadowMapTarget, Usage::Sampled);
+    renderGraph->Use(mainPass, refractionTarget, Usage::Sampled);
+    renderGraph->Use(mainPass, swapChainTarget, Usage::ColorAttachment);
+    renderGraph->Use(mainPass, sceneDepthTarget, Usage::DepthAttachment);
+
+    if (lowResParticlePass) {
+        const RenderGraph::PassHandle particles = renderGraph->AddPass("LowResParticles",
+            [this](VkCommandBuffer cmd, uint32_t currentFrame) { RenderLowResParticles(cmd, currentFrame); });
+        lowResParticlePass->DeclareTargets(*renderGraph, particles, extent, sceneDepthTarget, swapChainTarget);
+    }
+
+    renderGraph->Compile();
+
+    CreateFramebuffers();
+    if (lowResParticlePass) {
+        lowResParticlePass->BindTargets(*renderGraph, swapChain->GetImageViews());
+    }
+}
+
+void Renderer::CreateFramebuffers() {
+    const VkImageView depthView = renderGraph->GetImageView(sceneDepthTarget);
+
+    // 1. Main Framebuffers (Swap Chain Color + Depth)
+    renderPass->CreateFramebuffers(swapChain->GetImageViews(), depthView, swapChain->GetExtent());
+
+    // 2. Refraction Framebuffer
+    const std::array<VkImageView, 2> attachments = {
+        renderGraph->GetImageView(refractionTarget),
+        renderGraph->GetImageView(refractionDepthTarget) // The scene depth at full resolution
+    };
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = renderPass->GetRenderPass();
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    framebufferInfo.pAttachments = attachments.data();
+    framebufferInfo.width = refractionExtent.width;
+    framebufferInfo.height = refractionExtent.height;
+    framebufferInfo.layers = 1;
+
+    if (vkCreateFramebuffer(device->GetDevice(), &framebufferInfo, nullptr, &refractionFramebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create refraction framebuffer!");
+    }
+}
+
+void Renderer::DestroyFramebuffers() {
+    if (renderPass) {
+        renderPass->DestroyFramebuffers();
+    }
+    if (refractionFramebuffer != VK_NULL_HANDLE) {
+        vkDestroyFramebuffer(device->GetDevice(), refractionFramebuffer, nullptr);
+        refractionFramebuffer = VK_NULL_HANDLE;
+    }
+}
+
+void Renderer::Resize() {
+    ProfileScope profileScope("Renderer::Resize");
+
+    // Every swap-chain-sized target is a render graph image, so rebuilding the graph replaces them all
+    BuildRenderGraph();
+    descriptorSet->UpdateImage(REFRACTION_BINDING, renderGraph->GetImageView(refractionTarget), refractionSampler);
+
+    // Semaphores are indexed by swap chain image, so only a different image count needs new ones
+    const uint32_t imageCount = static_cast<uint32_t>(swapChain->GetImages().size());
+    if (imageCount == syncObjects->GetSwapChainImageCount()) {
+        syncObjects->ResetImagesInFlight();
+    }
+    else {
+        syncObjects->Cleanup();
+        CreateSyncObjects();
+    }
+    headlessImageIndex = 0;
 }
 
-void Renderer::BeginRenderPass(VkCommandBuffer cmd, VkRenderPass pass, VkFramebuffer fb, const std::vector<VkClearValue>& clearValues) const {
+void Renderer::BeginRenderPass(VkCommandBuffer cmd, RecordPass pass, VkFramebuffer fb, const VkClearValue* clearValues, uint32_t clearCount, VkSubpassContents contents) const {
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = pass;
+    renderPassInfo.renderPass = renderPass->GetRenderPass();
     renderPassInfo.framebuffer = fb;
+    // Refraction clears its whole target even though only refractionScissor is drawn: the target is kept
+    // across frames, and reprojected frames may sample outside the current rect once the ball moves.
+    // Starting from UNDEFINED over a partial render area would leave the rest of it undefined.
     renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = swapChain->GetExtent();
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
+    renderPassInfo.renderArea.extent = (pass == RecordPass::Refraction) ? refractionExtent : swapChain->GetExtent();
+    renderPassInfo.clearValueCount = clearCount;
+    renderPassInfo.pClearValues = clearValues;
 
-    vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(cmd, &renderPassInfo, contents);
+
+    // Dynamic state isn't inherited by secondary buffers, they set their own
+    if (contents == VK_SUBPASS_CONTENTS_INLINE) {
+        SetViewportAndScissor(cmd, pass);
+    }
+}
+
+void Renderer::SetViewportAndScissor(VkCommandBuffer cmd, RecordPass pass) const {
+    const VkExtent2D extent = (pass == RecordPass::Refraction) ? refractionExtent : swapChain->GetExtent();
 
     VkViewport viewport{};
-    viewport.width = static_cast<float>(swapChain->GetExtent().width);
-    viewport.height = static_cast<float>(swapChain->GetExtent().height);
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     vkCmdSetViewport(cmd, 0, 1, &viewport);
 
     VkRect2D scissor{};
-    scissor.extent = swapChain->GetExtent();
+    scissor.extent = extent;
+    if (pass == RecordPass::Refraction) scissor = refractionScissor;
     vkCmdSetScissor(cmd, 0, 1, &scissor);
 }
 
-void Renderer::RenderRefractionPass(VkCommandBuffer cmd, uint32_t currentFrame, const Scene& scene, int layerMask) {
-    std::vector<VkClearValue> clearValues(2);
+void Renderer::RenderRefractionPass(VkCommandBuffer cmd) {
+    // Nothing samples it this frame, or the last render is being reused
+    if (!refractionActive) return;
+
+    std::array<VkClearValue, 2> clearValues{};
     clearValues[0].color = { {0.1f, 0.1f, 0.1f, 1.0f} };
     clearValues[1].depthStencil = { 1.0f, 0 };
 
-    BeginRenderPass(cmd, renderPass->GetRenderPass(), refractionFramebuffer, clearValues);
-
-    if (skyboxPass) {
-        skyboxPass->Draw(cmd, scene, currentFrame, descriptorSet->GetDescriptorSets()[currentFrame]);
-    }
-
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->GetPipeline());
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->GetLayout(), 0, 1, &descriptorSet->GetDescriptorSets()[currentFrame], 0, nullptr);
-
-    for (const auto& obj : scene.GetObjects()) {
-        if (!obj || !obj->visible || !obj->geometry || obj->shadingMode == 3 || obj->shadingMode == 2 || obj->shadingMode == 4) continue;
-        if ((obj->layerMask & layerMask) == 0) continue;
-
-        PushConstantObject pco{};
-        pco.model = obj->transform;
-        pco.shadingMode = obj->shadingMode;
-        pco.receiveShadows = obj->receiveShadows ? 1 : 0;
-        pco.layerMask = obj->layerMask;
-        vkCmdPushConstants(cmd, graphicsPipeline->GetLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantObject), &pco);
-
-        const VkDescriptorSet textureSet = GetTextureDescriptorSet(obj->texturePath);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->GetLayout(), 1, 1, &textureSet, 0, nullptr);
-
-        obj->geometry->Bind(cmd);
-        obj->geometry->Draw(cmd);
-    }
+    const uint32_t gpuScope = gpuProfiler->BeginScope(cmd, "RefractionPass");
+    renderStats->BeginPass(cmd, RenderStats::Pass::Refraction);
+    BeginRenderPass(cmd, RecordPass::Refraction, refractionFramebuffer, clearValues.data(), static_cast<uint32_t>(clearValues.size()), VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    ExecuteSecondaries(cmd, RecordPass::Refraction);
     vkCmdEndRenderPass(cmd);
+    renderStats->EndPass(cmd, RenderStats::Pass::Refraction);
+    gpuProfiler->EndScope(cmd, gpuScope);
+}
 
-    // Barrier for refraction texture read
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = refractionImage;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(cmd,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        0, 0, nullptr, 0, nullptr, 1, &barrier);
+void Renderer::RenderLowResParticles(VkCommandBuffer cmd, uint32_t currentFrame) {
+    RenderStats::Counters counters;
+    const uint32_t gpuScope = gpuProfiler->BeginScope(cmd, "LowResParticles");
+    renderStats->BeginPass(cmd, RenderStats::Pass::LowResParticles);
+    lowResParticlePass->Render(cmd, currentFrame, descriptorSet->GetDescriptorSets()[currentFrame], *particlePass, counters);
+    lowResParticlePass->Composite(cmd, frameImageIndex, counters);
+    renderStats->EndPass(cmd, RenderStats::Pass::LowResParticles);
+    gpuProfiler->EndScope(cmd, gpuScope);
+    renderStats->AddCounters(RenderStats::Pass::LowResParticles, counters);
 }
 
 void Renderer::CreateCommandBuffer() {
@@ -499,6 +627,14 @@ void Renderer::CreateCommandBuffer() {
     );
     commandBuffer->CreateCommandPool(device->GetQueueFamilies().graphicsFamily.value());
     commandBuffer->CreateCommandBuffers(MAX_FRAMES_IN_FLIGHT);
+
+    // One pool per recording thread per frame for the secondary buffers
+    threadCommandPools = std::make_unique<VulkanThreadCommandPools>(
+        device->GetDevice(),
+        MAX_FRAMES_IN_FLIGHT,
+        jobSystem ? jobSystem->GetThreadCount() : 1
+    );
+    threadCommandPools->CreateCommandPools(device->GetQueueFamilies().graphicsFamily.value());
 }
 
 void Renderer::CreateSyncObjects() {
@@ -515,11 +651,108 @@ void Renderer::CreateSyncObjects() {
     syncObjects->CreateSyncObjects(imageCount);
 }
 
-void Renderer::DrawSceneObjects(VkCommandBuffer cmd, const Scene& scene, VkPipelineLayout layout, bool bindTextures, bool skipIfNotCastingShadow, int layerMask) {
-    for (const auto& obj : scene.GetObjects()) {
-        if (!obj || !obj->visible || !obj->geometry) continue;
-        if ((obj->layerMask & layerMask) == 0) continue;
-        if (skipIfNotCastingShadow && !obj->castsShadow) continue;
+void Renderer::BuildDrawLists(const RenderSnapshot& snapshot, const Frustum& cameraFrustum, const Frustum& lightFrustum) {
+    // Lists an object is drawn in, and the lists it was eligible for before frustum culling
+    enum : uint8_t {
+        SHADOW_LIST = 1 << 0, REFRACTION_LIST = 1 << 1, MAIN_LIST = 1 << 2,
+        SHADOW_CANDIDATE = 1 << 3, REFRACTION_CANDIDATE = 1 << 4, MAIN_CANDIDATE = 1 << 5,
+        PORTAL_LIST = 1 << 6, INTERIOR_LIST = 1 << 7, // Main candidates drawn through the stencil instead
+        DRAWN_LISTS = SHADOW_LIST | REFRACTION_LIST | MAIN_LIST | PORTAL_LIST | INTERIOR_LIST
+    };
+
+    const auto& objects = snapshot.objects;
+    auto& drawListMasks = frameLists->drawListMasks;
+    drawListMasks.assign(objects.size(), 0);
+
+    // Classify in parallel: every chunk writes only its own slots
+    ParallelFor(jobSystem, objects.size(), CULL_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const RenderSnapshot::Object* obj = &objects[i];
+
+            const glm::mat4& m = obj->transform;
+            const float maxScale = std::max({ glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])) });
+            const glm::vec3 center = glm::vec3(m * glm::vec4(obj->localBoundsCenter, 1.0f));
+            const float radius = obj->localBoundsRadius * maxScale;
+
+            uint8_t mask = 0;
+            if (obj->castsShadow) {
+                mask |= SHADOW_CANDIDATE;
+                if (lightFrustum.IntersectsSphere(center, radius)) mask |= SHADOW_LIST;
+            }
+
+            // Glass, water and fog are what the refraction pass is sampled for, so they can't be in it
+            const bool refractive = obj->shadingMode == 2 || obj->shadingMode == 3 || obj->shadingMode == 4;
+            if (refractionActive && !refractive && (obj->layerMask & (SceneLayers::INSIDE | SceneLayers::OUTSIDE)) != 0) {
+                mask |= REFRACTION_CANDIDATE;
+            }
+            if ((obj->layerMask & snapshot.layerMask) != 0) {
+                mask |= MAIN_CANDIDATE;
+            }
+
+            // From outside, interior-only objects can only be seen through a crystal ball: culled to the
+            // portals' screen rect, or entirely when none is on screen
+            const bool interior = portalMasked && obj->shadingMode != 3 && (obj->layerMask & SceneLayers::OUTSIDE) == 0;
+            if (interior && (mask & MAIN_CANDIDATE) && portalVisible && portalFrustum.IntersectsSphere(center, radius)) {
+                mask |= INTERIOR_LIST;
+            }
+
+            if ((mask & (REFRACTION_CANDIDATE | MAIN_CANDIDATE)) != 0 && cameraFrustum.IntersectsSphere(center, radius)) {
+                if (mask & REFRACTION_CANDIDATE) mask |= REFRACTION_LIST;
+                if ((mask & MAIN_CANDIDATE) && !interior) mask |= MAIN_LIST;
+                // Stenciled first; its glass is still drawn over the interior in scene order
+                if ((mask & MAIN_LIST) && portalVisible && obj->shadingMode == 3 && glm::distance(snapshot.cameraPosition, center) >= radius) {
+                    mask |= PORTAL_LIST;
+                }
+            }
+
+            drawListMasks[i] = mask;
+        }
+        }, "Renderer::CullObjects");
+
+    // Compact serially so every list keeps scene order. Texture sets are resolved here too:
+    // the texture cache may load on a miss and isn't safe to touch from recording threads.
+    // Reserved up front: growing would strand every outgrown block in the arena.
+    auto& shadowDrawList = frameLists->shadowDrawList;
+    auto& refractionDrawList = frameLists->refractionDrawList;
+    auto& mainDrawList = frameLists->mainDrawList;
+    auto& portalDrawList = frameLists->portalDrawList;
+    auto& interiorDrawList = frameLists->interiorDrawList;
+    shadowDrawList.reserve(objects.size());
+    refractionDrawList.reserve(objects.size());
+    mainDrawList.reserve(objects.size());
+    interiorDrawList.reserve(objects.size());
+    portalDrawList.reserve(objects.size());
+    uint32_t shadowCandidates = 0;
+    uint32_t refractionCandidates = 0;
+    uint32_t mainCandidates = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const uint8_t mask = drawListMasks[i];
+        if (mask & SHADOW_CANDIDATE) ++shadowCandidates;
+        if (mask & REFRACTION_CANDIDATE) ++refractionCandidates;
+        if (mask & MAIN_CANDIDATE) ++mainCandidates;
+        if ((mask & DRAWN_LISTS) == 0) continue;
+
+        const RenderSnapshot::Object* obj = &objects[i];
+        const VkDescriptorSet textureSet = (mask & (REFRACTION_LIST | MAIN_LIST | INTERIOR_LIST)) ? GetTextureDescriptorSet(*obj->texturePath) : VK_NULL_HANDLE;
+
+        if (mask & SHADOW_LIST) shadowDrawList.push_back({ obj, VK_NULL_HANDLE });
+        if (mask & REFRACTION_LIST) refractionDrawList.push_back({ obj, textureSet });
+        if (mask & MAIN_LIST) mainDrawList.push_back({ obj, textureSet });
+        if (mask & PORTAL_LIST) portalDrawList.push_back({ obj, VK_NULL_HANDLE });
+        if (mask & INTERIOR_LIST) interiorDrawList.push_back({ obj, textureSet });
+    }
+
+    const auto reportObjects = [this](RenderStats::Pass pass, size_t drawn, uint32_t candidates) {
+        renderStats->SetObjectCounts(pass, static_cast<uint32_t>(drawn), candidates - static_cast<uint32_t>(drawn));
+    };
+    reportObjects(RenderStats::Pass::Shadow, shadowDrawList.size(), shadowCandidates);
+    reportObjects(RenderStats::Pass::Refraction, refractionDrawList.size(), refractionCandidates);
+    reportObjects(RenderStats::Pass::Main, mainDrawList.size() + interiorDrawList.size(), mainCandidates);
+}
+
+void Renderer::DrawSceneObjects(VkCommandBuffer cmd, const std::pmr::vector<DrawItem>& drawList, size_t begin, size_t end, VkPipelineLayout layout, bool bindTextures, RenderStats::Counters& counters) const {
+    for (size_t i = begin; i < end; ++i) {
+        const RenderSnapshot::Object* obj = drawList[i].object;
 
         PushConstantObject pco{};
         pco.model = obj->transform;
@@ -527,93 +760,344 @@ void Renderer::DrawSceneObjects(VkCommandBuffer cmd, const Scene& scene, VkPipel
         pco.receiveShadows = obj->receiveShadows ? 1 : 0;
         pco.layerMask = obj->layerMask;
         vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantObject), &pco);
+        ++counters.pushConstants;
 
         if (bindTextures) {
-            const VkDescriptorSet textureSet = GetTextureDescriptorSet(obj->texturePath);
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &textureSet, 0, nullptr);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &drawList[i].textureSet, 0, nullptr);
+            ++counters.descriptorSetBinds;
         }
 
+        const uint32_t gpuScope = gpuProfiler->BeginDraw(cmd, obj->name);
         obj->geometry->Bind(cmd);
         obj->geometry->Draw(cmd);
+        gpuProfiler->EndDraw(cmd, gpuScope);
+        counters.GeometryDraw(*obj->geometry);
     }
 }
 
-void Renderer::CreateParticlePipelines() {
-    auto bindings = ParticleSystem::GetBindingDescriptions();
-    auto attribs = ParticleSystem::GetAttributeDescriptions();
+void Renderer::RecordSecondaries(uint32_t currentFrame, const RenderSnapshot& snapshot) {
+    // Split every pass into independent pieces: skybox, chunks of object draws, particles
+    auto& recordTasks = frameLists->recordTasks;
+    const auto chunkCount = [](size_t drawCount) { return (drawCount + DRAWS_PER_SECONDARY - 1) / DRAWS_PER_SECONDARY; };
+    recordTasks.reserve(chunkCount(frameLists->shadowDrawList.size()) + chunkCount(frameLists->refractionDrawList.size())
+        + chunkCount(frameLists->mainDrawList.size()) + chunkCount(frameLists->interiorDrawList.size()) + 4);
+
+    const auto addObjectTasks = [&recordTasks](RecordPass pass, size_t drawCount) {
+        for (size_t begin = 0; begin < drawCount; begin += DRAWS_PER_SECONDARY) {
+            recordTasks.push_back({ pass, RecordContent::Objects, begin, std::min(begin + DRAWS_PER_SECONDARY, drawCount) });
+        }
+    };
 
-    GraphicsPipelineConfig config{};
-    config.vertShaderPath = "src/shaders/particle_vert.spv";
-    config.fragShaderPath = "src/shaders/particle_frag.spv";
-    config.renderPass = renderPass->GetRenderPass();
-    config.extent = swapChain->GetExtent();
+    addObjectTasks(RecordPass::Shadow, frameLists->shadowDrawList.size());
+    if (skyboxPass && refractionActive) recordTasks.push_back({ RecordPass::Refraction, RecordContent::Skybox, 0, 0 });
+    addObjectTasks(RecordPass::Refraction, frameLists->refractionDrawList.size());
+    if (skyboxPass) recordTasks.push_back({ RecordPass::Main, RecordContent::Skybox, 0, 0 });
+    // The interior goes first, so the stencil is only ever written before it is tested
+    if (!frameLists->portalDrawList.empty()) {
+        recordTasks.push_back({ RecordPass::Main, RecordContent::PortalMask, 0, frameLists->portalDrawList.size() });
+        for (size_t begin = 0; begin < frameLists->interiorDrawList.size(); begin += DRAWS_PER_SECONDARY) {
+            recordTasks.push_back({ RecordPass::Main, RecordContent::PortalInterior, begin, std::min(begin + DRAWS_PER_SECONDARY, frameLists->interiorDrawList.size()) });
+        }
+    }
+    addObjectTasks(RecordPass::Main, frameLists->mainDrawList.size());
+    // Low-res particles are drawn and composited after the main pass ends
+    if (!lowResParticlePass) recordTasks.push_back({ RecordPass::Main, RecordContent::Particles, 0, 0 });
+
+    threadCommandPools->BeginFrame(currentFrame);
+    auto& recordedSecondaries = frameLists->recordedSecondaries;
+    recordedSecondaries.assign(recordTasks.size(), VK_NULL_HANDLE);
+    frameLists->passSecondaries.reserve(recordTasks.size());
+
+    ParallelFor(jobSystem, recordTasks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            recordedSecondaries[i] = RecordSecondary(recordTasks[i], currentFrame, snapshot);
+        }
+        }, "Renderer::RecordSecondaries");
+}
 
-    config.bindingDescription = bindings.data();
-    config.bindingCount = static_cast<uint32_t>(bindings.size());
-    config.attributeDescriptions = attribs.data();
-    config.attributeCount = static_cast<uint32_t>(attribs.size());
+VkCommandBuffer Renderer::RecordSecondary(const RecordTask& task, uint32_t currentFrame, const RenderSnapshot& snapshot) const {
+    const uint32_t threadIndex = jobSystem ? jobSystem->GetCurrentThreadIndex() : 0;
+    const VkCommandBuffer cmd = threadCommandPools->AcquireSecondary(currentFrame, threadIndex);
+    const VkDescriptorSet globalSet = descriptorSet->GetDescriptorSets()[currentFrame];
+
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.subpass = 0;
+    inheritance.pipelineStatistics = renderStats->GetInheritedStatistics();
+    switch (task.pass) {
+    case RecordPass::Shadow:
+        inheritance.renderPass = shadowPass->GetRenderPass();
+        inheritance.framebuffer = shadowPass->GetFramebuffer();
+        break;
+    case RecordPass::Refraction:
+        inheritance.renderPass = renderPass->GetRenderPass();
+        inheritance.framebuffer = refractionFramebuffer;
+        break;
+    case RecordPass::Main:
+        inheritance.renderPass = renderPass->GetRenderPass();
+        inheritance.framebuffer = renderPass->GetFramebuffers()[frameImageIndex];
+        break;
+    }
 
-    config.descriptorSetLayouts = { descriptorSet->GetLayout(), textureSetLayout };
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
 
-    config.depthWriteEnable = false;
-    config.depthTestEnable = true;
-    config.blendEnable = true;
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
 
-    // Additive Pipeline
-    config.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    config.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    // Chunks of the same content merge into one span when the profiler resolves them
+    static constexpr const char* CONTENT_NAMES[] = { "SkyboxPass::Draw", "Objects", "Particles", "PortalMask", "PortalInterior" };
+    const uint32_t gpuScope = gpuProfiler->BeginScope(cmd, CONTENT_NAMES[static_cast<size_t>(task.content)]);
+    RenderStats::Counters counters;
+
+    if (task.pass == RecordPass::Shadow) {
+        const VkPipelineLayout layout = shadowPass->GetPipeline()->GetLayout();
+        shadowPass->BindState(cmd, counters);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &globalSet, 0, nullptr);
+        ++counters.descriptorSetBinds;
+        DrawSceneObjects(cmd, frameLists->shadowDrawList, task.begin, task.end, layout, false, counters);
+    }
+    else {
+        SetViewportAndScissor(cmd, task.pass);
+
+        switch (task.content) {
+        case RecordContent::Skybox:
+            skyboxPass->Draw(cmd, snapshot, currentFrame, globalSet, counters);
+            break;
+        case RecordContent::Objects:
+        case RecordContent::PortalMask:
+        case RecordContent::PortalInterior: {
+            const GraphicsPipeline* pipeline = graphicsPipeline.get();
+            const std::pmr::vector<DrawItem>* drawList = (task.pass == RecordPass::Refraction) ? &frameLists->refractionDrawList : &frameLists->mainDrawList;
+            if (task.content == RecordContent::PortalMask) {
+                pipeline = portalMaskPipeline.get();
+                drawList = &frameLists->portalDrawList;
+            }
+            else if (task.content == RecordContent::PortalInterior) {
+                pipeline = portalInteriorPipeline.get();
+                drawList = &frameLists->interiorDrawList;
+            }
+
+            const VkPipelineLayout layout = pipeline->GetLayout();
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetPipeline());
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &globalSet, 0, nullptr);
+            ++counters.pipelineBinds;
+            ++counters.descriptorSetBinds;
+            // The mask writes no color, so it needs no textures
+            DrawSceneObjects(cmd, *drawList, task.begin, task.end, layout, task.content != RecordContent::PortalMask, counters);
+            break;
+        }
+        case RecordContent::Particles:
+            particlePass->Draw(cmd, currentFrame, globalSet, counters);
+            break;
+        }
+    }
 
-    particlePipelineAdditive = std::make_unique<GraphicsPipeline>(device->GetDevice(), config);
-    particlePipelineAdditive->Create();
+    gpuProfiler->EndScope(cmd, gpuScope);
 
-    // Alpha Blended Pipeline
-    config.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    config.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    static constexpr RenderStats::Pass STATS_PASSES[] = { RenderStats::Pass::Shadow, RenderStats::Pass::Refraction, RenderStats::Pass::Main };
+    renderStats->AddCounters(STATS_PASSES[static_cast<size_t>(task.pass)], counters);
 
-    particlePipelineAlpha = std::make_unique<GraphicsPipeline>(device->GetDevice(), config);
-    particlePipelineAlpha->Create();
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+    return cmd;
 }
 
-void Renderer::SetupSceneParticles(Scene& scene) const {
-    scene.SetupParticleSystem(
-        commandBuffer->GetCommandPool(),
-        device->GetGraphicsQueue(),
-        particlePipelineAdditive.get(),
-        particlePipelineAlpha.get(),
-        textureSetLayout,
-        MAX_FRAMES_IN_FLIGHT
+void Renderer::ExecuteSecondaries(VkCommandBuffer cmd, RecordPass pass) {
+    // Tasks were added pass by pass, so this keeps each pass's draw order
+    const auto& recordTasks = frameLists->recordTasks;
+    auto& passSecondaries = frameLists->passSecondaries;
+    passSecondaries.clear();
+    for (size_t i = 0; i < recordTasks.size(); ++i) {
+        if (recordTasks[i].pass == pass) passSecondaries.push_back(frameLists->recordedSecondaries[i]);
+    }
+
+    if (!passSecondaries.empty()) {
+        vkCmdExecuteCommands(cmd, static_cast<uint32_t>(passSecondaries.size()), passSecondaries.data());
+    }
+}
+
+void Renderer::CreateParticlePass(PipelineBatch& pipelines) {
+    particlePass = std::make_unique<ParticlePass>(
+        device->GetDevice(), device->GetPhysicalDevice(),
+        commandBuffer->GetCommandPool(), device->GetGraphicsQueue()
     );
+    particlePass->Initialize(renderPass->GetRenderPass(), swapChain->GetExtent(), descriptorSet->GetLayout(), textureSetLayout, MAX_FRAMES_IN_FLIGHT, pipelines);
 }
 
-void Renderer::RenderShadowMap(VkCommandBuffer cmd, uint32_t currentFrame, const Scene& scene, int layerMask) {
-    shadowPass->Begin(cmd);
+void Renderer::CreateLowResParticlePass(PipelineBatch& pipelines) {
+    if (particleResolutionDivisor <= 1) return;
 
-    vkCmdBindDescriptorSets(
-        cmd,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        shadowPass->GetPipeline()->GetLayout(),
-        0,
-        1,
-        &descriptorSet->GetDescriptorSets()[currentFrame],
-        0,
-        nullptr
-    );
+    // Its targets are declared with the rest of the frame in BuildRenderGraph
+    lowResParticlePass = std::make_unique<LowResParticlePass>(device->GetDevice());
+    lowResParticlePass->Initialize(particleResolutionDivisor, swapChain->GetImageFormat(), pipelines);
+    particlePass->CreateLowResPipelines(lowResParticlePass->GetParticleRenderPass(), pipelines);
+}
 
-    DrawSceneObjects(
-        cmd,
-        scene,
-        shadowPass->GetPipeline()->GetLayout(),
-        false, // bindTextures
-        true,  // skipIfNotCastingShadow
-        layerMask
-    );
+void Renderer::DestroyLowResParticlePass() {
+    if (particlePass) {
+        particlePass->DestroyLowResPipelines();
+    }
+    if (lowResParticlePass) {
+        lowResParticlePass->Cleanup();
+        lowResParticlePass.reset();
+    }
+}
+
+void Renderer::SetParticleResolution(uint32_t divisor) {
+    if (divisor != 1 && divisor != 2 && divisor != 4) {
+        std::cerr << "Warning: unsupported particle resolution divisor " << divisor << ", using full resolution." << std::endl;
+        divisor = 1;
+    }
+    if (divisor == particleResolutionDivisor) return;
+
+    particleResolutionDivisor = divisor;
 
+    // Not initialized yet: Initialize picks the setting up
+    if (!particlePass) return;
+
+    // Targets may still be in use by frames in flight
+    WaitIdle();
+    DestroyLowResParticlePass();
+    PipelineBatch pipelines(pipelineCache);
+    CreateLowResParticlePass(pipelines);
+    pipelines.Create(jobSystem);
+
+    // Adds or drops the low-res pass and its targets; the refraction target may move with them
+    BuildRenderGraph();
+    descriptorSet->UpdateImage(REFRACTION_BINDING, renderGraph->GetImageView(refractionTarget), refractionSampler);
+}
+
+void Renderer::SetRefractionResolution(float scale) {
+    scale = std::clamp(scale, 0.25f, 1.0f);
+    if (scale == refractionScale) return;
+
+    refractionScale = scale;
+    if (!renderGraph) return;
+
+    // The target and its framebuffer may still be in use by frames in flight
+    WaitIdle();
+    BuildRenderGraph();
+    descriptorSet->UpdateImage(REFRACTION_BINDING, renderGraph->GetImageView(refractionTarget), refractionSampler);
+}
+
+void Renderer::SetRefractionInterval(uint32_t frames) {
+    frames = std::max(1u, frames);
+    if (frames == refractionInterval) return;
+
+    const bool wasPersistent = refractionInterval > 1;
+    refractionInterval = frames;
+    if (!renderGraph || wasPersistent == (refractionInterval > 1)) return;
+
+    // Only every-frame rendering lets the target share memory with the rest of the frame
+    WaitIdle();
+    BuildRenderGraph();
+    descriptorSet->UpdateImage(REFRACTION_BINDING, renderGraph->GetImageView(refractionTarget), refractionSampler);
+}
+
+bool Renderer::ProjectPortals(const RenderSnapshot& snapshot, const Frustum& cameraFrustum, glm::vec2& ndcMin, glm::vec2& ndcMax) const {
+    const glm::mat4 viewProj = snapshot.proj * snapshot.view;
+
+    ndcMin = glm::vec2(1.0f);
+    ndcMax = glm::vec2(-1.0f);
+    bool visible = false;
+    for (const auto& obj : snapshot.objects) {
+        if (obj.shadingMode != 3 || (obj.layerMask & snapshot.layerMask) == 0) continue;
+
+        const glm::mat4& m = obj.transform;
+        const float maxScale = std::max({ glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])) });
+        const glm::vec3 center = glm::vec3(m * glm::vec4(obj.localBoundsCenter, 1.0f));
+        const float radius = obj.localBoundsRadius * maxScale;
+        if (glm::distance(snapshot.cameraPosition, center) < radius || !cameraFrustum.IntersectsSphere(center, radius)) continue;
+
+        visible = true;
+        for (int corner = 0; corner < 8; ++corner) {
+            const glm::vec3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+            const glm::vec4 clip = viewProj * glm::vec4(center + offset, 1.0f);
+            // A corner behind the camera: its projection is meaningless, so take the whole screen
+            if (clip.w <= 0.001f) {
+                ndcMin = glm::vec2(-1.0f);
+                ndcMax = glm::vec2(1.0f);
+                return true;
+            }
+            const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+        }
+    }
+
+    ndcMin = glm::clamp(ndcMin, -1.0f, 1.0f);
+    ndcMax = glm::clamp(ndcMax, -1.0f, 1.0f);
+    return visible;
+}
+
+void Renderer::PlanRefraction(bool visible, const glm::vec2& ndcMin, const glm::vec2& ndcMax, const glm::mat4& viewProj) {
+    if (!visible) {
+        refractionActive = false;
+        refractionHistoryValid = false;
+        return;
+    }
+
+    // Reuse the last render until it is refractionInterval frames old
+    if (refractionHistoryValid && ++refractionAge < refractionInterval) {
+        refractionActive = false;
+        return;
+    }
+
+    // The glass bends its lookups up to REFRACTION_DISTORTION away from the surface it covers
+    const glm::vec2 uvMin = glm::clamp(ndcMin * 0.5f + 0.5f - REFRACTION_DISTORTION, 0.0f, 1.0f);
+    const glm::vec2 uvMax = glm::clamp(ndcMax * 0.5f + 0.5f + REFRACTION_DISTORTION, 0.0f, 1.0f);
+    const glm::vec2 size(static_cast<float>(refractionExtent.width), static_cast<float>(refractionExtent.height));
+    const glm::ivec2 minPixel = glm::min(glm::ivec2(glm::floor(uvMin * size)), glm::ivec2(size) - 1);
+    const glm::ivec2 maxPixel = glm::max(glm::ivec2(glm::ceil(uvMax * size)), minPixel + 1);
+    refractionScissor.offset = { minPixel.x, minPixel.y };
+    refractionScissor.extent = { static_cast<uint32_t>(maxPixel.x - minPixel.x), static_cast<uint32_t>(maxPixel.y - minPixel.y) };
+
+    refractionViewProj = viewProj;
+    refractionAge = 0;
+    refractionHistoryValid = true;
+    refractionActive = true;
+}
+
+void Renderer::PlanPortal(const RenderSnapshot& snapshot, bool visible, const glm::vec2& ndcMin, const glm::vec2& ndcMax, const glm::mat4& viewProj) {
+    // Inside the orb its whole interior is the scene
+    portalMasked = portalStencil && portalMaskPipeline && (snapshot.layerMask & SceneLayers::OUTSIDE) != 0;
+    portalVisible = portalMasked && visible;
+    if (!portalVisible) return;
+
+    // Crop the projection so the portals' rect fills clip space: the frustum's side planes become its edges
+    const glm::vec2 size = glm::max(ndcMax - ndcMin, glm::vec2(0.0001f));
+    glm::mat4 crop(1.0f);
+    crop[0][0] = 2.0f / size.x;
+    crop[1][1] = 2.0f / size.y;
+    crop[3][0] = -(ndcMax.x + ndcMin.x) / size.x;
+    crop[3][1] = -(ndcMax.y + ndcMin.y) / size.y;
+    portalFrustum = Frustum(crop * viewProj);
+}
+
+void Renderer::SetupSceneParticles(Scene& scene) const {
+    scene.SetupParticleSystem(particlePass->GetAtlas());
+}
+
+void Renderer::RenderShadowMap(VkCommandBuffer cmd) {
+    RenderStats::Counters counters;
+    const uint32_t gpuScope = gpuProfiler->BeginScope(cmd, "ShadowPass");
+    renderStats->BeginPass(cmd, RenderStats::Pass::Shadow);
+    shadowPass->Begin(cmd, counters, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    ExecuteSecondaries(cmd, RecordPass::Shadow);
     shadowPass->End(cmd);
+    renderStats->EndPass(cmd, RenderStats::Pass::Shadow);
+    gpuProfiler->EndScope(cmd, gpuScope);
+    renderStats->AddCounters(RenderStats::Pass::Shadow, counters);
 }
 
-void Renderer::RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex,
-    uint32_t currentFrame, const Scene& scene,
-    const glm::mat4& viewMatrix, const glm::mat4& projMatrix, int layerMask) {
+void Renderer::RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex, uint32_t currentFrame, const RenderSnapshot& snapshot) {
+    AllocationScope allocationScope("RecordCommandBuffer");
+    ProfileScope profileScope("RecordCommandBuffer");
 
     vkResetCommandBuffer(cmd, 0);
 
@@ -624,9 +1108,14 @@ void Renderer::RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex,
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
+    // Reads back this slot's previous timings and opens the frame scope
+    gpuProfiler->BeginFrame(cmd, currentFrame);
+    renderStats->BeginFrame(cmd, currentFrame, snapshot.frameIndex);
+    renderStats->SetParticleSystems(snapshot.particleSystems);
+
     // --- 0. Update UBO ---
     glm::vec3 lightPos = glm::vec3(0.0f, 200.0f, 0.0f);
-    const auto& lights = scene.GetLights();
+    const auto& lights = snapshot.lights;
     if (!lights.empty()) lightPos = lights[0].position;
 
     glm::mat4 lightProj = glm::ortho(-200.0f, 200.0f, -200.0f, 200.0f, 1.0f, 500.0f);
@@ -635,9 +1124,9 @@ void Renderer::RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex,
     const glm::mat4 lightSpaceMatrix = lightProj * lightView;
 
     UniformBufferObject ubo{};
-    ubo.view = viewMatrix;
-    ubo.proj = projMatrix;
-    ubo.viewPos = glm::vec3(glm::inverse(viewMatrix)[3]);
+    ubo.view = snapshot.view;
+    ubo.proj = snapshot.proj;
+    ubo.viewPos = glm::vec3(glm::inverse(snapshot.view)[3]);
     ubo.lightSpaceMatrix = lightSpaceMatrix;
     const size_t count = std::min(lights.size(), static_cast<size_t>(MAX_LIGHTS));
     if (count > 0) std::memcpy(ubo.lights, lights.data(), count * sizeof(Light));
@@ -653,99 +1142,65 @@ void Renderer::RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex,
     }
     ubo.dayNightFactor = factor;
 
+    const glm::mat4 viewProj = snapshot.proj * snapshot.view;
+    const Frustum cameraFrustum(viewProj);
+    glm::vec2 portalMin, portalMax;
+    const bool portalsVisible = ProjectPortals(snapshot, cameraFrustum, portalMin, portalMax);
+    PlanRefraction(portalsVisible, portalMin, portalMax, viewProj);
+    PlanPortal(snapshot, portalsVisible, portalMin, portalMax, viewProj);
+    ubo.refractionViewProj = refractionViewProj;
+
     UpdateUniformBuffer(currentFrame, ubo);
 
-    // --- 1. Render Shadow Pass ---
-    RenderShadowMap(cmd, currentFrame, scene, SceneLayers::ALL);
+    // Cull and bucket objects for every pass, then upload the snapshot's particles
+    // into this frame's instance buffer before any pass begins
+    BuildDrawLists(snapshot, cameraFrustum, Frustum(lightSpaceMatrix));
+    particlePass->Prepare(snapshot, currentFrame);
 
-    // --- 2. Render Refraction Pass ---
-    RenderRefractionPass(cmd, currentFrame, scene, SceneLayers::INSIDE | SceneLayers::OUTSIDE);
+    // Every pass's draws are recorded into secondary buffers across the job system,
+    // the primary below only begins passes and executes them
+    frameImageIndex = imageIndex;
+    RecordSecondaries(currentFrame, snapshot);
 
-    // --- 3. Render Main Scene ---
-    RenderScene(cmd, currentFrame, scene, layerMask);
+    // Shadow, refraction, main scene and low-res particles, with the barriers between them
+    renderGraph->SetImportedImage(swapChainTarget, swapChain->GetImages()[imageIndex]);
+    renderGraph->Execute(cmd, currentFrame);
 
-    // --- 4. Copy to SwapChain ---
-    CopyOffScreenToSwapChain(cmd, imageIndex);
+    gpuProfiler->EndFrame(cmd);
+    renderStats->EndFrame();
 
     if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
 }
 
-void Renderer::RenderScene(VkCommandBuffer cmd, uint32_t currentFrame, const Scene& scene, int layerMask) {
-    std::vector<VkClearValue> clearValues(2);
+void Renderer::RenderScene(VkCommandBuffer cmd) {
+    std::array<VkClearValue, 2> clearValues{};
     clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
     clearValues[1].depthStencil = { 1.0f, 0 };
 
-    BeginRenderPass(cmd, renderPass->GetRenderPass(), renderPass->GetOffScreenFramebuffer(), clearValues);
-
-    if (skyboxPass) {
-        skyboxPass->Draw(cmd, scene, currentFrame, descriptorSet->GetDescriptorSets()[currentFrame]);
-    }
-
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->GetPipeline());
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->GetLayout(), 0, 1, &descriptorSet->GetDescriptorSets()[currentFrame], 0, nullptr);
+    const uint32_t gpuScope = gpuProfiler->BeginScope(cmd, "MainPass");
+    renderStats->BeginPass(cmd, RenderStats::Pass::Main);
+    BeginRenderPass(cmd, RecordPass::Main, renderPass->GetFramebuffers()[frameImageIndex], clearValues.data(), static_cast<uint32_t>(clearValues.size()), VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    ExecuteSecondaries(cmd, RecordPass::Main);
+    vkCmdEndRenderPass(cmd);
+    renderStats->EndPass(cmd, RenderStats::Pass::Main);
+    gpuProfiler->EndScope(cmd, gpuScope);
+}
 
-    DrawSceneObjects(cmd, scene, graphicsPipeline->GetLayout(), true, false, layerMask);
+void Renderer::WaitForFramesInFlight() const {
+    if (!syncObjects) return;
 
-    for (const auto& sys : scene.GetParticleSystems()) {
-        sys->Draw(cmd, descriptorSet->GetDescriptorSets()[currentFrame], currentFrame);
+    std::array<VkFence, MAX_FRAMES_IN_FLIGHT> fences{};
+    for (uint32_t i = 0; i < fences.size(); ++i) {
+        fences[i] = syncObjects->GetInFlightFence(i);
     }
+    vkWaitForFences(device->GetDevice(), static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
 
-    vkCmdEndRenderPass(cmd);
-}
-
-void Renderer::CopyOffScreenToSwapChain(VkCommandBuffer cmd, uint32_t imageIndex) const {
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = offScreenImage;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-    VkImageMemoryBarrier swapChainBarrier{};
-    swapChainBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    swapChainBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    swapChainBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    swapChainBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    swapChainBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    swapChainBarrier.image = swapChain->GetImages()[imageIndex];
-    swapChainBarrier.subresourceRange = barrier.subresourceRange;
-    swapChainBarrier.srcAccessMask = 0;
-    swapChainBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    vkCmdPipelineBarrier(cmd,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0, 0, nullptr, 0, nullptr, 1, &swapChainBarrier);
-
-    VkImageCopy copyRegion{};
-    copyRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
-    copyRegion.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
-    copyRegion.extent = { swapChain->GetExtent().width, swapChain->GetExtent().height, 1 };
-
-    vkCmdCopyImage(cmd,
-        offScreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-        swapChain->GetImages()[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1, &copyRegion);
-
-    swapChainBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    swapChainBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    swapChainBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    swapChainBarrier.dstAccessMask = 0;
-
-    vkCmdPipelineBarrier(cmd,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-        0, 0, nullptr, 0, nullptr, 1, &swapChainBarrier);
+    // Presents queued behind those frames may still be reading swap chain images and waiting on their semaphores
+    if (!swapChain->IsHeadless()) {
+        vkQueueWaitIdle(device->GetPresentQueue());
+    }
 }
 
 void Renderer::WaitIdle() const {
@@ -753,6 +1208,8 @@ void Renderer::WaitIdle() const {
 }
 
 void Renderer::Cleanup() {
+    frameLists.reset();
+
     for (size_t i = 0; i < uniformBuffers.size(); i++) {
         if (uniformBuffersMapped[i]) {
             vkUnmapMemory(device->GetDevice(), uniformBuffers[i]->GetBufferMemory());
@@ -797,13 +1254,11 @@ void Renderer::Cleanup() {
         textureSetLayout = VK_NULL_HANDLE;
     }
 
-    if (particlePipelineAdditive) {
-        particlePipelineAdditive->Cleanup();
-        particlePipelineAdditive.reset();
-    }
-    if (particlePipelineAlpha) {
-        particlePipelineAlpha->Cleanup();
-        particlePipelineAlpha.reset();
+    DestroyLowResParticlePass();
+
+    if (particlePass) {
+        particlePass->Cleanup();
+        particlePass.reset();
     }
 
     if (syncObjects) {
@@ -811,11 +1266,27 @@ void Renderer::Cleanup() {
         syncObjects.reset();
     }
 
+    gpuProfiler->Cleanup();
+    renderStats->Cleanup();
+
+    if (threadCommandPools) {
+        threadCommandPools->Cleanup();
+        threadCommandPools.reset();
+    }
+
     if (commandBuffer) {
         commandBuffer->Cleanup();
         commandBuffer.reset();
     }
 
+    if (portalMaskPipeline) {
+        portalMaskPipeline->Cleanup();
+        portalMaskPipeline.reset();
+    }
+    if (portalInteriorPipeline) {
+        portalInteriorPipeline->Cleanup();
+        portalInteriorPipeline.reset();
+    }
     if (graphicsPipeline) {
         graphicsPipeline->Cleanup();
         graphicsPipeline.reset();
@@ -836,54 +1307,13 @@ void Renderer::Cleanup() {
         skyboxPass.reset();
     }
 
-    CleanupOffScreenResources();
-}
-
-void Renderer::CleanupOffScreenResources() {
-    if (depthImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device->GetDevice(), depthImageView, nullptr);
-        depthImageView = VK_NULL_HANDLE;
-    }
-    if (depthImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device->GetDevice(), depthImage, nullptr);
-        depthImage = VK_NULL_HANDLE;
-    }
-    if (depthImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device->GetDevice(), depthImageMemory, nullptr);
-        depthImageMemory = VK_NULL_HANDLE;
-    }
-
-    if (offScreenImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device->GetDevice(), offScreenImageView, nullptr);
-        offScreenImageView = VK_NULL_HANDLE;
-    }
-    if (offScreenImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device->GetDevice(), offScreenImage, nullptr);
-        offScreenImage = VK_NULL_HANDLE;
-    }
-    if (offScreenImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device->GetDevice(), offScreenImageMemory, nullptr);
-        offScreenImageMemory = VK_NULL_HANDLE;
-    }
-
-    if (refractionFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(device->GetDevice(), refractionFramebuffer, nullptr);
-        refractionFramebuffer = VK_NULL_HANDLE;
+    DestroyFramebuffers();
+    if (renderGraph) {
+        renderGraph->Cleanup();
+        renderGraph.reset();
     }
     if (refractionSampler != VK_NULL_HANDLE) {
         vkDestroySampler(device->GetDevice(), refractionSampler, nullptr);
         refractionSampler = VK_NULL_HANDLE;
     }
-    if (refractionImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device->GetDevice(), refractionImageView, nullptr);
-        refractionImageView = VK_NULL_HANDLE;
-    }
-    if (refractionImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device->GetDevice(), refractionImage, nullptr);
-        refractionImage = VK_NULL_HANDLE;
-    }
-    if (refractionImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device->GetDevice(), refractionImageMemory, nullptr);
-        refractionImageMemory = VK_NULL_HANDLE;
-    }
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 #include "../vulkan/VulkanSwapChain.h"
 #include "../vulkan/VulkanRenderPass.h"
 #include "../vulkan/VulkanCommandBuffer.h"
+#include "../vulkan/VulkanThreadCommandPools.h"
 #include "../vulkan/VulkanSyncObjects.h"
 #include "../vulkan/VulkanDescriptorSet.h"
 #include "../vulkan/UniformBufferObject.h"
@@ -14,10 +15,19 @@
 #include "../rendering/GraphicsPipeline.h"
 #include "../rendering/Texture.h"
 #include "../rendering/ShadowPass.h"
-#include "ParticleSystem.h"
+#include "ParticlePass.h"
+#include "LowResParticlePass.h"
+#include "RenderGraph.h"
+#include "GpuProfiler.h"
+#include "RenderStats.h"
+#include "Frustum.h"
+#include "RenderSnapshot.h"
+#include "../core/FrameArena.h"
 
 #include <memory>
 #include <map>
+#include <memory_resource>
+#include <optional>
 #include <vulkan/VulkanContext.h>
 #include "Camera.h"
 
@@ -32,13 +42,48 @@ public:
 
     void Initialize();
 
-    void DrawFrame(Scene& scene, uint32_t currentFrame, const glm::mat4& viewMatrix, const glm::mat4& projMatrix, int layerMask = SceneLayers::ALL);
+    // Renders a published snapshot. It is only read during the call, so it may be recycled afterwards.
+    void DrawFrame(const RenderSnapshot& snapshot, uint32_t currentFrame);
     void UpdateUniformBuffer(uint32_t currentFrame, const UniformBufferObject& ubo);
     void WaitIdle() const;
+    // Every submitted frame and its present. Narrower than WaitIdle: other queues keep running.
+    void WaitForFramesInFlight() const;
+    // After the swap chain was rebuilt at a new size with the same format: rebuilds only the render
+    // graph (which owns every swap-chain-sized target) with the framebuffers over it, and the per-image
+    // sync objects if the image count changed. Pipelines use dynamic viewport and scissor, so they are
+    // kept along with everything else. Call WaitForFramesInFlight first.
+    void Resize();
     void Cleanup();
 
     void SetupSceneParticles(Scene& scene) const;
 
+    // Draw-list building, particle batching and command recording are split across the job
+    // system when one is set. Call before Initialize: recording pools are sized by its thread count.
+    void SetJobSystem(JobSystem* jobSystemArg) { jobSystem = jobSystemArg; }
+    // Every pipeline is created through this cache. Owned by the caller; set before Initialize.
+    void SetPipelineCache(VkPipelineCache pipelineCacheArg) { pipelineCache = pipelineCacheArg; }
+
+    // Particle render resolution: 1 = full (drawn in the main pass), 2 = half, 4 = quarter.
+    // Persists across Cleanup/Initialize.
+    void SetParticleResolution(uint32_t divisor);
+    uint32_t GetParticleResolution() const { return particleResolutionDivisor; }
+
+    // Refraction target (what the crystal ball shows through its glass): resolution as a fraction of the
+    // screen's (0.25 to 1), and how many frames each render is reprojected for (1 = every frame). The pass
+    // is scissored to the ball's screen rect and skipped while the ball can't show. Persist across Cleanup/Initialize.
+    void SetRefractionResolution(float scale);
+    void SetRefractionInterval(uint32_t frames);
+
+    // From outside the orb, interior-only objects (SceneLayers::INSIDE) are drawn only where the crystal ball
+    // covers the screen: the ball is stenciled first and they are culled to its screen rect. Needs a depth
+    // format with stencil. Persists across Cleanup/Initialize.
+    void SetPortalStencil(bool enabled) { portalStencil = enabled; }
+
+    // Timestamp profiling of every pass (and optionally every draw). Persists across Cleanup/Initialize.
+    GpuProfiler& GetGpuProfiler() { return *gpuProfiler; }
+    // Per-pass draw/bind/culling counters and pipeline statistics. Persists across Cleanup/Initialize.
+    RenderStats& GetRenderStats() { return *renderStats; }
+
     VulkanRenderPass* GetRenderPass() const { return renderPass.get(); }
     GraphicsPipeline* GetPipeline() const { return graphicsPipeline.get(); }
 
@@ -48,35 +93,32 @@ private:
     VulkanSwapChain* swapChain;
     Camera* m_camera = nullptr;
     VulkanContext* m_vulkanContext = nullptr;
+    JobSystem* jobSystem = nullptr;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
 
     std::unique_ptr<VulkanRenderPass> renderPass;
     std::unique_ptr<GraphicsPipeline> graphicsPipeline;
+    std::unique_ptr<GraphicsPipeline> portalMaskPipeline;     // Crystal ball into stencil only
+    std::unique_ptr<GraphicsPipeline> portalInteriorPipeline; // graphicsPipeline where the stencil is set
     std::unique_ptr<VulkanCommandBuffer> commandBuffer;
+    std::unique_ptr<VulkanThreadCommandPools> threadCommandPools;
     std::unique_ptr<VulkanSyncObjects> syncObjects;
     std::unique_ptr<ShadowPass> shadowPass;
     std::unique_ptr<SkyboxPass> skyboxPass;
     std::unique_ptr<VulkanDescriptorSet> descriptorSet;
     std::unique_ptr<Texture> texture;
 
-    // Shared Particle Resources
-    std::unique_ptr<GraphicsPipeline> particlePipelineAdditive;
-    std::unique_ptr<GraphicsPipeline> particlePipelineAlpha;
+    // Shared Particle Resources (atlas + merged additive/alpha draws)
+    std::unique_ptr<ParticlePass> particlePass;
+    std::unique_ptr<LowResParticlePass> lowResParticlePass; // Only exists when particles render below full resolution
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    std::unique_ptr<RenderStats> renderStats;
+    std::unique_ptr<RenderGraph> renderGraph; // Every pass of a frame, with the transient targets they share
 
     // --- 2. Vulkan Handles (Ptr/64-bit) ---
-    VkImage refractionImage = VK_NULL_HANDLE;
-    VkDeviceMemory refractionImageMemory = VK_NULL_HANDLE;
-    VkImageView refractionImageView = VK_NULL_HANDLE;
     VkSampler refractionSampler = VK_NULL_HANDLE;
     VkFramebuffer refractionFramebuffer = VK_NULL_HANDLE;
 
-    VkImage offScreenImage = VK_NULL_HANDLE;
-    VkDeviceMemory offScreenImageMemory = VK_NULL_HANDLE;
-    VkImageView offScreenImageView = VK_NULL_HANDLE;
-
-    VkImage depthImage = VK_NULL_HANDLE;
-    VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
-    VkImageView depthImageView = VK_NULL_HANDLE;
-
     VkDescriptorSetLayout textureSetLayout = VK_NULL_HANDLE;
     VkDescriptorPool textureDescriptorPool = VK_NULL_HANDLE;
 
@@ -100,35 +142,131 @@ private:
     std::map<std::string, TextureResource> textureCache;
     TextureResource defaultTextureResource;
 
+    struct DrawItem {
+        const RenderSnapshot::Object* object = nullptr;
+        VkDescriptorSet textureSet = VK_NULL_HANDLE; // Resolved on the main thread
+    };
+
+    // Secondary command buffer recording: one task per skybox, draw chunk or particle batch
+    enum class RecordPass { Shadow, Refraction, Main };
+    enum class RecordContent { Skybox, Objects, Particles, PortalMask, PortalInterior };
+    struct RecordTask {
+        RecordPass pass;
+        RecordContent content;
+        size_t begin; // Draw list range for Objects tasks
+        size_t end;
+    };
+
+    // Transient containers for the frame being recorded, allocated from that frame's arena.
+    // Rebuilt from scratch every frame once the arena has been reset.
+    struct FrameLists {
+        explicit FrameLists(std::pmr::memory_resource* resource)
+            : shadowDrawList(resource), refractionDrawList(resource), mainDrawList(resource),
+            portalDrawList(resource), interiorDrawList(resource), drawListMasks(resource), recordTasks(resource), recordedSecondaries(resource), passSecondaries(resource) {
+        }
+
+        // Culled per-pass object lists, filled by BuildDrawLists
+        std::pmr::vector<DrawItem> shadowDrawList;
+        std::pmr::vector<DrawItem> refractionDrawList;
+        std::pmr::vector<DrawItem> mainDrawList;
+        std::pmr::vector<DrawItem> portalDrawList;   // Main pass: crystal balls stenciled before the interior
+        std::pmr::vector<DrawItem> interiorDrawList; // Main pass: interior-only objects, stencil tested
+        std::pmr::vector<uint8_t> drawListMasks; // Per object: which of the lists above it belongs to
+
+        std::pmr::vector<RecordTask> recordTasks;
+        std::pmr::vector<VkCommandBuffer> recordedSecondaries; // Indexed like recordTasks
+        std::pmr::vector<VkCommandBuffer> passSecondaries;     // Scratch for ExecuteSecondaries
+    };
+
+    std::vector<std::unique_ptr<FrameArena>> frameArenas; // One per frame in flight, reset once its fence signals
+    std::optional<FrameLists> frameLists;
+
     // --- 4. Primitives ---
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr size_t CULL_GRAIN = 64;
+    static constexpr size_t DRAWS_PER_SECONDARY = 32;
+    static constexpr uint32_t MAX_TEXTURE_SETS = 1024; // Distinct object textures, stress scenes can ask for hundreds
+    static constexpr uint32_t REFRACTION_BINDING = 2;  // Where the global set samples the refraction target
+    // Render graph images
+    RenderGraph::ImageHandle shadowMapTarget = 0;
+    RenderGraph::ImageHandle swapChainTarget = 0;
+    RenderGraph::ImageHandle refractionTarget = 0;
+    RenderGraph::ImageHandle sceneDepthTarget = 0;
+    RenderGraph::ImageHandle refractionDepthTarget = 0; // The scene depth unless refraction renders below full resolution
+
+    // Refraction: the frame being recorded renders it (into refractionScissor) or reuses the last render,
+    // which was made from refractionViewProj refractionAge frames ago
+    VkExtent2D refractionExtent{ 0, 0 };
+    VkRect2D refractionScissor{};
+    glm::mat4 refractionViewProj = glm::mat4(1.0f);
+    uint32_t refractionAge = 0;
+    bool refractionHistoryValid = false;
+    bool refractionActive = false;
+
+    // Portal: whether the frame being recorded stencils the interior, and the camera frustum narrowed
+    // to the crystal balls' screen rect (only meaningful while one is visible)
+    bool portalMasked = false;
+    bool portalVisible = false;
+    Frustum portalFrustum;
+
+    static constexpr uint32_t PORTAL_STENCIL = 1;           // Stencil value the crystal ball leaves behind
+    static constexpr float REFRACTION_DISTORTION = 0.40f; // Furthest shader.frag offsets a refraction lookup, in UV
+    uint32_t particleResolutionDivisor = 1;
+    float refractionScale = 1.0f;
+    uint32_t refractionInterval = 1;
+    bool portalStencil = true;
+    VkFormat depthFormat = VK_FORMAT_D32_SFLOAT; // Of the scene depth, chosen with the render pass
+    uint32_t headlessImageIndex = 0; // Next target when the swap chain is headless
+    uint32_t frameImageIndex = 0;    // Swap chain image the frame being recorded renders into
     bool framebufferResized = false;
 
     // --- Methods ---
-    void CreateParticlePipelines();
+    void CreateParticlePass(PipelineBatch& pipelines);
+    void CreateLowResParticlePass(PipelineBatch& pipelines);
+    void DestroyLowResParticlePass();
     void CreateTextureDescriptorSetLayout();
     void CreateTextureDescriptorPool();
     void CreateDefaultTexture();
     VkDescriptorSet GetTextureDescriptorSet(const std::string& path);
 
     void CreateRenderPass();
-    void CreateShadowPass();
-    void CreatePipeline();
-    void CreateOffScreenResources();
+    void CreateShadowPass(PipelineBatch& pipelines);
+    void CreatePipeline(PipelineBatch& pipelines);
+    void CreateRefractionSampler();
+    // Declares and compiles the frame's passes at the swap chain's size, then builds everything over its images
+    void BuildRenderGraph();
+    void CreateFramebuffers(); // Main (one per swap chain image) and refraction, over the render graph's images
+    void DestroyFramebuffers();
     void CreateCommandBuffer();
     void CreateSyncObjects();
     void CreateUniformBuffers();
 
-    void RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex, uint32_t currentFrame, const Scene& scene, const glm::mat4& viewMatrix, const glm::mat4& projMatrix, int layerMask);
+    void RecordCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex, uint32_t currentFrame, const RenderSnapshot& snapshot);
+
+    // Helper to reduce code duplication. Refraction and main share a render pass; refraction has its own viewport and scissor.
+    void BeginRenderPass(VkCommandBuffer cmd, RecordPass pass, VkFramebuffer fb, const VkClearValue* clearValues, uint32_t clearCount, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
+    void SetViewportAndScissor(VkCommandBuffer cmd, RecordPass pass) const;
+
+    // NDC rect covering every crystal ball (shading mode 3) on screen with the camera outside it.
+    // False when there are none. Its back faces are culled, so from inside one it doesn't show.
+    bool ProjectPortals(const RenderSnapshot& snapshot, const Frustum& cameraFrustum, glm::vec2& ndcMin, glm::vec2& ndcMax) const;
+    // Decides whether this frame renders the refraction target and where: scissored to the portals' rect
+    void PlanRefraction(bool visible, const glm::vec2& ndcMin, const glm::vec2& ndcMax, const glm::mat4& viewProj);
+    // Decides whether this frame stencils the interior and narrows its culling frustum to the portals' rect
+    void PlanPortal(const RenderSnapshot& snapshot, bool visible, const glm::vec2& ndcMin, const glm::vec2& ndcMax, const glm::mat4& viewProj);
+
+    // Frustum culls every object against the camera and light and sorts the survivors into per-pass lists
+    void BuildDrawLists(const RenderSnapshot& snapshot, const Frustum& cameraFrustum, const Frustum& lightFrustum);
 
-    // Helper to reduce code duplication
-    void BeginRenderPass(VkCommandBuffer cmd, VkRenderPass pass, VkFramebuffer fb, const std::vector<VkClearValue>& clearValues) const;
+    void DrawSceneObjects(VkCommandBuffer cmd, const std::pmr::vector<DrawItem>& drawList, size_t begin, size_t end, VkPipelineLayout layout, bool bindTextures, RenderStats::Counters& counters) const;
 
-    void RenderShadowMap(VkCommandBuffer cmd, uint32_t currentFrame, const Scene& scene, int layerMask = SceneLayers::ALL);
-    void DrawSceneObjects(VkCommandBuffer cmd, const Scene& scene, VkPipelineLayout layout, bool bindTextures, bool skipIfNotCastingShadow, int layerMask);
-    void RenderScene(VkCommandBuffer cmd, uint32_t currentFrame, const Scene& scene, int layerMask);
-    void RenderRefractionPass(VkCommandBuffer cmd, uint32_t currentFrame, const Scene& scene, int layerMask);
+    // Records every pass's secondary buffers for this frame in parallel
+    void RecordSecondaries(uint32_t currentFrame, const RenderSnapshot& snapshot);
+    VkCommandBuffer RecordSecondary(const RecordTask& task, uint32_t currentFrame, const RenderSnapshot& snapshot) const;
+    void ExecuteSecondaries(VkCommandBuffer cmd, RecordPass pass);
 
-    void CopyOffScreenToSwapChain(VkCommandBuffer cmd, uint32_t imageIndex) const;
-    void CleanupOffScreenResources();
+    void RenderShadowMap(VkCommandBuffer cmd);
+    void RenderScene(VkCommandBuffer cmd);
+    void RenderRefractionPass(VkCommandBuffer cmd);
+    void RenderLowResParticles(VkCommandBuffer cmd, uint32_t currentFrame);
 };
\ No newline at end of file
@@ -1,12 +1,16 @@
 #include "Scene.h"
 #include "ParticleLibrary.h"
 #include "../geometry/OBJLoader.h"
+#include "../core/JobSystem.h"
+#include "../core/AllocationTracker.h"
+#include "../core/CpuProfiler.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/common.hpp>
 #include <iostream>
 #include <algorithm>
 #include <random>
+#include <limits>
 
 static void UpdateShadingMode(SceneObject* obj) {
     if (!obj || !obj->geometry) return;
@@ -22,10 +26,31 @@ static void UpdateShadingMode(SceneObject* obj) {
     }
 }
 
+static glm::vec3 OrbitPosition(const OrbitData& data, float angle) {
+    const glm::quat rotation = glm::angleAxis(angle, data.axis);
+    const glm::vec3 offset = rotation * glm::vec3(data.radius, 0.0f, 0.0f);
+    return data.center + offset;
+}
+
+static void UpdateBounds(SceneObject* obj) {
+    if (!obj || !obj->geometry || obj->geometry->VertexCount() == 0) return;
+
+    glm::vec3 minPos(std::numeric_limits<float>::max());
+    glm::vec3 maxPos(std::numeric_limits<float>::lowest());
+    for (const auto& v : obj->geometry->GetVertices()) {
+        minPos = glm::min(minPos, v.pos);
+        maxPos = glm::max(maxPos, v.pos);
+    }
+
+    obj->localBoundsCenter = (minPos + maxPos) * 0.5f;
+    obj->localBoundsRadius = glm::length(maxPos - minPos) * 0.5f;
+}
+
 void Scene::AddObjectInternal(const std::string& name, std::unique_ptr<Geometry> geometry, const glm::vec3& position, const std::string& texturePath) {
     auto obj = std::make_unique<SceneObject>(std::move(geometry), texturePath, name);
     obj->transform = glm::translate(glm::mat4(1.0f), position);
     UpdateShadingMode(obj.get());
+    UpdateBounds(obj.get());
     objects.push_back(std::move(obj));
 }
 
@@ -43,7 +68,7 @@ float Scene::RadiusAdjustment(const float radius, const float deltaY) const {
 }
 
 Scene::Scene(VkDevice vkDevice, VkPhysicalDevice physDevice)
-    : device(vkDevice), physicalDevice(physDevice) {
+    : device(vkDevice), physicalDevice(physDevice), particleBudget(PARTICLE_BUDGET) {
 }
 
 // Destructor implementation removed (now = default in header)
@@ -65,9 +90,6 @@ void Scene::GenerateProceduralObjects(int count, float terrainRadius, float delt
     float totalFreq = 0.0f;
     for (const auto& item : proceduralRegistry) totalFreq += item.frequency;
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
     std::uniform_real_distribution<float> distAngle(0.0f, glm::two_pi<float>());
     std::uniform_real_distribution<float> distFreq(0.0f, totalFreq);
     std::uniform_real_distribution<float> distScale(0.0f, 1.0f);
@@ -75,8 +97,8 @@ void Scene::GenerateProceduralObjects(int count, float terrainRadius, float delt
 
     for (int i = 0; i < count; i++) {
         // 1. Pick Position
-        const float r = std::sqrt(distScale(gen)) * (terrainRadius * 0.9f);
-        const float theta = distAngle(gen);
+        const float r = std::sqrt(distScale(rng)) * (terrainRadius * 0.9f);
+        const float theta = distAngle(rng);
         const float x = r * cos(theta);
         const float z = r * sin(theta);
 
@@ -85,7 +107,7 @@ void Scene::GenerateProceduralObjects(int count, float terrainRadius, float delt
         const float y = deltaY + yOffset;
 
         // 3. Select Object
-        const float pick = distFreq(gen);
+        const float pick = distFreq(rng);
         float current = 0.0f;
         int selectedIndex = 0;
         for (int k = 0; k < proceduralRegistry.size(); k++) {
@@ -99,9 +121,9 @@ void Scene::GenerateProceduralObjects(int count, float terrainRadius, float delt
 
         // 4. Randomize Scale
         glm::vec3 scale;
-        scale.x = glm::mix(config.minScale.x, config.maxScale.x, distScale(gen));
-        scale.y = glm::mix(config.minScale.y, config.maxScale.y, distScale(gen));
-        scale.z = glm::mix(config.minScale.z, config.maxScale.z, distScale(gen));
+        scale.x = glm::mix(config.minScale.x, config.maxScale.x, distScale(rng));
+        scale.y = glm::mix(config.minScale.y, config.maxScale.y, distScale(rng));
+        scale.z = glm::mix(config.minScale.z, config.maxScale.z, distScale(rng));
 
         // 5. Spawn Object (with dummy rotation initially)
         const std::string name = "ProcObj_" + std::to_string(i);
@@ -118,7 +140,7 @@ void Scene::GenerateProceduralObjects(int count, float terrainRadius, float delt
 
             // B. Apply World Yaw (Random Rotation around Y)
             // This spins the object "in place" relative to the world, keeping it upright
-            const float randomYaw = distRot(gen);
+            const float randomYaw = distRot(rng);
             m = glm::rotate(m, glm::radians(randomYaw), glm::vec3(0.0f, 1.0f, 0.0f));
 
             // C. Apply Base Rotation Correction (e.g. Stand up the cactus)
@@ -189,6 +211,7 @@ void Scene::AddModel(const std::string& name, const glm::vec3& position, const g
 
         obj->transform = transform;
         UpdateShadingMode(obj.get());
+        UpdateBounds(obj.get());
 
         objects.push_back(std::move(obj));
     }
@@ -216,23 +239,11 @@ void Scene::AddLight(const std::string& name, const glm::vec3& position, const g
     m_SceneLights.push_back(newSceneLight);
 }
 
-void Scene::SetupParticleSystem(VkCommandPool commandPoolArg, VkQueue graphicsQueueArg,
-    GraphicsPipeline* additivePipeline, GraphicsPipeline* alphaPipeline,
-    VkDescriptorSetLayout layout, uint32_t framesInFlightArg) {
-    this->commandPool = commandPoolArg;
-    this->graphicsQueue = graphicsQueueArg;
-    this->particlePipelineAdditive = additivePipeline;
-    this->particlePipelineAlpha = alphaPipeline;
-    this->particleDescriptorLayout = layout;
-    this->framesInFlight = framesInFlightArg;
+void Scene::SetupParticleSystem(const ParticleAtlas* atlas) {
+    this->particleAtlas = atlas;
 
     for (const auto& sys : particleSystems) {
-        if (sys->IsAdditive()) {
-            sys->SetPipeline(particlePipelineAdditive);
-        }
-        else {
-            sys->SetPipeline(particlePipelineAlpha);
-        }
+        sys->SetAtlas(particleAtlas);
     }
 }
 
@@ -245,10 +256,9 @@ ParticleSystem* Scene::GetOrCreateSystem(const ParticleProps& props) {
     }
 
     // Create new system
-    auto newSys = std::make_unique<ParticleSystem>(device, physicalDevice, commandPool, graphicsQueue, 2000, framesInFlight);
-
-    GraphicsPipeline* const pipeline = props.isAdditive ? particlePipelineAdditive : particlePipelineAlpha;
-    newSys->Initialize(particleDescriptorLayout, pipeline, props.texturePath, props.isAdditive);
+    auto newSys = std::make_unique<ParticleSystem>(props.texturePath);
+    newSys->SetAtlas(particleAtlas);
+    newSys->SetRandomSeed(static_cast<uint32_t>(rng()));
 
     ParticleSystem* const ptr = newSys.get();
     particleSystems.push_back(std::move(newSys));
@@ -278,46 +288,36 @@ void Scene::AddSmoke(const glm::vec3& position, float scale) {
 }
 
 void Scene::AddRain() {
-    ParticleProps rain = ParticleLibrary::GetRainProps();
-    // Global effect: Emitter covers a large area high up
-    rain.position = glm::vec3(0.0f, 40.0f, 0.0f);
-    // Huge variance in X and Z to cover the map
-    rain.velocityVariation.x = 80.0f; // Width
-    rain.velocityVariation.z = 80.0f; // Depth
-
-    // Set bounds for rain (matches CrystalBall radius)
+    const ParticleProps& rain = ParticleLibrary::GetRainProps();
+
+    // Weather follows the camera: a fixed box of rain wraps around the viewer and is
+    // only drawn inside the crystal ball. From outside the ball it fills the whole ball.
     auto* const sys = GetOrCreateSystem(rain);
+    sys->SetWeatherVolume(glm::vec3(30.0f, 25.0f, 30.0f));
     sys->SetSimulationBounds(glm::vec3(0.0f), 150.0f);
+    sys->SetViewerPosition(viewerPosition);
     sys->AddEmitter(rain, 1000.0f); // Heavy rain
 }
 
 void Scene::AddSnow() {
-    ParticleProps snow = ParticleLibrary::GetSnowProps();
-    snow.position = glm::vec3(0.0f, 50.0f, 0.0f);
-
-    // CHANGE: Use Position Variation for area spawning, rather than Velocity Variation
-    // This allows them to spawn over a wide area but fall straight down gently
-    snow.positionVariation = glm::vec3(100.0f, 0.0f, 100.0f);
+    const ParticleProps& snow = ParticleLibrary::GetSnowProps();
 
-    // CHANGE: Reduced velocity variation for gentle drift
-    snow.velocityVariation = glm::vec3(1.0f, 0.2f, 1.0f);
-
-    // Set bounds for snow (matches CrystalBall radius)
+    // Snow falls slowly, so a flatter box keeps the same count dense around the viewer
     auto* const sys = GetOrCreateSystem(snow);
+    sys->SetWeatherVolume(glm::vec3(35.0f, 15.0f, 35.0f));
     sys->SetSimulationBounds(glm::vec3(0.0f), 150.0f);
+    sys->SetViewerPosition(viewerPosition);
     sys->AddEmitter(snow, 500.0f);
 }
 
 void Scene::AddDust() {
-    ParticleProps dust = ParticleLibrary::GetDustProps();
-    dust.position = glm::vec3(0.0f, 5.0f, 0.0f); // Near ground
-    dust.velocityVariation.x = 80.0f;
-    dust.velocityVariation.z = 80.0f;
-    dust.velocityVariation.y = 10.0f; // Height of dust cloud
+    const ParticleProps& dust = ParticleLibrary::GetDustProps();
 
-    // Set bounds for dust (matches CrystalBall radius)
+    // Fine dust is only visible close up
     auto* const sys = GetOrCreateSystem(dust);
+    sys->SetWeatherVolume(glm::vec3(15.0f, 6.0f, 15.0f));
     sys->SetSimulationBounds(glm::vec3(0.0f), 150.0f);
+    sys->SetViewerPosition(viewerPosition);
     sys->AddEmitter(dust, 200.0f);
 }
 
@@ -330,10 +330,9 @@ glm::vec3 Scene::InitializeOrbit(OrbitData& data, const glm::vec3& center, float
     data.axis = (axisLen > 1e-6f) ? glm::normalize(axis) : glm::vec3(0.0f, 1.0f, 0.0f);
     data.initialAngle = initialAngleRad;
     data.currentAngle = initialAngleRad;
+    data.previousAngle = initialAngleRad;
 
-    const glm::quat rot = glm::angleAxis(data.initialAngle, data.axis);
-    const glm::vec3 offset = rot * glm::vec3(data.radius, 0.0f, 0.0f);
-    return data.center + offset;
+    return OrbitPosition(data, data.initialAngle);
 }
 
 void Scene::SetObjectOrbit(const std::string& name, const glm::vec3& center, float radius, float speedRadPerSec, const glm::vec3& axis, float initialAngleRad) {
@@ -387,12 +386,13 @@ void Scene::SetOrbitSpeed(const std::string& name, float speedRadPerSec) {
 }
 
 void Scene::Update(float deltaTime) {
+    AllocationScope allocationScope("Scene::Update");
+    ProfileScope profileScope("Scene::Update");
 
     auto CalculateNewPos = [&](OrbitData& data) -> glm::vec3 {
+        data.previousAngle = data.currentAngle;
         data.currentAngle += data.speed * deltaTime;
-        glm::quat rotation = glm::angleAxis(data.currentAngle, data.axis);
-        glm::vec3 offset = rotation * glm::vec3(data.radius, 0.0f, 0.0f);
-        return data.center + offset;
+        return OrbitPosition(data, data.currentAngle);
         };
 
     for (auto& sceneLight : m_SceneLights) {
@@ -401,16 +401,114 @@ void Scene::Update(float deltaTime) {
         }
     }
 
+    // Each object only touches its own orbit and transform
+    ParallelFor(jobSystem, objects.size(), ORBIT_UPDATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            SceneObject& obj = *objects[i];
+            if (obj.orbitData.isOrbiting) {
+                const glm::vec3 newPos = CalculateNewPos(obj.orbitData);
+                obj.transform[3] = glm::vec4(newPos, 1.0f);
+            }
+        }
+        }, "Scene::UpdateOrbits");
+
+    // Budget first: it decides LOD, pause state and arena slices for this frame
+    particleBudget.Update(particleSystems, deltaTime);
+
+    // Systems own disjoint arena slices, so they can simulate concurrently
+    ParallelFor(jobSystem, particleSystems.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            particleSystems[i]->Update(deltaTime);
+        }
+        }, "ParticleSystem::Update");
+}
+
+void Scene::SetViewer(const glm::vec3& position, const glm::mat4& view, const glm::mat4& proj) {
+    viewerPosition = position;
+    viewerView = view;
+    viewerProj = proj;
+    particleBudget.SetViewer(position, view, proj);
+
+    // Weather volumes are centered on the camera
+    for (const auto& sys : particleSystems) {
+        sys->SetViewerPosition(position);
+    }
+}
+
+void Scene::BuildSnapshot(RenderSnapshot& snapshot, float interpolation) {
+    ProfileScope profileScope("Scene::BuildSnapshot");
+    snapshot.view = viewerView;
+    snapshot.proj = viewerProj;
+    snapshot.cameraPosition = viewerPosition;
+    snapshot.frameIndex = snapshotCount++;
+
+    snapshot.objects.clear();
     for (const auto& obj : objects) {
+        if (!obj || !obj->visible || !obj->geometry) continue;
+
+        RenderSnapshot::Object entry;
+        entry.geometry = obj->geometry.get();
+        entry.texturePath = &obj->texturePath;
+        entry.name = &obj->name;
+        entry.transform = obj->transform;
         if (obj->orbitData.isOrbiting) {
-            const glm::vec3 newPos = CalculateNewPos(obj->orbitData);
-            obj->transform[3] = glm::vec4(newPos, 1.0f);
+            // Interpolate along the arc rather than the chord between steps
+            const OrbitData& orbit = obj->orbitData;
+            const float angle = glm::mix(orbit.previousAngle, orbit.currentAngle, interpolation);
+            entry.transform[3] = glm::vec4(OrbitPosition(orbit, angle), 1.0f);
         }
+        entry.localBoundsCenter = obj->localBoundsCenter;
+        entry.localBoundsRadius = obj->localBoundsRadius;
+        entry.shadingMode = obj->shadingMode;
+        entry.layerMask = obj->layerMask;
+        entry.castsShadow = obj->castsShadow;
+        entry.receiveShadows = obj->receiveShadows;
+        snapshot.objects.push_back(entry);
     }
 
-    for (const auto& sys : particleSystems) {
-        sys->Update(deltaTime);
+    snapshot.lights.clear();
+    for (const auto& sceneLight : m_SceneLights) {
+        Light light = sceneLight.vulkanLight;
+        if (sceneLight.orbitData.isOrbiting) {
+            const OrbitData& orbit = sceneLight.orbitData;
+            light.position = OrbitPosition(orbit, glm::mix(orbit.previousAngle, orbit.currentAngle, interpolation));
+        }
+        snapshot.lights.push_back(light);
+    }
+
+    // Particles: each system fills its own scratch pair, so gathering needs no synchronization
+    if (systemAdditiveInstances.size() < particleSystems.size()) {
+        systemAdditiveInstances.resize(particleSystems.size());
+        systemAlphaInstances.resize(particleSystems.size());
     }
+
+    ParallelFor(jobSystem, particleSystems.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            systemAdditiveInstances[i].clear();
+            systemAlphaInstances[i].clear();
+
+            // Paused systems are entirely off-screen
+            if (particleSystems[i]->IsPaused()) continue;
+            particleSystems[i]->AppendInstances(viewerPosition, interpolation, systemAdditiveInstances[i], systemAlphaInstances[i]);
+        }
+        }, "Scene::GatherParticles");
+
+    snapshot.additiveParticles.clear();
+    snapshot.alphaParticles.clear();
+    snapshot.particleSystems.resize(particleSystems.size());
+    for (size_t i = 0; i < particleSystems.size(); ++i) {
+        snapshot.additiveParticles.insert(snapshot.additiveParticles.end(), systemAdditiveInstances[i].begin(), systemAdditiveInstances[i].end());
+        snapshot.alphaParticles.insert(snapshot.alphaParticles.end(), systemAlphaInstances[i].begin(), systemAlphaInstances[i].end());
+
+        particleSystems[i]->ReportStats(snapshot.particleSystems[i]);
+        snapshot.particleSystems[i].drawnParticles = static_cast<uint32_t>(systemAdditiveInstances[i].size() + systemAlphaInstances[i].size());
+    }
+
+    // Alpha blending is order dependent: draw farthest first (position.w holds the squared distance)
+    std::sort(snapshot.alphaParticles.begin(), snapshot.alphaParticles.end(),
+        [](const ParticleSystem::InstanceData& a, const ParticleSystem::InstanceData& b) {
+            return a.position.w > b.position.w;
+        });
 }
 
 std::vector<Light> Scene::GetLights() const {
@@ -430,6 +528,7 @@ void Scene::Clear() {
     }
     objects.clear();
     particleSystems.clear();
+    particleBudget.Reset();
 }
 
 void Scene::SetObjectTransform(size_t index, const glm::mat4& transform) {
@@ -4,10 +4,15 @@
 #include "../geometry/GeometryGenerator.h"
 #include <vector>
 #include <memory>
+#include <random>
 #include <glm/glm.hpp>
 #include <string>
 #include "../vulkan/UniformBufferObject.h"
 #include "ParticleSystem.h"
+#include "ParticleBudget.h"
+#include "RenderSnapshot.h"
+
+class JobSystem;
 
 struct OrbitData {
     bool isOrbiting = false;
@@ -17,6 +22,7 @@ struct OrbitData {
     glm::vec3 axis = glm::vec3(0.0f, 1.0f, 0.0f); // Normalized orbit axis
     float initialAngle = 0.0f; // Initial angle offset (in radians)
     float currentAngle = 0.0f; // Internal state: current angle (in radians)
+    float previousAngle = 0.0f; // Internal state: angle at the previous simulation step, for render interpolation
 };
 
 namespace SceneLayers {
@@ -53,6 +59,10 @@ struct SceneObject {
 
     int layerMask = SceneLayers::INSIDE;
 
+    // Object-space bounding sphere of the geometry, used for culling
+    glm::vec3 localBoundsCenter = glm::vec3(0.0f);
+    float localBoundsRadius = 0.0f;
+
     explicit SceneObject(std::unique_ptr<Geometry> geo, const std::string& texPath = "", const std::string& objName = "")
         : name(objName), geometry(std::move(geo)), texturePath(texPath) {
     }
@@ -94,9 +104,12 @@ public:
     void AddBowl(const std::string& name, float radius, int slices, int stacks, const glm::vec3& position, const std::string& texturePath);
     void AddPedestal(const std::string& name, float topRadius, float baseWidth, float height, const glm::vec3& position, const std::string& texturePath);
 
-    void SetupParticleSystem(VkCommandPool commandPoolArg, VkQueue graphicsQueueArg,
-        GraphicsPipeline* additivePipeline, GraphicsPipeline* alphaPipeline,
-        VkDescriptorSetLayout layout, uint32_t framesInFlightArg);
+    // Points every particle system at the renderer's shared atlas (re-run after the renderer is rebuilt)
+    void SetupParticleSystem(const ParticleAtlas* atlas);
+
+    // Reseeds procedural placement and every particle system created afterwards, so a run can be
+    // reproduced. Call before populating the scene; the default seed is random.
+    void SetRandomSeed(uint32_t seed) { rng.seed(seed); }
 
     // Procedural Generation API
     void RegisterProceduralObject(const std::string& modelPath, const std::string& texturePath, float frequency, const glm::vec3& minScale, const glm::vec3& maxScale, const glm::vec3& baseRotation = glm::vec3(0.0f));
@@ -112,8 +125,19 @@ public:
     // Accessors for Renderer
     const std::vector<std::unique_ptr<ParticleSystem>>& GetParticleSystems() const { return particleSystems; }
 
+    // Camera used for particle LOD, culling and weather volumes (call before Update)
+    void SetViewer(const glm::vec3& position, const glm::mat4& view, const glm::mat4& proj);
+    const ParticleBudget& GetParticleBudget() const { return particleBudget; }
+
+    // Orbits, particle simulation and snapshot particle gathering are split across the job system when one is set
+    void SetJobSystem(JobSystem* jobSystemArg) { jobSystem = jobSystemArg; }
     void Update(float deltaTime);
 
+    // Copies this frame's render state (camera, visible objects, lights, particle instances)
+    // into snapshot, reusing its storage. The caller fills in snapshot.layerMask.
+    // interpolation blends orbits and particles from the previous Update (0) to the latest (1).
+    void BuildSnapshot(RenderSnapshot& snapshot, float interpolation = 1.0f);
+
     // Changed return type to non-const to allow Move Semantics (Fix OPT.33)
     std::vector<Light> GetLights() const;
 
@@ -149,12 +173,24 @@ private:
     ParticleSystem* GetOrCreateSystem(const ParticleProps& props);
 
     // Particle Resources
-    VkCommandPool commandPool = VK_NULL_HANDLE;
-    VkQueue graphicsQueue = VK_NULL_HANDLE;
-    GraphicsPipeline* particlePipelineAdditive = nullptr;
-    GraphicsPipeline* particlePipelineAlpha = nullptr;
-    VkDescriptorSetLayout particleDescriptorLayout = VK_NULL_HANDLE;
-    uint32_t framesInFlight = 2;
+    const ParticleAtlas* particleAtlas = nullptr;
 
     std::vector<std::unique_ptr<ParticleSystem>> particleSystems;
+
+    // Shared particle arena, split between all systems
+    static constexpr uint32_t PARTICLE_BUDGET = 16384;
+    ParticleBudget particleBudget;
+    glm::vec3 viewerPosition = glm::vec3(0.0f);
+    glm::mat4 viewerView = glm::mat4(1.0f);
+    glm::mat4 viewerProj = glm::mat4(1.0f);
+    uint64_t snapshotCount = 0;
+    std::mt19937 rng{ std::random_device{}() };
+
+    // Per-system instance scratch for BuildSnapshot, merged into the snapshot afterwards
+    std::vector<std::vector<ParticleSystem::InstanceData>> systemAdditiveInstances;
+    std::vector<std::vector<ParticleSystem::InstanceData>> systemAlphaInstances;
+
+    JobSystem* jobSystem = nullptr;
+
+    static constexpr size_t ORBIT_UPDATE_GRAIN = 64;
 };
\ No newline at end of file
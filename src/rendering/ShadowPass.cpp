@@ -2,20 +2,19 @@
 #include "../vulkan/Vertex.h"
 #include "../vulkan/VulkanUtils.h"
 #include <stdexcept>
-#include <array>
 
 ShadowPass::ShadowPass(VulkanDevice* deviceArg, uint32_t widthArg, uint32_t heightArg)
     : device(deviceArg), extent{ widthArg, heightArg } {
 }
 
-void ShadowPass::Initialize(VkDescriptorSetLayout globalSetLayout) {
+void ShadowPass::Initialize(VkDescriptorSetLayout globalSetLayout, PipelineBatch& pipelines) {
     CreateResources();
     CreateRenderPass();
     CreateFramebuffer();
-    CreatePipeline(globalSetLayout);
+    CreatePipeline(globalSetLayout, pipelines);
 }
 
-void ShadowPass::Begin(VkCommandBuffer cmd) const {
+void ShadowPass::Begin(VkCommandBuffer cmd, RenderStats::Counters& counters, VkSubpassContents contents) const {
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassInfo.renderPass = renderPass;
@@ -28,9 +27,16 @@ void ShadowPass::Begin(VkCommandBuffer cmd) const {
     renderPassInfo.clearValueCount = 1;
     renderPassInfo.pClearValues = &clearValue;
 
-    vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(cmd, &renderPassInfo, contents);
 
+    if (contents == VK_SUBPASS_CONTENTS_INLINE) {
+        BindState(cmd, counters);
+    }
+}
+
+void ShadowPass::BindState(VkCommandBuffer cmd, RenderStats::Counters& counters) const {
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetPipeline());
+    ++counters.pipelineBinds;
 
     VkViewport viewport{};
     viewport.width = static_cast<float>(extent.width);
@@ -96,7 +102,7 @@ void ShadowPass::CreateRenderPass() {
     attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL; // The render graph moves it on to its readers
 
     VkAttachmentReference depthRef{};
     depthRef.attachment = 0;
@@ -106,32 +112,13 @@ void ShadowPass::CreateRenderPass() {
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.pDepthStencilAttachment = &depthRef;
 
-    std::array<VkSubpassDependency, 2> dependencies{};
-
-    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[0].dstSubpass = 0;
-    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    dependencies[1].srcSubpass = 0;
-    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
+    // No external dependencies: the render graph's barriers order every access to the map
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &attachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
-    renderPassInfo.pDependencies = dependencies.data();
 
     if (vkCreateRenderPass(device->GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
         throw std::runtime_error("failed to create shadow render pass!");
@@ -153,7 +140,7 @@ void ShadowPass::CreateFramebuffer() {
     }
 }
 
-void ShadowPass::CreatePipeline(VkDescriptorSetLayout globalSetLayout) {
+void ShadowPass::CreatePipeline(VkDescriptorSetLayout globalSetLayout, PipelineBatch& pipelines) {
     auto bindingDescription = Vertex::getBindingDescription();
     auto attributeDescriptions = Vertex::getAttributeDescriptions();
 
@@ -176,7 +163,7 @@ void ShadowPass::CreatePipeline(VkDescriptorSetLayout globalSetLayout) {
     config.depthWriteEnable = true;
 
     pipeline = std::make_unique<GraphicsPipeline>(device->GetDevice(), config);
-    pipeline->Create();
+    pipelines.Add(pipeline.get());
 }
 
 void ShadowPass::Cleanup() {
@@ -6,6 +6,7 @@
 #include "../rendering/GraphicsPipeline.h"
 #include "../vulkan/VulkanDevice.h"
 #include "../vulkan/VulkanUtils.h"
+#include "RenderStats.h"
 
 class ShadowPass final {
 public:
@@ -15,15 +16,23 @@ public:
     ShadowPass(const ShadowPass&) = delete;
     ShadowPass& operator=(const ShadowPass&) = delete;
 
-    void Initialize(VkDescriptorSetLayout globalSetLayout);
+    // The pipeline is added to pipelines and exists once the batch has been created
+    void Initialize(VkDescriptorSetLayout globalSetLayout, PipelineBatch& pipelines);
     void Cleanup();
 
-    void Begin(VkCommandBuffer cmd) const;
+    // With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS only the pass is begun and each
+    // secondary buffer must call BindState itself
+    void Begin(VkCommandBuffer cmd, RenderStats::Counters& counters, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
+    // Pipeline, viewport, scissor and depth bias for drawing shadow casters
+    void BindState(VkCommandBuffer cmd, RenderStats::Counters& counters) const;
     void End(VkCommandBuffer cmd) const { vkCmdEndRenderPass(cmd); }
 
+    // Left as a depth attachment; readers transition it through the render graph
+    VkImage GetShadowImage() const { return shadowImage; }
     VkImageView GetShadowImageView() const { return shadowImageView; }
     VkSampler GetShadowSampler() const { return shadowSampler; }
     VkRenderPass GetRenderPass() const { return renderPass; }
+    VkFramebuffer GetFramebuffer() const { return framebuffer; }
     GraphicsPipeline* GetPipeline() const { return pipeline.get(); }
     const VkExtent2D& GetExtent() const { return extent; }
 
@@ -41,5 +50,5 @@ private:
     void CreateResources();
     void CreateRenderPass();
     void CreateFramebuffer();
-    void CreatePipeline(VkDescriptorSetLayout globalSetLayout);
+    void CreatePipeline(VkDescriptorSetLayout globalSetLayout, PipelineBatch& pipelines);
 };
\ No newline at end of file
@@ -55,7 +55,7 @@ std::vector<std::string> SkyboxPass::GetSkyboxFaces(const std::string& name) con
     return faces;
 }
 
-void SkyboxPass::Initialize(VkRenderPass renderPass, const VkExtent2D& extent, VkDescriptorSetLayout globalSetLayout) {
+void SkyboxPass::Initialize(VkRenderPass renderPass, const VkExtent2D& extent, VkDescriptorSetLayout globalSetLayout, PipelineBatch& pipelines) {
     // 1. Initialize Cubemap
     cubemap = std::make_unique<Cubemap>(device, physicalDevice, commandPool, graphicsQueue);
 
@@ -91,10 +91,10 @@ void SkyboxPass::Initialize(VkRenderPass renderPass, const VkExtent2D& extent, V
     config.depthWriteEnable = false;
 
     pipeline = std::make_unique<GraphicsPipeline>(device, config);
-    pipeline->Create();
+    pipelines.Add(pipeline.get());
 }
 
-void SkyboxPass::Draw(VkCommandBuffer cmd, const Scene& scene, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet) const {
+void SkyboxPass::Draw(VkCommandBuffer cmd, const RenderSnapshot& snapshot, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet, RenderStats::Counters& counters) const {
     (void)currentFrame; // suppress unused param warning
 
     if (!pipeline || !cubemap) return;
@@ -107,21 +107,25 @@ void SkyboxPass::Draw(VkCommandBuffer cmd, const Scene& scene, uint32_t currentF
     // Bind Cubemap (Set 1)
     const VkDescriptorSet skySet = cubemap->GetDescriptorSet();
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetLayout(), 1, 1, &skySet, 0, nullptr);
+    ++counters.pipelineBinds;
+    counters.descriptorSetBinds += 2;
 
     // Render objects marked with shadingMode = 2 (Skybox) OR 3 (Combined)
-    for (const auto& obj : scene.GetObjects()) {
+    for (const auto& obj : snapshot.objects) {
         // UPDATE: Allow mode 3 to be drawn by this pass (for the inside view)
-        if (!obj->visible || !obj->geometry || (obj->shadingMode != 2 && obj->shadingMode != 3)) continue;
+        if (obj.shadingMode != 2 && obj.shadingMode != 3) continue;
 
         PushConstantObject pco{};
-        pco.model = obj->transform;
+        pco.model = obj.transform;
         // For the inside view, we force Mode 2 (Pure Skybox) look
         pco.shadingMode = 2;
 
         vkCmdPushConstants(cmd, pipeline->GetLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantObject), &pco);
 
-        obj->geometry->Bind(cmd);
-        obj->geometry->Draw(cmd);
+        obj.geometry->Bind(cmd);
+        obj.geometry->Draw(cmd);
+        ++counters.pushConstants;
+        counters.GeometryDraw(*obj.geometry);
     }
 }
 
@@ -6,7 +6,8 @@
 #include <string>
 #include "Cubemap.h"
 #include "GraphicsPipeline.h"
-#include "Scene.h"
+#include "RenderSnapshot.h"
+#include "RenderStats.h"
 
 class SkyboxPass final {
 public:
@@ -17,8 +18,9 @@ public:
     SkyboxPass(const SkyboxPass&) = delete;
     SkyboxPass& operator=(const SkyboxPass&) = delete;
 
-    void Initialize(VkRenderPass renderPass, const VkExtent2D& extent, VkDescriptorSetLayout globalSetLayout);
-    void Draw(VkCommandBuffer cmd, const Scene& scene, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet) const;
+    // The pipeline is added to pipelines and exists once the batch has been created
+    void Initialize(VkRenderPass renderPass, const VkExtent2D& extent, VkDescriptorSetLayout globalSetLayout, PipelineBatch& pipelines);
+    void Draw(VkCommandBuffer cmd, const RenderSnapshot& snapshot, uint32_t currentFrame, VkDescriptorSet globalDescriptorSet, RenderStats::Counters& counters) const;
     void Cleanup();
 
     Cubemap* GetCubemap() const { return cubemap.get(); }
@@ -6,7 +6,16 @@
 #include <algorithm>
 #include <iostream>
 #include <utility>
-
+#include <cmath>
+#include <cstdlib>
+#include "../core/AllocationTracker.h"
+#include "../core/CpuProfiler.h"
+#include "../core/HitchDetector.h"
+
+// Route stb_image's allocations through the tracker so image decoding shows up in its reports
+#define STBI_MALLOC(size) AllocationTracker::Allocate(size)
+#define STBI_REALLOC(pointer, newSize) AllocationTracker::Reallocate(pointer, newSize)
+#define STBI_FREE(pointer) AllocationTracker::Free(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -54,11 +63,26 @@ Texture& Texture::operator=(Texture&& other) noexcept {
 }
 
 bool Texture::LoadFromFile(const std::string& filepath) {
+    AllocationScope allocationScope("TextureLoading");
+    ProfileScope profileScope("Texture::LoadFromFile");
+    HitchScope hitchScope(HitchDetector::Category::TextureLoad, "Texture::LoadFromFile", filepath.c_str());
     int texWidth = 0, texHeight = 0, texChannels = 0;
-    stbi_uc* pixels = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    stbi_uc* pixels = nullptr;
     bool usedStbLoaded = true;
     bool manualAlloc = false;
 
+    if (filepath.compare(0, std::char_traits<char>::length(GENERATED_PREFIX), GENERATED_PREFIX) == 0) {
+        pixels = GenerateChecker(std::strtoul(filepath.c_str() + std::char_traits<char>::length(GENERATED_PREFIX), nullptr, 10));
+        texWidth = GENERATED_SIZE;
+        texHeight = GENERATED_SIZE;
+        texChannels = 4;
+        usedStbLoaded = false;
+        manualAlloc = true;
+    }
+    else {
+        pixels = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    }
+
     if (!pixels) {
         const std::string defaultTexturePath = "textures/default.jpg";
         std::cerr << "Warning: Failed to load texture '" << filepath << "'. Attempting default texture '" << defaultTexturePath << "'.\n";
@@ -168,6 +192,29 @@ bool Texture::LoadFromFile(const std::string& filepath) {
     return true;
 }
 
+unsigned char* Texture::GenerateChecker(unsigned long index) {
+    // Hue from the index (golden-ratio steps keep neighbouring indices apart), 32-texel squares
+    const float hue = std::fmod(static_cast<float>(index) * 0.618034f, 1.0f) * 6.0f;
+    const float channels[3] = {
+        std::clamp(std::abs(hue - 3.0f) - 1.0f, 0.0f, 1.0f),
+        std::clamp(2.0f - std::abs(hue - 2.0f), 0.0f, 1.0f),
+        std::clamp(2.0f - std::abs(hue - 4.0f), 0.0f, 1.0f)
+    };
+
+    unsigned char* const pixels = new unsigned char[static_cast<size_t>(GENERATED_SIZE) * GENERATED_SIZE * 4];
+    for (int y = 0; y < GENERATED_SIZE; ++y) {
+        for (int x = 0; x < GENERATED_SIZE; ++x) {
+            const float shade = ((x / 32 + y / 32) % 2) ? 1.0f : 0.35f;
+            unsigned char* const texel = pixels + (static_cast<size_t>(y) * GENERATED_SIZE + x) * 4;
+            for (int c = 0; c < 3; ++c) {
+                texel[c] = static_cast<unsigned char>(255.0f * shade * (0.25f + 0.75f * channels[c]));
+            }
+            texel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
 void Texture::Cleanup() {
     VulkanUtils::CleanupImageResources(device, image, imageMemory, imageView, sampler);
 }
\ No newline at end of file
@@ -19,8 +19,13 @@ public:
     Texture& operator=(Texture&& other) noexcept;
 
     // Loads file via stb_image, uploads to GPU, creates image view + sampler.
+    // A path starting with GENERATED_PREFIX ("generated:7") builds a checkerboard instead, tinted
+    // by the number after the prefix, so stress scenes can ask for any number of distinct textures.
     bool LoadFromFile(const std::string& filepath);
 
+    static constexpr const char* GENERATED_PREFIX = "generated:";
+    static constexpr int GENERATED_SIZE = 512;
+
     VkImageView GetImageView() const { return imageView; }
     VkSampler GetSampler() const { return sampler; }
     VkImage GetImage() const { return image; }
@@ -28,6 +33,9 @@ public:
     void Cleanup();
 
 private:
+    // GENERATED_SIZE squared RGBA texels, allocated with new[]
+    static unsigned char* GenerateChecker(unsigned long index);
+
     VkDevice device;
     VkPhysicalDevice physicalDevice;
     VkCommandPool commandPool;
@@ -0,0 +1,32 @@
+#version 450
+
+layout(location = 0) in vec2 inUV;
+
+layout(set = 0, binding = 0) uniform sampler2D sceneDepth;
+
+layout(location = 0) out float outDepth;
+
+const int MAX_FOOTPRINT = 4; // Quarter resolution
+
+void main() {
+    ivec2 fullSize = textureSize(sceneDepth, 0);
+
+    // The fullscreen UV steps by exactly one low-res texel per pixel, so this is the downsample factor
+    ivec2 footprint = clamp(ivec2(round(fwidth(inUV) * vec2(fullSize))), ivec2(1), ivec2(MAX_FOOTPRINT));
+    ivec2 base = ivec2(gl_FragCoord.xy) * footprint;
+
+    // Keep the farthest depth: particles are never wrongly hidden by thin foreground,
+    // and the nearest-depth upsample rejects them again at the full-res edge
+    float farthest = 0.0;
+    for (int y = 0; y < MAX_FOOTPRINT; ++y) {
+        if (y >= footprint.y) break;
+        for (int x = 0; x < MAX_FOOTPRINT; ++x) {
+            if (x >= footprint.x) break;
+            ivec2 coord = min(base + ivec2(x, y), fullSize - 1);
+            farthest = max(farthest, texelFetch(sceneDepth, coord, 0).r);
+        }
+    }
+
+    outDepth = farthest;
+    gl_FragDepth = farthest;
+}
@@ -1,9 +1,9 @@
 #version 450
 
 layout(location = 0) in vec4 fragColor;
-layout(location = 1) in vec2 fragUV;
+layout(location = 1) in vec3 fragUV; // xy = atlas UV, z = layer
 
-layout(set = 1, binding = 0) uniform sampler2D texSampler;
+layout(set = 1, binding = 0) uniform sampler2DArray texSampler; // Shared particle atlas
 
 layout(location = 0) out vec4 outColor;
 
@@ -6,7 +6,8 @@ layout(location = 1) in vec2 inUV;       // Quad UV (from static buffer)
 // Instanced Data (changes per particle)
 layout(location = 2) in vec3 inInstancePos;
 layout(location = 3) in vec4 inInstanceColor;
-layout(location = 4) in float inInstanceSize;
+layout(location = 4) in vec2 inInstanceSize;    // x = size, y = atlas layer
+layout(location = 5) in vec4 inInstanceUVRect;  // xy = atlas UV offset, zw = atlas UV scale
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 view;
@@ -16,11 +17,11 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 } ubo;
 
 layout(location = 0) out vec4 fragColor;
-layout(location = 1) out vec2 fragUV;
+layout(location = 1) out vec3 fragUV; // xy = atlas UV, z = layer
 
 void main() {
     fragColor = inInstanceColor;
-    fragUV = inUV;
+    fragUV = vec3(inInstanceUVRect.xy + inUV * inInstanceUVRect.zw, inInstanceSize.y);
 
     // Billboarding: Extract Camera Right and Up vectors from View Matrix
     // View Matrix columns 0, 1, 2 correspond to Right, Up, Forward in World Space
@@ -29,8 +30,8 @@ void main() {
 
     // Calculate vertex position: Center + (Right * x * size) + (Up * y * size)
     vec3 vertexPosWorld = inInstancePos 
-        + (cameraRight * inPos.x * inInstanceSize) 
-        + (cameraUp * inPos.y * inInstanceSize);
+        + (cameraRight * inPos.x * inInstanceSize.x) 
+        + (cameraUp * inPos.y * inInstanceSize.x);
 
     gl_Position = ubo.proj * ubo.view * vec4(vertexPosWorld, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 450
+
+layout(location = 0) in vec2 inUV;
+
+layout(set = 0, binding = 0) uniform sampler2D sceneDepth;
+layout(set = 0, binding = 1) uniform sampler2D lowResDepth;
+layout(set = 0, binding = 2) uniform sampler2D particleColor; // rgb = premultiplied color, a = transmittance
+
+layout(location = 0) out vec4 outColor;
+
+// Relative view-depth difference above which a low-res texel is treated as another surface
+const float DEPTH_TOLERANCE = 0.1;
+
+// With far >> near, 1 / (1 - d) is proportional to view-space depth for a [0, 1] perspective depth
+float ViewDepth(float d) {
+    return 1.0 / max(1.0 - d, 1e-6);
+}
+
+void main() {
+    ivec2 lowSize = textureSize(particleColor, 0);
+    float fullDepth = ViewDepth(texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r);
+
+    vec2 lowPos = inUV * vec2(lowSize) - 0.5;
+    ivec2 base = ivec2(floor(lowPos));
+    vec2 f = fract(lowPos);
+
+    const ivec2 offsets[4] = ivec2[](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+    float weights[4] = float[]((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+
+    vec4 bilinear = vec4(0.0);
+    vec4 nearest = vec4(0.0, 0.0, 0.0, 1.0);
+    float nearestDiff = 1e30;
+    bool continuous = true;
+
+    for (int i = 0; i < 4; ++i) {
+        ivec2 coord = clamp(base + offsets[i], ivec2(0), lowSize - 1);
+        vec4 color = texelFetch(particleColor, coord, 0);
+        float diff = abs(ViewDepth(texelFetch(lowResDepth, coord, 0).r) - fullDepth) / fullDepth;
+
+        bilinear += color * weights[i];
+        if (diff > DEPTH_TOLERANCE) continuous = false;
+        if (diff < nearestDiff) {
+            nearestDiff = diff;
+            nearest = color;
+        }
+    }
+
+    // Smooth surfaces get a bilinear upsample; across depth edges take the tap on this pixel's surface
+    outColor = continuous ? bilinear : nearest;
+}
@@ -27,6 +27,7 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     Light lights[MAX_LIGHTS];
     int numLights;
     float dayNightFactor; // Ensure this matches C++ UBO
+    mat4 refractionViewProj; // Camera the refraction target was last rendered from
 } ubo;
 
 layout(push_constant) uniform PushConstantObject {
@@ -75,10 +76,11 @@ void main() {
         vec3 I = normalize(fragPos - ubo.viewPos);
         vec3 N = normalize(fragNormal);
         
-        vec2 viewportSize = vec2(textureSize(refractionSampler, 0));
-        vec2 screenUV = gl_FragCoord.xy / viewportSize;
+        // Reprojected into the refraction target, which may be smaller than the screen and a few frames old
+        vec4 refractionClip = ubo.refractionViewProj * vec4(fragPos, 1.0);
+        vec2 screenUV = refractionClip.xy / refractionClip.w * 0.5 + 0.5;
 
-        vec2 distortion = N.xy * 0.40;
+        vec2 distortion = N.xy * 0.40; // Renderer::REFRACTION_DISTORTION scissors to this
         vec2 refractedUV = screenUV + distortion;
 
         vec3 refractionColor = texture(refractionSampler, refractedUV).rgb;
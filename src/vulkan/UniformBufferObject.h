@@ -22,4 +22,5 @@ struct UniformBufferObject {
     alignas(16) Light lights[MAX_LIGHTS];
     alignas(4) int numLights;
     alignas(4) float dayNightFactor;
+    alignas(16) glm::mat4 refractionViewProj; // Camera the refraction target was last rendered from
 };
\ No newline at end of file
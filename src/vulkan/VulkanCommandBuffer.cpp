@@ -1,4 +1,5 @@
 #include "VulkanCommandBuffer.h"
+#include "../core/HitchDetector.h"
 #include <stdexcept>
 #include <array>
 
@@ -134,7 +135,10 @@ void VulkanCommandBuffer::EndSingleTimeCommands(VkCommandBuffer commandBuffer, V
     submitInfo.pCommandBuffers = &commandBuffer;
 
     vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(queue);
+    {
+        HitchScope hitchScope(HitchDetector::Category::QueueWaitIdle, "VulkanCommandBuffer::EndSingleTimeCommands");
+        vkQueueWaitIdle(queue);
+    }
 
     vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 }
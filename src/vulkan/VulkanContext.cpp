@@ -2,7 +2,7 @@
 #include "VulkanUtils.h"
 #include <stdexcept>
 
-void VulkanContext::CreateInstance() {
+void VulkanContext::CreateInstance(bool headless) {
     if (VulkanUtils::enableValidationLayers && !VulkanUtils::CheckValidationLayerSupport()) {
         throw std::runtime_error("validation layers requested, but not available!");
     }
@@ -13,15 +13,15 @@ void VulkanContext::CreateInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_1; // For vkGetPhysicalDeviceFeatures2 and the optional synchronization2
 
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
-    // Rule ID: OPT.33 - Use out-parameter from VulkanUtils::GetRequiredExtensions
+    // Rule ID: OPT.33 - Use out-parameter from GetRequiredExtensions
     std::vector<const char*> extensions;
-    VulkanUtils::GetRequiredExtensions(extensions);
+    GetRequiredExtensions(extensions, headless);
 
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
@@ -44,6 +44,23 @@ void VulkanContext::CreateInstance() {
     }
 }
 
+void VulkanContext::GetRequiredExtensions(std::vector<const char*>& extensions, bool headless) {
+    extensions.clear();
+
+    // Headless runs never initialize GLFW and need no surface extensions
+    if (!headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
+
+    if (VulkanUtils::enableValidationLayers) {
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+}
+
 void VulkanContext::SetupDebugMessenger() {
     if (!VulkanUtils::enableValidationLayers) return;
 
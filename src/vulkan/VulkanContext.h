@@ -2,13 +2,15 @@
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <vector>
 
 class VulkanContext {
 public:
     VulkanContext() = default;
     ~VulkanContext() = default;
 
-    void CreateInstance();
+    // Headless instances skip the window-system extensions (no GLFW, no surface)
+    void CreateInstance(bool headless = false);
     void SetupDebugMessenger();
     void CreateSurface(GLFWwindow* window);
     void Cleanup();
@@ -17,6 +19,10 @@ public:
     VkSurfaceKHR GetSurface() const { return surface; }
 
 private:
+    // Rule ID: OPT.33 - Out-parameter rather than return by value. Here rather than in VulkanUtils,
+    // which is linked without GLFW by the benchmark target.
+    static void GetRequiredExtensions(std::vector<const char*>& extensions, bool headless);
+
     VkInstance instance = VK_NULL_HANDLE;
     VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
     VkSurfaceKHR surface = VK_NULL_HANDLE;
@@ -1,4 +1,5 @@
 #include "VulkanDescriptorSet.h"
+#include "../core/HitchDetector.h"
 #include <stdexcept>
 #include <array>
 
@@ -74,7 +75,12 @@ void VulkanDescriptorSet::CreateDescriptorSets(const std::vector<VkBuffer>& unif
     allocInfo.pSetLayouts = layouts.data();
 
     descriptorSets.resize(uniformBuffers.size());
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+    VkResult allocResult = VK_SUCCESS;
+    {
+        HitchScope hitchScope(HitchDetector::Category::DescriptorAllocation, "vkAllocateDescriptorSets", "uniform buffers");
+        allocResult = vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data());
+    }
+    if (allocResult != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
@@ -130,6 +136,26 @@ void VulkanDescriptorSet::CreateDescriptorSets(const std::vector<VkBuffer>& unif
     }
 }
 
+void VulkanDescriptorSet::UpdateImage(uint32_t binding, VkImageView imageView, VkSampler sampler) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = imageView;
+    imageInfo.sampler = sampler;
+
+    std::vector<VkWriteDescriptorSet> writes(descriptorSets.size());
+    for (size_t i = 0; i < descriptorSets.size(); i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSets[i];
+        writes[i].dstBinding = binding;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].descriptorCount = 1;
+        writes[i].pImageInfo = &imageInfo;
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
 void VulkanDescriptorSet::Cleanup() {
     if (descriptorPool != VK_NULL_HANDLE) {
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
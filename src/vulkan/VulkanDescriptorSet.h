@@ -16,6 +16,9 @@ public:
     void CreateDescriptorSets(const std::vector<VkBuffer>& uniformBuffers, VkDeviceSize bufferSize,
         VkImageView shadowImageView, VkSampler shadowSampler,
         VkImageView skyboxImageView, VkSampler skyboxSampler);
+    // Repoints one combined image sampler binding in every set, e.g. after its target was recreated at a new size.
+    // No set may be in use by a pending command buffer.
+    void UpdateImage(uint32_t binding, VkImageView imageView, VkSampler sampler);
     void Cleanup();
 
     VkDescriptorSetLayout GetLayout() const { return descriptorSetLayout; }
@@ -1,6 +1,7 @@
 #include "VulkanDevice.h"
 #include "VulkanSwapChain.h"
 #include "VulkanUtils.h"
+#include <cstring>
 #include <stdexcept>
 #include <set>
 
@@ -56,14 +57,36 @@ void VulkanDevice::CreateLogicalDevice() {
 
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = (availableFeatures.samplerAnisotropy == VK_TRUE) ? VK_TRUE : VK_FALSE;
+    // Optional, for per-pass pipeline statistics in RenderStats
+    deviceFeatures.pipelineStatisticsQuery = (availableFeatures.pipelineStatisticsQuery == VK_TRUE) ? VK_TRUE : VK_FALSE;
+    deviceFeatures.inheritedQueries = (availableFeatures.inheritedQueries == VK_TRUE) ? VK_TRUE : VK_FALSE;
+
+    // Optional, the render graph records its barriers through it when present. The extension needs 1.1.
+    std::vector<const char*> extensions = requiredDeviceExtensions();
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (properties.apiVersion >= VK_API_VERSION_1_1 && isExtensionAvailable(physicalDevice, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &synchronization2Features;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+    }
+    synchronization2 = synchronization2Features.synchronization2 == VK_TRUE;
+    if (synchronization2) {
+        extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = synchronization2 ? &synchronization2Features : nullptr;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(VulkanUtils::deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = VulkanUtils::deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (VulkanUtils::enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(VulkanUtils::validationLayers.size());
@@ -76,6 +99,7 @@ void VulkanDevice::CreateLogicalDevice() {
     if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS) {
         throw std::runtime_error("failed to create logical device!");
     }
+    enabledFeatures = deviceFeatures;
 
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
@@ -106,7 +130,13 @@ QueueFamilyIndices VulkanDevice::findQueueFamilies(VkPhysicalDevice physDevice)
         }
 
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(physDevice, i, surface, &presentSupport);
+        if (surface == VK_NULL_HANDLE) {
+            // Headless: nothing is presented, the graphics queue stands in
+            presentSupport = indices.graphicsFamily.has_value() ? VK_TRUE : VK_FALSE;
+        }
+        else {
+            vkGetPhysicalDeviceSurfaceSupportKHR(physDevice, i, surface, &presentSupport);
+        }
 
         if (presentSupport) {
             indices.presentFamily = i;
@@ -124,8 +154,8 @@ bool VulkanDevice::isDeviceSuitable(VkPhysicalDevice physDevice) const {
     const QueueFamilyIndices indices = findQueueFamilies(physDevice);
     const bool extensionsSupported = checkDeviceExtensionSupport(physDevice);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    bool swapChainAdequate = (surface == VK_NULL_HANDLE);
+    if (extensionsSupported && !swapChainAdequate) {
         const SwapChainSupportDetails swapChainSupport = VulkanSwapChain::QuerySwapChainSupport(physDevice, surface);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
@@ -133,6 +163,15 @@ bool VulkanDevice::isDeviceSuitable(VkPhysicalDevice physDevice) const {
     return indices.isComplete() && extensionsSupported && swapChainAdequate;
 }
 
+std::vector<const char*> VulkanDevice::requiredDeviceExtensions() const {
+    std::vector<const char*> extensions;
+    for (const char* extension : VulkanUtils::deviceExtensions) {
+        if (IsHeadless() && std::strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) continue;
+        extensions.push_back(extension);
+    }
+    return extensions;
+}
+
 bool VulkanDevice::checkDeviceExtensionSupport(VkPhysicalDevice physDevice) const {
     uint32_t extensionCount;
     vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &extensionCount, nullptr);
@@ -140,11 +179,25 @@ bool VulkanDevice::checkDeviceExtensionSupport(VkPhysicalDevice physDevice) cons
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(VulkanUtils::deviceExtensions.begin(), VulkanUtils::deviceExtensions.end());
+    const std::vector<const char*> deviceExtensions = requiredDeviceExtensions();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
     for (const auto& extension : availableExtensions) {
         requiredExtensions.erase(extension.extensionName);
     }
 
     return requiredExtensions.empty();
+}
+
+bool VulkanDevice::isExtensionAvailable(VkPhysicalDevice physDevice, const char* extensionName) const {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions) {
+        if (std::strcmp(extension.extensionName, extensionName) == 0) return true;
+    }
+    return false;
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ struct QueueFamilyIndices {
 
 class VulkanDevice final {
 public:
+    // Without a surface (VK_NULL_HANDLE) the device is picked for headless rendering: presentation
+    // is not required and the present queue is the graphics queue
     VulkanDevice(VkInstance instanceArg, VkSurfaceKHR surfaceArg);
     ~VulkanDevice() = default;
 
@@ -34,7 +36,11 @@ public:
     VkDevice GetDevice() const { return device; }
     VkQueue GetGraphicsQueue() const { return graphicsQueue; }
     VkQueue GetPresentQueue() const { return presentQueue; }
+    bool IsHeadless() const { return surface == VK_NULL_HANDLE; }
     const QueueFamilyIndices& GetQueueFamilies() const { return cachedQueueFamilies; }
+    const VkPhysicalDeviceFeatures& GetEnabledFeatures() const { return enabledFeatures; }
+    // VK_KHR_synchronization2 was enabled (vkCmdPipelineBarrier2KHR has to be loaded by the user)
+    bool SupportsSynchronization2() const { return synchronization2; }
 
 private:
     VkInstance instance;
@@ -45,8 +51,13 @@ private:
     VkQueue presentQueue = VK_NULL_HANDLE;
 
     QueueFamilyIndices cachedQueueFamilies;
+    VkPhysicalDeviceFeatures enabledFeatures{};
+    bool synchronization2 = false;
 
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice physDevice) const;
     bool isDeviceSuitable(VkPhysicalDevice physDevice) const;
+    // VulkanUtils::deviceExtensions, less VK_KHR_swapchain when headless: it needs VK_KHR_surface on the instance
+    std::vector<const char*> requiredDeviceExtensions() const;
     bool checkDeviceExtensionSupport(VkPhysicalDevice physDevice) const;
+    bool isExtensionAvailable(VkPhysicalDevice physDevice, const char* extensionName) const;
 };
\ No newline at end of file
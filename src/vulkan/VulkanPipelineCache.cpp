@@ -0,0 +1,172 @@
+#include "VulkanPipelineCache.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    template <typename T>
+    void WriteValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    uint32_t ReadBlobWord(const std::vector<uint8_t>& data, size_t offset) {
+        uint32_t value = 0;
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    }
+
+    // headerSize, headerVersion, vendorID, deviceID, then the UUID
+    constexpr size_t DRIVER_HEADER_SIZE = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+    // Real caches are a few MB; a size field past this is corruption, not data
+    constexpr uint64_t MAX_DATA_SIZE = 256ull * 1024 * 1024;
+}
+
+VulkanPipelineCache::VulkanPipelineCache(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, const std::string& pathArg)
+    : device(deviceArg), path(pathArg) {
+    vkGetPhysicalDeviceProperties(physicalDeviceArg, &properties);
+}
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void VulkanPipelineCache::Create() {
+    std::vector<uint8_t> data;
+    loaded = !path.empty() && ReadFile(data);
+    if (!loaded) data.clear();
+    savedHash = loaded ? Hash(data) : 0;
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    if (loaded) {
+        std::cout << "Pipeline cache: loaded " << data.size() / 1024 << " KB from " << path << std::endl;
+    }
+}
+
+void VulkanPipelineCache::Save() {
+    if (cache == VK_NULL_HANDLE || path.empty()) return;
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS) return;
+    data.resize(size);
+
+    const uint64_t hash = Hash(data);
+    if (hash == savedHash) return;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Warning: could not write pipeline cache to " << path << std::endl;
+        return;
+    }
+
+    WriteValue(file, MAGIC);
+    WriteValue(file, VERSION);
+    WriteValue(file, properties.vendorID);
+    WriteValue(file, properties.deviceID);
+    WriteValue(file, properties.driverVersion);
+    file.write(reinterpret_cast<const char*>(properties.pipelineCacheUUID), VK_UUID_SIZE);
+    WriteValue(file, static_cast<uint64_t>(data.size()));
+    WriteValue(file, hash);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    if (file) {
+        savedHash = hash;
+    }
+    else {
+        std::cerr << "Warning: could not write pipeline cache to " << path << std::endl;
+    }
+}
+
+void VulkanPipelineCache::Cleanup() {
+    if (cache == VK_NULL_HANDLE) return;
+
+    Save();
+    vkDestroyPipelineCache(device, cache, nullptr);
+    cache = VK_NULL_HANDLE;
+}
+
+bool VulkanPipelineCache::ReadFile(std::vector<uint8_t>& data) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false; // First run
+
+    uint32_t magic = 0, version = 0, vendorID = 0, deviceID = 0, driverVersion = 0;
+    uint8_t uuid[VK_UUID_SIZE] = {};
+    uint64_t size = 0, hash = 0;
+    if (!ReadValue(file, magic) || !ReadValue(file, version) || magic != MAGIC || version != VERSION) {
+        std::cerr << "Warning: ignoring pipeline cache " << path << ", not a pipeline cache of this version" << std::endl;
+        return false;
+    }
+    if (!ReadValue(file, vendorID) || !ReadValue(file, deviceID) || !ReadValue(file, driverVersion)
+        || !file.read(reinterpret_cast<char*>(uuid), VK_UUID_SIZE) || !ReadValue(file, size) || !ReadValue(file, hash)) {
+        std::cerr << "Warning: ignoring truncated pipeline cache " << path << std::endl;
+        return false;
+    }
+
+    // A driver update changes driverVersion (and usually the UUID); old blobs would be rejected or worse
+    if (vendorID != properties.vendorID || deviceID != properties.deviceID || driverVersion != properties.driverVersion
+        || std::memcmp(uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        std::cout << "Pipeline cache: " << path << " was written by another device or driver, starting empty" << std::endl;
+        return false;
+    }
+
+    // The size field is checked against what the file holds before anything is allocated for it
+    const std::streampos dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff remaining = file.tellg() - dataStart;
+    file.seekg(dataStart);
+    if (!file || size > MAX_DATA_SIZE || size != static_cast<uint64_t>(remaining)) {
+        std::cerr << "Warning: ignoring corrupt pipeline cache " << path << std::endl;
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))
+        || Hash(data) != hash || !IsDriverHeaderValid(data)) {
+        std::cerr << "Warning: ignoring corrupt pipeline cache " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VulkanPipelineCache::IsDriverHeaderValid(const std::vector<uint8_t>& data) const {
+    if (data.size() < DRIVER_HEADER_SIZE) return false;
+
+    const uint32_t headerSize = ReadBlobWord(data, 0);
+    const uint32_t headerVersion = ReadBlobWord(data, 4);
+    return headerSize >= DRIVER_HEADER_SIZE && headerSize <= data.size()
+        && headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && ReadBlobWord(data, 8) == properties.vendorID
+        && ReadBlobWord(data, 12) == properties.deviceID
+        && std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+uint64_t VulkanPipelineCache::Hash(const std::vector<uint8_t>& data) {
+    // FNV-1a: only has to catch torn or truncated writes
+    uint64_t hash = 14695981039346656037ull;
+    for (const uint8_t byte : data) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
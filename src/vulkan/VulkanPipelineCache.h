@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// VkPipelineCache persisted to disk between runs. The file carries its own header with the
+// vendor, device, driver version and pipelineCacheUUID it was written on, plus a hash of the
+// driver blob; a file from another device or driver, or a torn write, is ignored and the cache
+// starts empty rather than handing the driver data it may not validate itself. The cache
+// outlives swap chain rebuilds, so a resize recompiles from memory.
+class VulkanPipelineCache final {
+public:
+    // An empty path keeps the cache in memory only
+    VulkanPipelineCache(VkDevice deviceArg, VkPhysicalDevice physicalDeviceArg, const std::string& pathArg);
+    ~VulkanPipelineCache();
+
+    // Non-copyable
+    VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+    VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+    void Create();
+    // Writes the cache to disk if it changed since it was loaded or last saved
+    void Save();
+    // Saves, then destroys the cache
+    void Cleanup();
+
+    VkPipelineCache GetCache() const { return cache; }
+    // True when Create seeded the cache from a valid file (a warm start)
+    bool WasLoaded() const { return loaded; }
+
+private:
+    bool ReadFile(std::vector<uint8_t>& data) const;
+    // The driver's own VkPipelineCacheHeaderVersionOne must describe this device too
+    bool IsDriverHeaderValid(const std::vector<uint8_t>& data) const;
+
+    static uint64_t Hash(const std::vector<uint8_t>& data);
+
+    VkDevice device;
+    std::string path;
+    VkPhysicalDeviceProperties properties{};
+
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    uint64_t savedHash = 0; // Of the blob last read or written, to skip unchanged saves
+    bool loaded = false;
+
+    static constexpr uint32_t MAGIC = 0x5042524f; // "ORBP"
+    static constexpr uint32_t VERSION = 1;
+};
@@ -2,8 +2,8 @@
 #include <stdexcept>
 #include <array>
 
-VulkanRenderPass::VulkanRenderPass(VkDevice deviceArg, VkFormat swapChainImageFormat)
-    : device(deviceArg), imageFormat(swapChainImageFormat) {
+VulkanRenderPass::VulkanRenderPass(VkDevice deviceArg, VkFormat swapChainImageFormat, VkFormat depthImageFormat)
+    : device(deviceArg), imageFormat(swapChainImageFormat), depthFormat(depthImageFormat) {
 }
 
 void VulkanRenderPass::Create(bool offScreen) {
@@ -16,9 +16,10 @@ void VulkanRenderPass::Create(bool offScreen) {
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-    // For off-screen rendering, we want to transfer the image after rendering
+    // Render graph targets (the swap chain image included) stay attachments; the graph transitions them
+    // for whatever reads them next, or for presentation
     if (offScreen) {
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     }
     else {
         colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
@@ -27,11 +28,11 @@ void VulkanRenderPass::Create(bool offScreen) {
     VkAttachmentDescription depthAttachment{};
     VkAttachmentReference depthAttachmentRef{};
     if (offScreen) {
-        depthAttachment.format = VK_FORMAT_D32_SFLOAT; // default chosen; actual image format used must match
+        depthAttachment.format = depthFormat; // The depth images' format must match
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // Read back by the low-res particle pass
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // Portal mask; ignored by depth-only formats
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
@@ -93,16 +94,16 @@ void VulkanRenderPass::Create(bool offScreen) {
     }
 }
 
-void VulkanRenderPass::CreateFramebuffers(const std::vector<VkImageView>& imageViews, const VkExtent2D& extent) {
+void VulkanRenderPass::CreateFramebuffers(const std::vector<VkImageView>& imageViews, VkImageView depthImageView, const VkExtent2D& extent) {
     framebuffers.resize(imageViews.size());
 
     for (size_t i = 0; i < imageViews.size(); i++) {
-        std::array<VkImageView, 1> attachments = { imageViews[i] };
+        std::array<VkImageView, 2> attachments = { imageViews[i], depthImageView };
 
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
         framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        framebufferInfo.attachmentCount = depthImageView != VK_NULL_HANDLE ? 2u : 1u;
         framebufferInfo.pAttachments = attachments.data();
         framebufferInfo.width = extent.width;
         framebufferInfo.height = extent.height;
@@ -114,37 +115,17 @@ void VulkanRenderPass::CreateFramebuffers(const std::vector<VkImageView>& imageV
     }
 }
 
-void VulkanRenderPass::CreateOffScreenFramebuffer(VkImageView colorImageView, VkImageView depthImageView, const VkExtent2D& extent) {
-    std::array<VkImageView, 2> attachments = { colorImageView, depthImageView };
-
-    VkFramebufferCreateInfo framebufferInfo{};
-    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebufferInfo.renderPass = renderPass;
-    framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    framebufferInfo.pAttachments = attachments.data();
-    framebufferInfo.width = extent.width;
-    framebufferInfo.height = extent.height;
-    framebufferInfo.layers = 1;
-
-    if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &offScreenFramebuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create off-screen framebuffer!");
-    }
-}
-
-void VulkanRenderPass::Cleanup() {
-    // Clean up framebuffers
+void VulkanRenderPass::DestroyFramebuffers() {
     for (const auto framebuffer : framebuffers) {
         if (framebuffer != VK_NULL_HANDLE) {
             vkDestroyFramebuffer(device, framebuffer, nullptr);
         }
     }
     framebuffers.clear();
+}
 
-    // Clean up off-screen framebuffer
-    if (offScreenFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(device, offScreenFramebuffer, nullptr);
-        offScreenFramebuffer = VK_NULL_HANDLE;
-    }
+void VulkanRenderPass::Cleanup() {
+    DestroyFramebuffers();
 
     // Clean up render pass
     if (renderPass != VK_NULL_HANDLE) {
@@ -5,22 +5,23 @@
 
 class VulkanRenderPass {
 public:
-    VulkanRenderPass(VkDevice device, VkFormat swapChainImageFormat);
+    VulkanRenderPass(VkDevice device, VkFormat swapChainImageFormat, VkFormat depthImageFormat = VK_FORMAT_D32_SFLOAT);
     ~VulkanRenderPass() = default;
 
     void Create(bool offScreen = false);
-    void CreateFramebuffers(const std::vector<VkImageView>& imageViews, const VkExtent2D& extent);
-    void CreateOffScreenFramebuffer(VkImageView colorImageView, VkImageView depthImageView, const VkExtent2D& extent);
+    // One per color view (e.g. per swap chain image), all sharing depthImageView unless it is VK_NULL_HANDLE
+    void CreateFramebuffers(const std::vector<VkImageView>& imageViews, VkImageView depthImageView, const VkExtent2D& extent);
+    // Before its attachments are recreated at a new size; the render pass itself is kept
+    void DestroyFramebuffers();
     void Cleanup();
 
     VkRenderPass GetRenderPass() const { return renderPass; }
     const std::vector<VkFramebuffer>& GetFramebuffers() const { return framebuffers; }
-    VkFramebuffer GetOffScreenFramebuffer() const { return offScreenFramebuffer; }
 
 private:
     VkDevice device;
     VkFormat imageFormat;
+    VkFormat depthFormat;
     VkRenderPass renderPass = VK_NULL_HANDLE;
     std::vector<VkFramebuffer> framebuffers;
-    VkFramebuffer offScreenFramebuffer = VK_NULL_HANDLE;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "VulkanSwapChain.h"
 #include "VulkanDevice.h"
+#include "VulkanUtils.h"
 #include <stdexcept>
 #include <algorithm>
 #include <limits>
@@ -34,8 +35,8 @@ void VulkanSwapChain::Create(const QueueFamilyIndices& indices) {
     createInfo.imageColorSpace = surfaceFormat.colorSpace;
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
-    // Add TRANSFER_DST_BIT to allow copying to swap chain images
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    // The main pass renders straight into the swap chain images
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
     // Use vector to manage lifetime and avoid raw array usage
     std::vector<uint32_t> queueFamilyIndices;
@@ -54,12 +55,21 @@ void VulkanSwapChain::Create(const QueueFamilyIndices& indices) {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // Handing the old swap chain over lets the driver reuse its resources; it is retired either way
+    const VkSwapchainKHR oldSwapChain = swapChain;
+    createInfo.oldSwapchain = oldSwapChain;
 
-    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+    VkSwapchainKHR newSwapChain = VK_NULL_HANDLE;
+    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &newSwapChain) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
     }
 
+    if (oldSwapChain != VK_NULL_HANDLE) {
+        DestroyImageViews();
+        vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+    }
+    swapChain = newSwapChain;
+
     // Initialize format and extent BEFORE getting images
     swapChainImageFormat = surfaceFormat.format;
     swapChainExtent = extent;
@@ -69,6 +79,25 @@ void VulkanSwapChain::Create(const QueueFamilyIndices& indices) {
     vkGetSwapchainImagesKHR(device, swapChain, &imageCount, swapChainImages.data());
 }
 
+void VulkanSwapChain::Recreate(const QueueFamilyIndices& indices) {
+    Create(indices);
+    CreateImageViews();
+}
+
+void VulkanSwapChain::CreateHeadless(VkExtent2D extent, uint32_t imageCount) {
+    swapChainImageFormat = HEADLESS_FORMAT;
+    swapChainExtent = extent;
+
+    swapChainImages.resize(imageCount);
+    headlessImageMemory.resize(imageCount);
+    for (uint32_t i = 0; i < imageCount; ++i) {
+        VulkanUtils::CreateImage(device, physicalDevice, extent.width, extent.height, 1, 1,
+            swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i], headlessImageMemory[i]);
+    }
+}
+
 void VulkanSwapChain::CreateImageViews() {
     swapChainImageViews.resize(swapChainImages.size());
 
@@ -94,16 +123,28 @@ void VulkanSwapChain::CreateImageViews() {
     }
 }
 
-void VulkanSwapChain::Cleanup() {
+void VulkanSwapChain::DestroyImageViews() {
     for (const auto imageView : swapChainImageViews) {
         vkDestroyImageView(device, imageView, nullptr);
     }
     swapChainImageViews.clear();
+}
+
+void VulkanSwapChain::Cleanup() {
+    DestroyImageViews();
 
     if (swapChain != VK_NULL_HANDLE) {
         vkDestroySwapchainKHR(device, swapChain, nullptr);
         swapChain = VK_NULL_HANDLE;
     }
+
+    // Headless images are ours to free; swapchain images went with the swapchain
+    for (size_t i = 0; i < headlessImageMemory.size(); ++i) {
+        vkDestroyImage(device, swapChainImages[i], nullptr);
+        vkFreeMemory(device, headlessImageMemory[i], nullptr);
+    }
+    headlessImageMemory.clear();
+    swapChainImages.clear();
 }
 
 SwapChainSupportDetails VulkanSwapChain::QuerySwapChainSupport(VkPhysicalDevice physicalDeviceArg, VkSurfaceKHR surfaceArg) {
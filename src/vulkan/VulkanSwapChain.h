@@ -18,7 +18,13 @@ public:
     VulkanSwapChain(VkDevice device, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, GLFWwindow* window);
     ~VulkanSwapChain() = default;
 
+    // When a swap chain already exists it is passed as oldSwapchain, then destroyed with its views
     void Create(const QueueFamilyIndices& indices);
+    // Resize: Create + CreateImageViews. Nothing may still be using the old images (frames in flight and their presents).
+    void Recreate(const QueueFamilyIndices& indices);
+    // Plain device-local images in place of a VkSwapchainKHR, for rendering without a window.
+    // Nothing is acquired or presented; the renderer cycles through them itself.
+    void CreateHeadless(VkExtent2D extent, uint32_t imageCount = HEADLESS_IMAGE_COUNT);
     void CreateImageViews();
     void Cleanup();
 
@@ -29,6 +35,10 @@ public:
     const std::vector<VkImageView>& GetImageViews() const { return swapChainImageViews; }
     VkFormat GetImageFormat() const { return swapChainImageFormat; }
     VkExtent2D GetExtent() const { return swapChainExtent; }
+    bool IsHeadless() const { return !headlessImageMemory.empty(); }
+
+    static constexpr uint32_t HEADLESS_IMAGE_COUNT = 3;
+    static constexpr VkFormat HEADLESS_FORMAT = VK_FORMAT_B8G8R8A8_SRGB; // What the windowed path prefers
 
 private:
     VkDevice device;
@@ -41,8 +51,10 @@ private:
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
     std::vector<VkImageView> swapChainImageViews;
+    std::vector<VkDeviceMemory> headlessImageMemory; // Owned images, headless only
 
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) const;
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) const;
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const;
+    void DestroyImageViews();
 };
\ No newline at end of file
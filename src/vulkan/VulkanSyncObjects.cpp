@@ -1,4 +1,5 @@
 #include "VulkanSyncObjects.h"
+#include <algorithm>
 #include <stdexcept>
 
 VulkanSyncObjects::VulkanSyncObjects(VkDevice deviceArg, uint32_t maxFramesInFlightArg)
@@ -46,6 +47,10 @@ void VulkanSyncObjects::CreateSyncObjects(uint32_t swapChainImageCount) {
     }
 }
 
+void VulkanSyncObjects::ResetImagesInFlight() {
+    std::fill(imagesInFlight.begin(), imagesInFlight.end(), VK_NULL_HANDLE);
+}
+
 void VulkanSyncObjects::Cleanup() {
     for (const auto semaphore : imageAvailableSemaphores) {
         if (semaphore != VK_NULL_HANDLE) {
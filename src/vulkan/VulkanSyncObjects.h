@@ -26,6 +26,10 @@ public:
     // Track which fence is using which image (indexed by imageIndex)
     VkFence& GetImageInFlight(uint32_t imageIndex);
 
+    uint32_t GetSwapChainImageCount() const { return static_cast<uint32_t>(imagesInFlight.size()); }
+    // After a swap chain rebuild with the same image count: indices now name new images
+    void ResetImagesInFlight();
+
 private:
     VkDevice device;
     uint32_t maxFramesInFlight;
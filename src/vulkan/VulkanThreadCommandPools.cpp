@@ -0,0 +1,80 @@
+#include "VulkanThreadCommandPools.h"
+#include <stdexcept>
+
+VulkanThreadCommandPools::VulkanThreadCommandPools(VkDevice deviceArg, uint32_t maxFramesInFlightArg, uint32_t threadCountArg)
+    : device(deviceArg), maxFramesInFlight(maxFramesInFlightArg), threadCount(threadCountArg > 0 ? threadCountArg : 1) {
+}
+
+VulkanThreadCommandPools::~VulkanThreadCommandPools() {
+    try {
+        Cleanup();
+    }
+    catch (...) {
+        // Ensure destructor does not allow exceptions to propagate.
+    }
+}
+
+void VulkanThreadCommandPools::CreateCommandPools(uint32_t queueFamilyIndex) {
+    pools.resize(static_cast<size_t>(maxFramesInFlight) * threadCount);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // Whole pools are reset, never single buffers
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+    for (auto& threadPool : pools) {
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &threadPool.pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create thread command pool!");
+        }
+    }
+}
+
+void VulkanThreadCommandPools::BeginFrame(uint32_t currentFrame) {
+    for (uint32_t thread = 0; thread < threadCount; ++thread) {
+        ThreadPool& threadPool = pools[static_cast<size_t>(currentFrame) * threadCount + thread];
+        if (threadPool.used == 0) continue;
+
+        if (vkResetCommandPool(device, threadPool.pool, 0) != VK_SUCCESS) {
+            throw std::runtime_error("failed to reset thread command pool!");
+        }
+        threadPool.used = 0;
+    }
+}
+
+VkCommandBuffer VulkanThreadCommandPools::AcquireSecondary(uint32_t currentFrame, uint32_t threadIndex) {
+    if (threadIndex >= threadCount) {
+        throw std::runtime_error("secondary command buffer requested from an unknown recording thread!");
+    }
+
+    ThreadPool& threadPool = pools[static_cast<size_t>(currentFrame) * threadCount + threadIndex];
+
+    // Buffers are kept across frames; only grow when this frame needs more than any before it
+    if (threadPool.used == threadPool.buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = threadPool.pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer buffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate secondary command buffer!");
+        }
+        threadPool.buffers.push_back(buffer);
+    }
+
+    return threadPool.buffers[threadPool.used++];
+}
+
+void VulkanThreadCommandPools::Cleanup() {
+    // Destroying a pool frees every buffer allocated from it
+    for (auto& threadPool : pools) {
+        if (threadPool.pool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, threadPool.pool, nullptr);
+            threadPool.pool = VK_NULL_HANDLE;
+        }
+        threadPool.buffers.clear();
+        threadPool.used = 0;
+    }
+    pools.clear();
+}
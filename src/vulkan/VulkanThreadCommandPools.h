@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// Secondary command buffers for multithreaded recording. There is one command pool per
+// (frame in flight, recording thread) pair. A thread only allocates from its own pool, so
+// recording needs no locking, and a frame's pools are reset in one go once its fence signals.
+class VulkanThreadCommandPools final {
+public:
+    VulkanThreadCommandPools(VkDevice deviceArg, uint32_t maxFramesInFlightArg, uint32_t threadCountArg);
+    ~VulkanThreadCommandPools();
+
+    // Non-copyable
+    VulkanThreadCommandPools(const VulkanThreadCommandPools&) = delete;
+    VulkanThreadCommandPools& operator=(const VulkanThreadCommandPools&) = delete;
+
+    void CreateCommandPools(uint32_t queueFamilyIndex);
+    void Cleanup();
+
+    // Recycles every secondary buffer of this frame. Its previous submission must have completed.
+    void BeginFrame(uint32_t currentFrame);
+
+    // Next unused secondary buffer from threadIndex's pool. Only call from that thread.
+    VkCommandBuffer AcquireSecondary(uint32_t currentFrame, uint32_t threadIndex);
+
+    uint32_t GetThreadCount() const { return threadCount; }
+
+private:
+    struct ThreadPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> buffers;
+        size_t used = 0;
+    };
+
+    VkDevice device;
+    uint32_t maxFramesInFlight;
+    uint32_t threadCount;
+
+    // Indexed [frame * threadCount + thread]
+    std::vector<ThreadPool> pools;
+};
@@ -1,4 +1,5 @@
 #include "VulkanUtils.h"
+#include "../core/HitchDetector.h"
 #include <iostream>
 #include <cstring>
 #include <stdexcept> // Ensure this is included for std::runtime_error
@@ -44,18 +45,6 @@ namespace VulkanUtils {
         return true;
     }
 
-    void GetRequiredExtensions(std::vector<const char*>& extensions) {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
-
-        if (enableValidationLayers) {
-            extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-        }
-    }
-
     VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* const pUserData) {
         std::cerr << "\nvalidation layer: " << pCallbackData->pMessage << std::endl;
         return VK_FALSE;
@@ -175,7 +164,10 @@ namespace VulkanUtils {
             throw std::runtime_error("failed to submit single time command buffer!");
         }
 
-        vkQueueWaitIdle(graphicsQueue);
+        {
+            HitchScope hitchScope(HitchDetector::Category::QueueWaitIdle, "VulkanUtils::EndSingleTimeCommands");
+            vkQueueWaitIdle(graphicsQueue);
+        }
 
         vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
     }
@@ -25,9 +25,6 @@ namespace VulkanUtils {
 
     bool CheckValidationLayerSupport();
 
-    // Rule ID: OPT.33 - Changed return by value to out-parameter
-    void GetRequiredExtensions(std::vector<const char*>& extensions);
-
     VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT messageType,